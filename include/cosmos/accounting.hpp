@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_ACCOUNTING
+#define COSMOS_ACCOUNTING
+
+#include <atomic>
+#include "cosmos.hpp"
+
+namespace cosmos {
+
+    namespace work {
+        struct space;
+    }
+
+    // counts of live objects and the memory they use,
+    // so that we can size hosts and notice leaks.
+    namespace accounting {
+
+        enum kind {
+            space = 0,
+            atom = 1,
+            output = 2,
+            outpoint = 3,
+            input = 4,
+            transaction = 5,
+            wallet = 6,
+            keysource = 7,
+            watch = 8,
+
+            // interpreter states, which hold copies of the workspace.
+            state = 9,
+
+            other = 10
+        };
+
+        constexpr uint32 kinds = 11;
+
+        const char* name(kind);
+
+        struct counter {
+            std::atomic<int64_t> Live;
+            std::atomic<int64_t> Bytes;
+            std::atomic<int64_t> Peak;
+            std::atomic<uint64_t> Allocations;
+
+            void add(int64_t size) {
+                Live++;
+                Allocations++;
+                int64_t now = Bytes += size;
+                int64_t peak = Peak;
+                while (now > peak && !Peak.compare_exchange_weak(peak, now)) {}
+            }
+
+            void remove(int64_t size) {
+                Live--;
+                Bytes -= size;
+            }
+        };
+
+        counter& get(kind);
+
+        // a snapshot of one kind.
+        struct usage {
+            int64_t Live;
+            int64_t Bytes;
+            int64_t Peak;
+            uint64_t Allocations;
+        };
+
+        usage read(kind);
+
+        // Inherit from this to be counted. The object is counted
+        // from construction until destruction as sizeof(X), so heap
+        // memory it owns is not included.
+        template <typename X, kind k>
+        struct counted {
+            counted() {
+                get(k).add(sizeof(X));
+            }
+
+            counted(const counted&) : counted{} {}
+
+            counted& operator=(const counted&) {
+                return *this;
+            }
+
+            ~counted() {
+                get(k).remove(sizeof(X));
+            }
+        };
+
+        // what one workspace uses, by the kind of item.
+        struct footprint {
+            std::array<uint64_t, kinds> Items;
+            std::array<uint64_t, kinds> Bytes;
+
+            // map nodes, control blocks and names.
+            uint64_t Overhead;
+
+            footprint() : Items{}, Bytes{}, Overhead{0} {}
+
+            uint64_t total() const {
+                uint64_t t = Overhead;
+                for (uint64_t b : Bytes) t += b;
+                return t;
+            }
+        };
+
+        // Walks the workspace, including nested workspaces. Items
+        // shared with other workspaces are counted here as well, so
+        // the footprints of two spaces do not add up.
+        footprint measure(const work::space&);
+
+        // the global counters.
+        void write(ostream&);
+
+        void write(ostream&, const footprint&);
+
+    }
+
+}
+
+#endif
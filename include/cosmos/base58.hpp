@@ -0,0 +1,73 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_BASE58
+#define COSMOS_BASE58
+
+#include "keys.hpp"
+#include "format.hpp"
+
+namespace cosmos::bitcoin {
+
+    // Base58Check for the fixed sizes we use: 25-byte addresses and
+    // 37 or 38 byte WIF secrets. Numbers are converted five digits
+    // at a time with 64-bit arithmetic on 32-bit limbs, and the
+    // checksum is two compressions since the payload fits in a block.
+    namespace base58 {
+
+        constexpr byte address_version = 0x00;
+        constexpr byte wif_version = 0x80;
+
+        // at most 64 bytes.
+        std::string encode(const byte*, size_t);
+
+        // false unless the string is exactly the encoding of n bytes.
+        bool decode(const std::string&, byte*, size_t n);
+
+        // the first 4 bytes of the double SHA-256.
+        std::array<byte, 4> checksum(const byte*, size_t);
+
+        std::string write_address(const keys::hash160&, byte version = address_version);
+
+        // false if the string is not a valid address of this version.
+        bool read_address(const std::string&, keys::hash160&, byte version = address_version);
+
+        std::string write_wif(const keys::secret_bytes&, bool compressed = true, byte version = wif_version);
+
+        // false if the string is not a valid WIF of this version.
+        bool read_wif(const std::string&, keys::secret_bytes&, bool& compressed, byte version = wif_version);
+
+        // Many at once, split across the global workers.
+        vector<std::string> write_addresses(const vector<keys::hash160>&);
+        vector<std::string> write_wifs(const vector<keys::secret_bytes>&);
+
+    }
+
+}
+
+namespace cosmos::format {
+
+    // keys and addresses as they are written in the interpreter.
+    template <> struct write<text, bitcoin::address> {
+        void operator()(const bitcoin::address& a, stringstream& ss) const {
+            ss << bitcoin::base58::write_address(bitcoin::keys::write(a));
+        }
+    };
+
+    template <> struct write<text, bitcoin::secret> {
+        void operator()(const bitcoin::secret& s, stringstream& ss) const {
+            ss << bitcoin::base58::write_wif(bitcoin::keys::write(s));
+        }
+    };
+
+    template <> struct write<text, bitcoin::pubkey> {
+        void operator()(const bitcoin::pubkey& p, stringstream& ss) const {
+            constexpr char digits[] = "0123456789abcdef";
+            for (byte b : bitcoin::keys::write(p)) ss << digits[b >> 4] << digits[b & 15];
+        }
+    };
+
+}
+
+#endif
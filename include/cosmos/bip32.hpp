@@ -0,0 +1,106 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_BIP32
+#define COSMOS_BIP32
+
+#include <functional>
+#include <mutex>
+#include "utxo.hpp"
+#include "crypto/sha512.hpp"
+#include "crypto/hmac.hpp"
+
+namespace cosmos::bitcoin {
+
+    // public derivation of BIP 32 child keys.
+    namespace bip32 {
+
+        using chain_code = std::array<byte, 32>;
+
+        constexpr uint32 hardened = 0x80000000;
+
+        // the public half of an extended key.
+        struct extended {
+            keys::pubkey_bytes Pubkey;
+            chain_code ChainCode;
+
+            bool operator==(const extended& x) const {
+                return Pubkey == x.Pubkey && ChainCode == x.ChainCode;
+            }
+        };
+
+        // Everything about deriving from a parent that is the same for
+        // every child, which is the HMAC keyed with the chain code and
+        // fed the parent pubkey. Each child only adds its index.
+        class parent {
+            extended Key;
+            crypto::hmac<crypto::sha512> Keyed;
+
+        public:
+            parent(const extended&);
+
+            const extended& key() const {
+                return Key;
+            }
+
+            // False for a hardened index, and for the few indices that
+            // have no child, which BIP 32 says to skip.
+            bool child(uint32 index, extended&) const;
+
+            // Pubkeys of count children starting at first, derived in
+            // parallel. Children that do not exist are left as zeros.
+            vector<keys::pubkey_bytes> children(uint32 first, uint32 count) const;
+        };
+
+        // Children of one extended key and their addresses, derived
+        // in batches as they are needed and kept.
+        class chain {
+            parent Parent;
+            uint32 Batch;
+            vector<keys::pubkey_bytes> Pubkeys;
+            vector<keys::hash160> Addresses;
+            mutable std::mutex Mutex;
+
+            // derive at least as far as n.
+            void extend(uint32 n);
+
+            // derive from first up to at least n, which is kept
+            // unless someone else has extended the chain meanwhile.
+            void derive(uint32 first, uint32 n);
+
+        public:
+            chain(const extended& x, uint32 batch = 1024) :
+                Parent{x}, Batch{batch}, Pubkeys{}, Addresses{}, Mutex{} {}
+
+            const extended& key() const {
+                return Parent.key();
+            }
+
+            size_t derived() const;
+
+            // false if child i does not exist.
+            bool exists(uint32 i);
+
+            keys::pubkey_bytes pubkey(uint32 i);
+            keys::hash160 address(uint32 i);
+
+            // Derive until gap children in a row have not been used and
+            // return one more than the last used child, which is where
+            // new addresses should start.
+            uint32 scan(const std::function<bool(const keys::hash160&)>& used, uint32 gap = 20);
+
+            // An address counts as used if it was ever paid, even if
+            // everything paid to it has been spent, so this is given
+            // the addresses found by a scan and not a wallet's outputs.
+            uint32 scan(const std::unordered_set<keys::hash160, utxo::hash>& used, uint32 gap = 20);
+
+            // heap memory held by the derived children.
+            size_t memory() const;
+        };
+
+    }
+
+}
+
+#endif
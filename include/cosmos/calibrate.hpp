@@ -0,0 +1,90 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_CALIBRATE
+#define COSMOS_CALIBRATE
+
+#include <chrono>
+#include "cosmos.hpp"
+
+namespace cosmos::bitcoin {
+
+    // How hard a proof-of-work target is and how long it
+    // will take to meet it with the hardware we have.
+    namespace calibrate {
+
+        // A target in compact form, Value * 256^(Exponent - 3),
+        // which is how work::target is written in a script. Targets
+        // made here have Value at least 0x8000 unless Exponent is 3,
+        // so that each has only one form.
+        struct compact {
+            byte Exponent;
+            uint32 Value;
+
+            bool valid() const {
+                return Exponent >= 3 && Exponent <= 32 && Value != 0 && Value < 0x800000;
+            }
+
+            bool operator==(const compact& t) const {
+                return Exponent == t.Exponent && Value == t.Value;
+            }
+        };
+
+        // the target of difficulty 1 in Bitcoin.
+        constexpr compact minimum{0x1d, 0x00ffff};
+
+        // hashes needed on average to meet the target.
+        double expected(compact);
+
+        // relative to the minimum.
+        double difficulty(compact);
+
+        // the easiest target which needs at least this many hashes,
+        // or the hardest if none does.
+        compact for_hashes(double);
+
+        inline compact for_difficulty(double d) {
+            return for_hashes(d * expected(minimum));
+        }
+
+        inline compact for_time(double seconds, double rate) {
+            return for_hashes(seconds * rate);
+        }
+
+        inline double seconds(compact t, double rate) {
+            return expected(t) / rate;
+        }
+
+        struct measurement {
+            uint32 Threads;
+            uint64_t Hashes;
+            double Seconds;
+
+            // double SHA-256 per second.
+            double rate() const {
+                return Hashes / Seconds;
+            }
+        };
+
+        // Hash 80-byte messages on the global workers for the given time,
+        // the way a miner would: the first block is hashed once and each
+        // attempt is two compressions, one for the last 16 bytes and
+        // one for the second hash. There are no more threads than
+        // workers, which is how many there are if none are given.
+        measurement measure(std::chrono::milliseconds, uint32 threads = 0);
+
+        // "3.2 days"
+        std::string duration(double seconds);
+
+        // "1.5 MH/s"
+        std::string rate(double);
+
+        // difficulty, expected hashes and time to solve at each rate.
+        void write(ostream&, compact, const vector<double>& rates);
+
+    }
+
+}
+
+#endif
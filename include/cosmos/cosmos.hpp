@@ -88,7 +88,8 @@ namespace cosmos {
         update = 5,
         spend = 6,
         next_address = 7, 
-        evaluate_script = 8
+        evaluate_script = 8, 
+        stats = 9
     };
     
     enum op {
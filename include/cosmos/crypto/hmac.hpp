@@ -0,0 +1,58 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_CRYPTO_HMAC
+#define COSMOS_CRYPTO_HMAC
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace cosmos::crypto {
+
+    // HMAC over any of the hash functions in this directory.
+    template <typename h>
+    class hmac {
+        h Inner;
+        h Outer;
+
+    public:
+        using digest = typename h::digest;
+
+        hmac(const uint8_t* key, size_t size) : Inner{}, Outer{} {
+            std::array<uint8_t, h::block> k{};
+            if (size > h::block) {
+                digest d = h::hash(key, size);
+                std::copy(d.begin(), d.end(), k.begin());
+            } else std::copy(key, key + size, k.begin());
+
+            std::array<uint8_t, h::block> pad;
+            for (size_t i = 0; i < h::block; i++) pad[i] = k[i] ^ 0x36;
+            Inner.update(pad.data(), pad.size());
+            for (size_t i = 0; i < h::block; i++) pad[i] = k[i] ^ 0x5c;
+            Outer.update(pad.data(), pad.size());
+        }
+
+        template <size_t n>
+        hmac(const std::array<uint8_t, n>& key) : hmac{key.data(), n} {}
+
+        hmac& update(const uint8_t* b, size_t size) {
+            Inner.update(b, size);
+            return *this;
+        }
+
+        template <size_t n>
+        hmac& update(const std::array<uint8_t, n>& b) {
+            return update(b.data(), n);
+        }
+
+        digest finish() {
+            digest d = Inner.finish();
+            return Outer.update(d.data(), d.size()).finish();
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,28 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_CRYPTO_RIPEMD160
+#define COSMOS_CRYPTO_RIPEMD160
+
+#include "sha256.hpp"
+
+namespace cosmos::crypto {
+
+    // RIPEMD-160, for addresses of keys which the
+    // library only gives in compressed form.
+    struct ripemd160 {
+        using digest = std::array<uint8_t, 20>;
+
+        static digest hash(const uint8_t*, size_t);
+
+        // RIPEMD-160 of SHA-256, as in an address.
+        static digest hash160(const uint8_t* b, size_t n) {
+            sha256::digest d = sha256::hash(b, n);
+            return hash(d.data(), d.size());
+        }
+    };
+
+}
+
+#endif
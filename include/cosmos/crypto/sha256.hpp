@@ -0,0 +1,66 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_CRYPTO_SHA256
+#define COSMOS_CRYPTO_SHA256
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace cosmos::crypto {
+
+    // SHA-256 with access to the intermediate state, so that
+    // a shared prefix of many messages is only hashed once.
+    struct sha256 {
+        using digest = std::array<uint8_t, 32>;
+        using state = std::array<uint32_t, 8>;
+
+        constexpr static size_t block = 64;
+
+        constexpr static state initial{{
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}};
+
+        // process whole 64-byte blocks.
+        static void compress(state&, const uint8_t* blocks, size_t count);
+
+        state State;
+        std::array<uint8_t, 64> Buffer;
+        uint64_t Length;
+
+        sha256() : State{initial}, Buffer{}, Length{0} {}
+
+        sha256& update(const uint8_t*, size_t);
+
+        sha256& update(const std::string& s) {
+            return update(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+        }
+
+        template <size_t n>
+        sha256& update(const std::array<uint8_t, n>& b) {
+            return update(b.data(), n);
+        }
+
+        digest finish();
+
+        static digest hash(const uint8_t* b, size_t n) {
+            return sha256{}.update(b, n).finish();
+        }
+
+        static digest hash(const std::string& s) {
+            return sha256{}.update(s).finish();
+        }
+
+        // double SHA-256 as used for txids and checksums.
+        static digest hash256(const uint8_t* b, size_t n) {
+            digest d = hash(b, n);
+            return hash(d.data(), d.size());
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_CRYPTO_SHA512
+#define COSMOS_CRYPTO_SHA512
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace cosmos::crypto {
+
+    // SHA-512, in the same form as sha256 so that it can be
+    // used with hmac and a keyed state can be copied.
+    struct sha512 {
+        using digest = std::array<uint8_t, 64>;
+        using state = std::array<uint64_t, 8>;
+
+        constexpr static size_t block = 128;
+
+        constexpr static state initial{{
+            0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+            0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179}};
+
+        // process whole 128-byte blocks.
+        static void compress(state&, const uint8_t* blocks, size_t count);
+
+        state State;
+        std::array<uint8_t, 128> Buffer;
+        uint64_t Length;
+
+        sha512() : State{initial}, Buffer{}, Length{0} {}
+
+        sha512& update(const uint8_t*, size_t);
+
+        sha512& update(const std::string& s) {
+            return update(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+        }
+
+        template <size_t n>
+        sha512& update(const std::array<uint8_t, n>& b) {
+            return update(b.data(), n);
+        }
+
+        digest finish();
+
+        static digest hash(const uint8_t* b, size_t n) {
+            return sha512{}.update(b, n).finish();
+        }
+
+        static digest hash(const std::string& s) {
+            return sha512{}.update(s).finish();
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_EVALUATION_ASYNC
+#define COSMOS_EVALUATION_ASYNC
+
+#include "interpreter.hpp"
+#include "loop.hpp"
+#include "frame.hpp"
+
+// Evaluation which does not block while functions wait for data.
+//
+// A statement is evaluated in two phases. First every application of
+// a function that waits is found, its arguments are evaluated and its
+// data is requested from the backend, all at once. While the requests
+// are out the loop goes on with other statements. When the last one
+// comes back the statement is evaluated as usual on the workers, and
+// the functions find what they need in the statement's frame.
+namespace cosmos::evaluation::async {
+
+    template <typename X>
+    using callback = std::function<void(X)>;
+
+    // where functions that wait get their data.
+    struct backend {
+        // Called on the loop thread, and done must be called
+        // on the loop thread as well.
+        virtual void fetch(cosmos::function, const arguments&, callback<ptr<work::item>> done) = 0;
+
+        virtual ~backend() {}
+    };
+
+    // Answers every request with nothing after a fixed delay.
+    // Stands in for a disk or an indexer when measuring.
+    class slow_backend final : public backend {
+        loop& Loop;
+        std::chrono::microseconds Latency;
+        std::atomic<uint64_t> Requests;
+
+    public:
+        slow_backend(loop& l, std::chrono::microseconds latency) : Loop{l}, Latency{latency}, Requests{0} {}
+
+        void fetch(cosmos::function, const arguments&, callback<ptr<work::item>> done) override {
+            Requests++;
+            Loop.after(Latency, [done]() {
+                done(nullptr);
+            });
+        }
+
+        uint64_t requests() const {
+            return Requests;
+        }
+    };
+
+    // Statements from the same session are evaluated in order, each
+    // against the workspace left by the one before. Statements from
+    // different sessions are evaluated concurrently.
+    class executor {
+        struct session {
+            work::space Workspace;
+            std::deque<std::pair<ptr<expression>, callback<response>>> Queue;
+            bool Busy;
+
+            session() : Workspace{}, Queue{}, Busy{false} {}
+        };
+
+        loop& Loop;
+        backend& Backend;
+        parallel::workers& Workers;
+        std::map<uint64_t, session> Sessions;
+
+        void next(uint64_t id);
+
+    public:
+        executor(loop& l, backend& b, parallel::workers& w = parallel::workers::global()) :
+            Loop{l}, Backend{b}, Workers{w}, Sessions{} {}
+
+        // Evaluate one statement. Called on the loop thread, and
+        // done is called on the loop thread.
+        void evaluate(const work::space, ptr<expression>, callback<response> done);
+
+        // Queue a statement for a session, which is created with
+        // an empty workspace the first time it is seen.
+        void submit(uint64_t session, ptr<expression>, callback<response> done);
+
+        void close(uint64_t session) {
+            Sessions.erase(session);
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,48 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_EVALUATION_FRAME
+#define COSMOS_EVALUATION_FRAME
+
+#include <map>
+#include <mutex>
+#include <cosmos/workspace.hpp>
+
+namespace cosmos::evaluation::async {
+
+    using arguments = vector<ptr<work::item>>;
+
+    // Data fetched for one statement. Functions that wait read it
+    // from the frame of the statement they are evaluated in, which
+    // goes with the statement onto whatever thread evaluates it.
+    class frame {
+        std::map<std::string, ptr<work::item>> Data;
+        mutable std::mutex Mutex;
+
+        static std::string key(cosmos::function, const arguments&);
+
+    public:
+        frame() : Data{}, Mutex{} {}
+
+        void put(cosmos::function, const arguments&, ptr<work::item>);
+
+        // False if nothing was fetched, in which case
+        // the function must get its data by itself.
+        bool get(cosmos::function, const arguments&, ptr<work::item>&) const;
+
+        // the frame of the statement being evaluated on this thread.
+        static const frame* current();
+
+        // make a frame, or none, current on this thread for a scope.
+        struct scope {
+            const frame* Previous;
+
+            scope(const frame*);
+            ~scope();
+        };
+    };
+
+}
+
+#endif
@@ -7,6 +7,9 @@
 
 #include <cosmos/workspace.hpp>
 #include "operators.hpp"
+#include "memo.hpp"
+#include "parallel.hpp"
+#include "frame.hpp"
 
 namespace cosmos {
     // namespace for evaluating user commands. 
@@ -63,7 +66,9 @@ namespace cosmos {
             
             response(const work::space s) : Result{s}, Return{nullptr}, Error{} {};
             response(const work::space s, ptr<work::item> i) : Result{s}, Return{i}, Error{} {}
-            response(struct error e) : Result{}, Return{nullptr}, Error{e} {}
+            
+            // an error which leaves the workspace as it was. 
+            response(const work::space s, struct error e) : Result{s}, Return{nullptr}, Error{e} {}
             response(const response& a) : Result{a.Result}, Return{a.Return}, Error(a.Error) {}
             response(response&& a) : Result{a.Result}, Return{a.Return}, Error{a.Error} {
                 a.Return = nullptr;
@@ -75,7 +80,7 @@ namespace cosmos {
         
         // representation of states of evaluation which are ready
         // for new input and have possibly generated a response.
-        struct open {
+        struct open : accounting::counted<open, accounting::state> {
             work::space Workspace;
             cosmos::list<ptr<open>> Stack;
             
@@ -83,7 +88,7 @@ namespace cosmos {
             open(work::space w) : Workspace{w}, Stack{} {}
             
             virtual ptr<close> read_name(cosmos::name n) const;
-            virtual ptr<close> read_number(N n) const;
+            virtual ptr<close> read_number(number n) const;
             virtual ptr<close> read_address(bitcoin::address a) const;
             virtual ptr<close> read_pubkey(bitcoin::pubkey p) const;
             virtual ptr<close> read_secret(bitcoin::secret s) const;
@@ -105,7 +110,7 @@ namespace cosmos {
         
         // representation of states of evaluation which necessarily
         // require more input before a response can be generated. 
-        struct close {
+        struct close : accounting::counted<close, accounting::state> {
             response Response;
             cosmos::list<ptr<open>> Stack;
             
@@ -125,68 +130,148 @@ namespace cosmos {
             ptr<open> read_operand(op) const override;
             
             inline static ptr<atom> make(A a, work::space w, list<ptr<open>> stack) {
-                return std::make_shared<atom>(new atom{std::make_shared<work::atom<A>>(new work::atom<A>{a}), w, stack});
+                return std::make_shared<atom>(std::make_shared<work::atom<A>>(a), w, stack);
             }
         };
         
-        template <typename A, op o, typename B> 
-        struct operation final : public close {
-            atom<A> Left;
-            atom<B> Right;
-            cosmos::operation<A, o, B> Operation;
-            
-            operation(atom<A> a, atom<B> b) : Left{a}, Right{b}, Operation{} {}
+        // anything that has been evaluated, such as an operation
+        // or a function that has been applied. 
+        struct value final : public close {
+            value(response r, list<ptr<open>> stack) : close{r, stack} {}
             
             ptr<open> read_operand(op) const override;
         };
         
-        template <typename A, op o>
+        // apply an operator to two values. 
+        response operate(const work::space, op, ptr<work::item>, ptr<work::item>);
+        
+        // a value and an operator, waiting for the other value. 
         struct operand final : public open {
-            ptr<work::atom<A>> Left;
+            ptr<work::item> Left;
+            op Operator;
             
-            operand(ptr<work::atom<A>> a, work::space w, list<ptr<open>> stack) : open{w, stack}, Left{a} {}
+            operand(ptr<work::item> a, op o, work::space w, list<ptr<open>> stack) : open{w, stack}, Left{a}, Operator{o} {}
             
             ptr<close> read_name(name n) const override;
-            ptr<close> read_number(N n) const override;
+            ptr<close> read_number(number n) const override;
             ptr<close> read_address(bitcoin::address a) const override;
             ptr<close> read_pubkey(bitcoin::pubkey p) const override;
             ptr<close> read_secret(bitcoin::secret s) const override;
             
+        private:
+            template <typename B>
+            ptr<close> read(B b) const {
+                return std::make_shared<value>(operate(Workspace, Operator, Left, std::make_shared<work::atom<B>>(b)), Stack);
+            }
         };
         
+        // A parenthesis is a nested savepoint. Workspace is the workspace
+        // when it was opened, which is restored if what is inside fails. 
         struct parenthesis final : public open {
             const open* Previous;
             parenthesis(work::space w, const open* p, list<ptr<open>> s) : open{w, s}, Previous{p} {}
             parenthesis(work::space w, const open* p) : open{w}, Previous{p} {}
+            
+            response rollback(struct error e) const {
+                return response{Workspace, e};
+            }
+            
+            // the closing parenthesis, which keeps what was evaluated 
+            // inside if it succeeded and otherwise rolls back. 
+            response close(const response& r) const {
+                if (r.error()) return rollback(r.Error);
+                if (!r.valid()) return rollback(evaluation::error{"invalid workspace"});
+                return r;
+            }
         };
         
+        // a function or a constructor and the arguments read so far. 
         struct sequence : public open {
-            list<ptr<work::item>> Sequence;
+            // the arguments, last first. 
+            expression::parameters Sequence;
             
-            sequence(list<ptr<work::item>> s, work::space w, list<ptr<open>> ss)
+            sequence(expression::parameters s, work::space w, cosmos::list<ptr<open>> ss)
                 : open{w, ss}, Sequence{s} {}
             
-            ptr<sequence> next(ptr<work::item> p) const {
-                return std::make_shared<sequence>(new sequence{Sequence.prepend(p), Workspace, Stack});
-            }
+            virtual ptr<sequence> next(ptr<expression>) const = 0;
+            
+            // the arguments in the order they were read. 
+            expression::parameters parameters() const;
+            
+            // evaluate the arguments against the workspace the sequence 
+            // began with, those that do not write at the same time. 
+            parallel::results<response> evaluated(memo* = nullptr) const;
         };
         
-        struct list final : public sequence {};
+        // Evaluate an expression that has already been read. Pure 
+        // functions are applied through the memo if there is one. 
+        response evaluate(const work::space, ptr<expression>, memo* = nullptr);
+        
+        // evaluate the arguments to a function or constructor,
+        // running those that do not write at the same time. They 
+        // see the frame of the statement on any worker, and those 
+        // that write, which are evaluated here, its transaction. 
+        parallel::results<response> arguments(const work::space w, expression::parameters p, memo* m = nullptr);
+        
+        inline parallel::results<response> sequence::evaluated(memo* m) const {
+            return arguments(Workspace, parameters(), m);
+        }
+        
+        // the stats function, which returns a report of the memory
+        // used by the workspace and of every live object by kind. 
+        inline response stats(const work::space w) {
+            stringstream ss{};
+            accounting::write(ss, accounting::measure(w));
+            accounting::write(ss);
+            return response{w, std::make_shared<work::atom<std::string>>(ss.str())};
+        }
+        
+        struct list final : public sequence {
+            list(expression::parameters s, work::space w, cosmos::list<ptr<open>> ss) : sequence{s, w, ss} {}
+            
+            ptr<sequence> next(ptr<expression> p) const override {
+                return std::make_shared<list>(Sequence.prepend(p), Workspace, Stack);
+            }
+        };
         
         struct function final : public sequence {
             cosmos::function Function;
+            
+            function(cosmos::function f, expression::parameters s, work::space w, cosmos::list<ptr<open>> ss)
+                : sequence{s, w, ss}, Function{f} {}
+            
+            ptr<sequence> next(ptr<expression> p) const override {
+                return std::make_shared<function>(Function, Sequence.prepend(p), Workspace, Stack);
+            }
+            
+            // evaluate the arguments read so far and apply the function to them. 
+            response apply() const;
+            
+            // the same, as part of a session. Results of pure 
+            // functions are taken from the session's memo. 
+            response apply(memo&) const;
         };
         
-        struct construction : public sequence {
+        struct construction final : public sequence {
             cosmos::constructor Constructor;
+            
+            construction(cosmos::constructor c, expression::parameters s, work::space w, cosmos::list<ptr<open>> ss)
+                : sequence{s, w, ss}, Constructor{c} {}
+            
+            ptr<sequence> next(ptr<expression> p) const override {
+                return std::make_shared<construction>(Constructor, Sequence.prepend(p), Workspace, Stack);
+            }
+            
+            // evaluate the arguments read so far and construct the item. 
+            response construct(memo* = nullptr) const;
         };
             
         inline ptr<close> open::read_name(cosmos::name n) const {
             return atom<cosmos::name>::make(n, Workspace, Stack);
         }
         
-        inline ptr<close> open::read_number(N n) const {
-            return atom<N>::make(n, Workspace, Stack);
+        inline ptr<close> open::read_number(number n) const {
+            return atom<number>::make(n, Workspace, Stack);
         }
         
         inline ptr<close> open::read_address(bitcoin::address a) const {
@@ -201,41 +286,53 @@ namespace cosmos {
             return atom<bitcoin::secret>::make(s, Workspace, Stack);
         }
         
+        inline ptr<open> open::read_function(cosmos::function f) const {
+            return std::make_shared<function>(f, expression::parameters{}, Workspace, Stack);
+        }
+        
+        inline ptr<open> open::read_construction(constructor c) const {
+            return std::make_shared<construction>(c, expression::parameters{}, Workspace, Stack);
+        }
+        
         inline ptr<open> open::read_parenthesis() const {
-            return std::make_shared<open>(new parenthesis{Workspace, this, Stack});
+            return std::make_shared<parenthesis>(Workspace, this, Stack);
         }
         
-        open::~open() {};
+        inline open::~open() {};
         
-        template <typename A, op o>
-        inline ptr<close> operand<A, o>::read_name(name n) const {
-            return std::make_shared<close>(new operation<A, o, name>(Left, n));
+        template <typename A>
+        inline ptr<open> atom<A>::read_operand(op o) const {
+            return std::make_shared<operand>(Atom, o, Response.Result, Stack);
+        }
+        
+        inline ptr<open> value::read_operand(op o) const {
+            return std::make_shared<operand>(Response.Return, o, Response.Result, Stack);
         }
         
-        template <typename A, op o>
-        inline ptr<close> operand<A, o>::read_number(N n) const {
-            return std::make_shared<close>(new operation<A, o, N>(Left, n));
+        inline ptr<close> operand::read_number(number n) const {
+            return read(n);
         }
         
-        template <typename A, op o>
-        inline ptr<close> operand<A, o>::read_address(bitcoin::address a) const {
-            return std::make_shared<close>(new operation<A, o, bitcoin::address>(Left, a));
+        inline ptr<close> operand::read_address(bitcoin::address a) const {
+            return read(a);
         }
         
-        template <typename A, op o>
-        inline ptr<close> operand<A, o>::read_pubkey(bitcoin::pubkey p) const {
-            return std::make_shared<close>(new operation<A, o, bitcoin::pubkey>(Left, p));
+        inline ptr<close> operand::read_pubkey(bitcoin::pubkey p) const {
+            return read(p);
         }
         
-        template <typename A, op o>
-        inline ptr<close> operand<A, o>::read_secret(bitcoin::secret s) const {
-            return std::make_shared<close>(new operation<A, o, bitcoin::secret>(Left, s));
+        inline ptr<close> operand::read_secret(bitcoin::secret s) const {
+            return read(s);
         }
         
     }
     
     evaluation::response evaluate(const work::space, stringstream& s);
     
+    // evaluate as part of a session that remembers the
+    // results of pure functions between statements. 
+    evaluation::response evaluate(const work::space, stringstream& s, evaluation::memo&);
+    
 }
 
 #endif 
@@ -0,0 +1,74 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_EVALUATION_LOOP
+#define COSMOS_EVALUATION_LOOP
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <cosmos/cosmos.hpp>
+
+namespace cosmos::evaluation {
+
+    // Single-threaded event loop over epoll. Every callback runs on the
+    // thread that calls run(). post() and stop() may be called from any
+    // thread; everything else only from callbacks.
+    class loop {
+        using clock = std::chrono::steady_clock;
+
+        struct timer {
+            clock::time_point When;
+            uint64_t Order;
+            std::function<void()> Call;
+
+            bool operator>(const timer& t) const {
+                return When > t.When || (When == t.When && Order > t.Order);
+            }
+        };
+
+        int Epoll;
+
+        // eventfd which wakes the loop when something is posted.
+        int Wake;
+
+        std::mutex Mutex;
+        std::deque<std::function<void()>> Posted;
+
+        std::priority_queue<timer, vector<timer>, std::greater<timer>> Timers;
+        uint64_t Order;
+
+        std::map<int, std::function<void(uint32)>> Watched;
+        std::atomic<bool> Stopped;
+
+        void run_posted();
+        void run_timers();
+
+    public:
+        loop();
+        ~loop();
+
+        loop(const loop&) = delete;
+        loop& operator=(const loop&) = delete;
+
+        void post(std::function<void()>);
+
+        void after(std::chrono::microseconds, std::function<void()>);
+
+        // call with the epoll events whenever the descriptor is ready.
+        void watch(int fd, uint32 events, std::function<void(uint32)>);
+        void unwatch(int fd);
+
+        // until stop() is called.
+        void run();
+        void stop();
+    };
+
+}
+
+#endif
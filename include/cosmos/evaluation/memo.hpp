@@ -0,0 +1,139 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_EVALUATION_MEMO
+#define COSMOS_EVALUATION_MEMO
+
+#include <list>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+#include <cosmos/workspace.hpp>
+#include <cosmos/crypto/sha256.hpp>
+
+namespace cosmos::evaluation {
+
+    // functions whose result depends only on their arguments
+    // and which do not touch the workspace. next_address is not
+    // one, since the same keysource gives a new address once its
+    // position moves on. identity is pure but returns its argument,
+    // so there is nothing to save by caching it.
+    constexpr bool pure(cosmos::function f) {
+        switch (f) {
+            case cosmos::SHA256:
+            case cosmos::SHA512:
+            case cosmos::address:
+            case cosmos::public_key:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // per-session cache of the results of pure function
+    // applications, together with a hash-consing table so
+    // that equal expressions are represented by one node.
+    class memo {
+    public:
+        using digest = crypto::sha256::digest;
+
+        struct key {
+            cosmos::function Function;
+            digest Arguments;
+
+            bool operator==(const key& k) const {
+                return Function == k.Function && Arguments == k.Arguments;
+            }
+        };
+
+        struct statistics {
+            uint64_t Hits;
+            uint64_t Misses;
+            uint64_t Evictions;
+
+            // applications of impure functions, which are never cached.
+            uint64_t Bypassed;
+
+            uint64_t Interned;
+            uint64_t Shared;
+
+            double rate() const {
+                uint64_t total = Hits + Misses;
+                return total == 0 ? 0 : double(Hits) / double(total);
+            }
+        };
+
+        memo(size_t capacity) : Capacity{capacity}, Results{}, Index{}, Nodes{}, Stats{}, Mutex{} {}
+
+        static digest hash(const expression&);
+
+        static digest hash(cosmos::list<ptr<work::item>>);
+
+        // Return the cached result of a function application or
+        // else compute it and remember it if the function is pure.
+        template <typename compute>
+        ptr<work::item> apply(cosmos::function, cosmos::list<ptr<work::item>> args, compute);
+
+        // Return the node already in use for an equal
+        // expression if there is one.
+        ptr<expression> intern(ptr<expression>);
+
+        statistics stats() const {
+            std::lock_guard<std::mutex> lock{Mutex};
+            return Stats;
+        }
+
+        void write(ostream&) const;
+
+    private:
+        struct hasher {
+            size_t operator()(const key& k) const {
+                size_t h = k.Function;
+                for (int i = 0; i < 8; i++) h = (h << 8) ^ k.Arguments[i];
+                return h;
+            }
+
+            size_t operator()(const digest& d) const {
+                size_t h = 0;
+                for (int i = 0; i < 8; i++) h = (h << 8) | d[i];
+                return h;
+            }
+        };
+
+        using entry = std::pair<key, ptr<work::item>>;
+
+        size_t Capacity;
+        std::list<entry> Results;
+        std::unordered_map<key, std::list<entry>::iterator, hasher> Index;
+        std::unordered_map<digest, std::weak_ptr<expression>, hasher> Nodes;
+        statistics Stats;
+        mutable std::mutex Mutex;
+
+        ptr<work::item> find(const key&);
+        void insert(const key&, ptr<work::item>);
+    };
+
+    template <typename compute>
+    ptr<work::item> memo::apply(cosmos::function f, cosmos::list<ptr<work::item>> args, compute fn) {
+        if (!pure(f)) {
+            {
+                std::lock_guard<std::mutex> lock{Mutex};
+                Stats.Bypassed++;
+            }
+
+            return fn();
+        }
+
+        key k{f, hash(args)};
+        ptr<work::item> r = find(k);
+        if (r != nullptr) return r;
+
+        r = fn();
+        if (r != nullptr) insert(k, r);
+        return r;
+    }
+
+}
+
+#endif
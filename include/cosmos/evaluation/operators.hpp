@@ -7,6 +7,7 @@
 
 #include <cosmos/cosmos.hpp>
 #include <cosmos/name.hpp>
+#include <cosmos/number.hpp>
 
 namespace cosmos {
     
@@ -20,14 +21,14 @@ namespace cosmos {
         }
     };
     
-    template <> struct operation<N, plus, N> {
-        N operator()(N n, N m) {
+    template <> struct operation<number, plus, number> {
+        number operator()(const number& n, const number& m) {
             return n + m;
         }
     };
     
-    template <> struct operation<N, times, N> {
-        N operator()(N n, N m) {
+    template <> struct operation<number, times, number> {
+        number operator()(const number& n, const number& m) {
             return n * m;
         }
     };
@@ -50,6 +51,8 @@ namespace cosmos {
         }
     };
     
+    // the secret may be a private key, so this does not use
+    // the variable-time tables in precompute.hpp.
     template <> struct operation<bitcoin::pubkey, times, bitcoin::secret> {
         bitcoin::pubkey operator()(bitcoin::pubkey a, bitcoin::secret b) {
             return a * b;
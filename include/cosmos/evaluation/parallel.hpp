@@ -0,0 +1,151 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_EVALUATION_PARALLEL
+#define COSMOS_EVALUATION_PARALLEL
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <cosmos/workspace.hpp>
+
+namespace cosmos::evaluation::parallel {
+
+    // work-stealing thread pool. Each worker takes tasks from the back
+    // of its own queue and steals from the front of the others'. A
+    // thread waiting for its tasks to finish runs other tasks in the
+    // meantime, so nested evaluations cannot deadlock the pool.
+    class workers {
+        struct queue {
+            std::deque<std::function<void()>> Tasks;
+            std::mutex Mutex;
+        };
+
+        vector<std::unique_ptr<queue>> Queues;
+        vector<std::thread> Threads;
+        std::atomic<bool> Done;
+        std::atomic<uint64_t> Waiting;
+        std::atomic<uint32> Next;
+        std::mutex Sleep;
+        std::condition_variable Wake;
+
+        // the queue belonging to this thread, if it is a worker.
+        static thread_local int Self;
+
+        bool run_one(uint32 home);
+        void work(uint32);
+
+    public:
+        workers(uint32 threads);
+        ~workers();
+
+        uint32 size() const {
+            return Queues.size();
+        }
+
+        void push(std::function<void()>);
+
+        // run tasks until done returns true.
+        void help(const std::function<bool()>& done);
+
+        static workers& global();
+    };
+
+    // Call every function concurrently and return the results in order.
+    // If any throw, the first exception in order is rethrown.
+    template <typename X>
+    vector<X> map(workers& w, vector<std::function<X()>> fs) {
+        const size_t n = fs.size();
+        vector<X> results(n);
+        vector<std::exception_ptr> errors(n);
+        std::atomic<size_t> remaining{n};
+
+        auto task = [&](size_t i) {
+            try {
+                results[i] = fs[i]();
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+
+            remaining--;
+        };
+
+        for (size_t i = 1; i < n; i++) w.push([&task, i]() { task(i); });
+        if (n > 0) task(0);
+        w.help([&remaining]() -> bool { return remaining == 0; });
+
+        for (std::exception_ptr e : errors) if (e) std::rethrow_exception(e);
+        return results;
+    }
+
+    template <typename response>
+    struct results {
+        vector<response> Responses;
+
+        // the workspace after every argument has been evaluated.
+        work::space Workspace;
+    };
+
+    // Evaluate the arguments to a function or constructor. An argument
+    // that writes to the workspace is evaluated by itself and the ones
+    // after it see its result. Runs of arguments between writers are
+    // evaluated at the same time against the same workspace. The
+    // result is therefore the same as evaluating from left to right.
+    // Literals and names cost less than handing them to another
+    // thread, so they are evaluated here as they are reached.
+    template <typename eval>
+    auto evaluate(workers& w, work::space s, expression::parameters ps, eval e)
+        -> results<decltype(e(s, ptr<expression>{}))> {
+        using response = decltype(e(s, ptr<expression>{}));
+
+        results<response> x{{}, s};
+
+        // the place of each in the responses.
+        vector<size_t> places{};
+        vector<std::function<response()>> run{};
+
+        auto flush = [&]() {
+            if (run.empty()) return;
+            if (run.size() == 1) x.Responses[places[0]] = run[0]();
+            else {
+                vector<response> y = map(w, run);
+                for (size_t i = 0; i < y.size(); i++) x.Responses[places[i]] = std::move(y[i]);
+            }
+
+            places.clear();
+            run.clear();
+        };
+
+        for (ptr<expression> p : ps) {
+            if (!p->writes()) {
+                if (dynamic_cast<const expression::compound*>(p.get()) == nullptr) {
+                    x.Responses.push_back(e(x.Workspace, p));
+                    continue;
+                }
+
+                work::space current = x.Workspace;
+                places.push_back(x.Responses.size());
+                x.Responses.emplace_back();
+                run.push_back([e, current, p]() -> response { return e(current, p); });
+                continue;
+            }
+
+            flush();
+            for (const response& r : x.Responses) if (r.error()) return x;
+            x.Responses.push_back(e(x.Workspace, p));
+            if (x.Responses.back().error()) return x;
+            x.Workspace = x.Responses.back().Result;
+        }
+
+        flush();
+        return x;
+    }
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_EVALUATION_TRANSACTION
+#define COSMOS_EVALUATION_TRANSACTION
+
+#include "interpreter.hpp"
+
+namespace cosmos::evaluation {
+
+    // A workspace together with a stack of savepoints. Workspaces are
+    // persistent, so a savepoint is only the root of an earlier version
+    // and begin, commit and rollback copy a pointer no matter how large
+    // the workspace is.
+    class transaction {
+        work::space Current;
+        cosmos::list<work::space> Savepoints;
+        uint32 Depth;
+
+    public:
+        class error : public std::exception {
+            std::string Message;
+
+        public:
+            error(std::string);
+
+            const char* what() const noexcept final override;
+        };
+
+        transaction(const work::space w) : Current{w}, Savepoints{}, Depth{0} {}
+
+        const work::space& current() const {
+            return Current;
+        }
+
+        uint32 depth() const {
+            return Depth;
+        }
+
+        // remember the current workspace.
+        void begin();
+
+        void update(const work::space);
+
+        // forget the last savepoint and keep the current workspace.
+        void commit();
+
+        // return to the last savepoint.
+        void rollback();
+
+        // Finish the innermost savepoint with the response to what was
+        // evaluated inside it. An error rolls back, and the response
+        // then carries the workspace from before rather than nothing.
+        response finish(const response&);
+
+        // evaluate in a new savepoint over w.
+        response savepoint(const work::space w, ptr<expression>, memo* = nullptr);
+
+        // The transaction of the statement being evaluated on this thread,
+        // whose stack each parenthesis opens a savepoint on. Arguments
+        // evaluated on other threads do not write, so they have none.
+        static transaction* active();
+
+        // make a transaction, or none, current on this thread for a scope.
+        struct scope {
+            transaction* Previous;
+
+            scope(transaction*);
+            ~scope();
+        };
+    };
+
+    // evaluate one statement as a transaction over w.
+    response statement(const work::space w, ptr<expression>, memo* = nullptr);
+
+    // evaluate the inside of a parenthesis in a savepoint of the
+    // current transaction, or of a new one if there is none.
+    response parenthesis(const work::space w, ptr<expression>, memo* = nullptr);
+
+}
+
+#endif
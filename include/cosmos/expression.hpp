@@ -5,6 +5,7 @@
 #ifndef COSMOS_EXPRESSION
 #define COSMOS_EXPRESSION
 
+#include <optional>
 #include "cosmos.hpp"
 #include "token.hpp"
 #include "format.hpp"
@@ -20,7 +21,14 @@ namespace cosmos {
         }
         
         template <typename t>
-        static void write_sequence(const parameters&, stringstream& ss);
+        static void write_sequence(const parameters& p, stringstream& ss) {
+            bool first = true;
+            for (ptr<expression> e : p) {
+                if (!first) token::write<t>{}(ss);
+                first = false;
+                e->write(ss);
+            }
+        }
         
         inline static void write_list(const parameters& p, stringstream& ss) {
             token::write<token::open_brace>{}(ss);
@@ -32,18 +40,52 @@ namespace cosmos {
         
         struct list;
         
-        template <typename X>
-        struct constructor;
+        struct parenthesis;
+        
+        template <cosmos::constructor c>
+        struct construction;
         
         template <function fn>
         struct application;
         
-        template <operand op>
+        template <op o>
         struct operation;
         
         template <typename X>
         struct atomic;
         
+        // canonical text of this expression. Two expressions
+        // are the same if and only if they write the same text. 
+        virtual void write(stringstream&) const = 0;
+        
+        // whether evaluating this expression can change the
+        // workspace. Expressions that can't may be evaluated
+        // in any order or at the same time. 
+        virtual bool writes() const {
+            return false;
+        }
+        
+        // whether evaluating this expression needs data from
+        // outside the workspace, such as a disk or an indexer. 
+        virtual bool waits() const {
+            return false;
+        }
+        
+        // the function this expression applies, if it is an application. 
+        virtual std::optional<function> applies() const {
+            return {};
+        }
+        
+        // the constructor this expression applies, if it is a construction. 
+        virtual std::optional<cosmos::constructor> constructs() const {
+            return {};
+        }
+        
+        // the operator of this expression, if it is an operation. 
+        virtual std::optional<op> operates() const {
+            return {};
+        }
+        
         virtual ~expression() = 0;
         
     };
@@ -57,10 +99,44 @@ namespace cosmos {
         
         compound(parameters arg) : Parameters{arg} {}
         
+        bool writes() const override {
+            for (ptr<expression> e : Parameters) if (e->writes()) return true;
+            return false;
+        }
+        
+        bool waits() const override {
+            for (ptr<expression> e : Parameters) if (e->waits()) return true;
+            return false;
+        }
+        
         virtual ~compound() = 0;
     };
     
-    struct expression::list final : public compound {};
+    struct expression::list final : public compound {
+        using compound::compound;
+        
+        void write(stringstream& ss) const override {
+            expression::write_list(Parameters, ss);
+        }
+    };
+    
+    // an expression in parentheses, which is evaluated as a 
+    // savepoint inside the statement that contains it. 
+    struct expression::parenthesis final : public compound {
+        using compound::compound;
+        
+        parenthesis(ptr<expression> e) : compound{parameters{}.prepend(e)} {}
+        
+        ptr<expression> inside() const {
+            return Parameters.first();
+        }
+        
+        void write(stringstream& ss) const override {
+            token::write<token::open_paren>{}(ss);
+            inside()->write(ss);
+            token::write<token::close_paren>{}(ss);
+        }
+    };
     
     namespace format {
         template <> struct write<text, expression::list> {
@@ -70,13 +146,95 @@ namespace cosmos {
         };
     }
     
-    template <operand op>
-    struct expression::operation final : public expression::compound {};
+    // how tightly an operator holds its operands. 
+    constexpr int binding(op o) {
+        return o == times ? 3 : o == plus ? 2 : o == concat ? 1 : 0;
+    }
+    
+    template <op o>
+    struct expression::operation final : public expression::compound {
+        using compound::compound;
+        
+        // operands that are operations which hold no tighter are 
+        // in parentheses, so that the text reads back the same. 
+        void write(stringstream& ss) const override {
+            bool first = true;
+            for (ptr<expression> e : Parameters) {
+                if (!first) token::write<typename token::operand<o>::token>{}(ss);
+                first = false;
+                
+                std::optional<op> x = e->operates();
+                bool group = x && binding(*x) <= binding(o);
+                if (group) token::write<token::open_paren>{}(ss);
+                e->write(ss);
+                if (group) token::write<token::close_paren>{}(ss);
+            }
+        }
+        
+        bool writes() const override {
+            return o == cosmos::set || compound::writes();
+        }
+        
+        std::optional<op> operates() const override {
+            return o;
+        }
+    };
+    
+    // functions that change the workspace. 
+    constexpr bool writes(function f) {
+        return f == update || f == spend || f == evaluate_script;
+    }
+    
+    // functions that need transactions and outputs
+    // which are not in the workspace. 
+    constexpr bool waits(function f) {
+        return f == update || f == spend || f == evaluate_script;
+    }
+    
+    template <function fn>
+    struct expression::application final : public expression::compound {
+        using compound::compound;
+        
+        void write(stringstream& ss) const override {
+            ss << token::word(fn);
+            token::write<token::open_paren>{}(ss);
+            expression::write_sequence<token::comma>(Parameters, ss);
+            token::write<token::close_paren>{}(ss);
+        }
+        
+        bool writes() const override {
+            return cosmos::writes(fn) || compound::writes();
+        }
+        
+        bool waits() const override {
+            return cosmos::waits(fn) || compound::waits();
+        }
+        
+        std::optional<function> applies() const override {
+            return fn;
+        }
+    };
+    
+    template <cosmos::constructor c>
+    struct expression::construction final : public expression::compound {
+        using compound::compound;
+        
+        void write(stringstream& ss) const override {
+            ss << token::word(c);
+            token::write<token::open_paren>{}(ss);
+            expression::write_sequence<token::comma>(Parameters, ss);
+            token::write<token::close_paren>{}(ss);
+        }
+        
+        std::optional<cosmos::constructor> constructs() const override {
+            return c;
+        }
+    };
     
     namespace format {
-        template <operand op> struct write<text, expression::operation<op>> {
-            void operator()(const expression::operation<op>& o, stringstream& ss) const {
-                expression::write_sequence<token::operand<op>::token>(o, ss);
+        template <op o> struct write<text, expression::operation<o>> {
+            void operator()(const expression::operation<o>& x, stringstream& ss) const {
+                x.write(ss);
             }
         };
     }
@@ -84,12 +242,29 @@ namespace cosmos {
     template <typename X>
     struct expression::atomic final : public expression {
         X Atom;
+        
+        atomic(X x) : Atom{x} {}
+        
+        void write(stringstream& ss) const override {
+            format::write<format::text, X>{}(Atom, ss);
+        }
     };
     
+    // strings are written quoted, with quotes and backslashes escaped. 
+    template <>
+    inline void expression::atomic<std::string>::write(stringstream& ss) const {
+        ss << '"';
+        for (char c : Atom) {
+            if (c == '"' || c == '\\') ss << '\\';
+            ss << c;
+        }
+        ss << '"';
+    }
+    
     namespace format {
         template <typename X> struct write<text, expression::atomic<X>> {
             void operator()(const expression::atomic<X>& x, stringstream& ss) const {
-                format::write<format::text, X>(x.Atom, ss);
+                format::write<format::text, X>{}(x.Atom, ss);
             }
         };
     }
@@ -0,0 +1,78 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_FEES
+#define COSMOS_FEES
+
+#include "sign.hpp"
+
+namespace cosmos::bitcoin {
+
+    // Serialized sizes of transactions, computed from the sizes of
+    // their scripts without serializing anything, so that the fee and
+    // the change can be known before signing and signing is done once.
+    namespace fees {
+
+        inline constexpr size_t varint(uint64_t n) {
+            return n < 0xfd ? 1 : n <= 0xffff ? 3 : n <= 0xffffffff ? 5 : 9;
+        }
+
+        // DER with low S, so at most 33 bytes of r and 32 of s,
+        // together with the sighash byte.
+        constexpr size_t max_signature = 6 + 33 + 32 + 1;
+
+        constexpr size_t pay_to_address_script = 25;
+
+        // <signature> <compressed pubkey>
+        inline constexpr size_t pay_to_address_input_script(size_t signature = max_signature) {
+            return 1 + signature + 1 + 33;
+        }
+
+        // outpoint, script and sequence.
+        inline constexpr size_t input(size_t script) {
+            return 32 + 4 + varint(script) + script + 4;
+        }
+
+        // value and script.
+        inline constexpr size_t output(size_t script) {
+            return 8 + varint(script) + script;
+        }
+
+        // version, inputs, outputs and locktime.
+        size_t size(const vector<size_t>& input_scripts, const vector<size_t>& output_scripts);
+
+        // The size once every input is signed as a pay-to-address
+        // redemption. This is an upper bound, since a signature may
+        // be a byte or two shorter than the longest.
+        size_t size(const sign::transaction&);
+
+        // a fixed amount plus an amount per byte, rounded up.
+        struct fee {
+            uint64_t Fixed;
+            double PerByte;
+
+            fee(uint64_t f) : Fixed{f}, PerByte{0} {}
+            fee(uint64_t f, double r) : Fixed{f}, PerByte{r} {}
+
+            uint64_t operator()(size_t size) const;
+        };
+
+        // outputs smaller than this are not relayed.
+        constexpr uint64_t dust = 546;
+
+        // Set the value of the last output, which is change, to whatever
+        // is left after the fee. If that would be dust the change output
+        // is removed and the rest goes to the fee. Returns the fee, or
+        // false if the inputs are not enough.
+        bool balance(sign::transaction&, const fee&, uint64_t& paid);
+
+        // Costs for choosing inputs to pay for the given outputs at a fee,
+        // with change to a pay-to-address output.
+        utxo::request request(const vector<sign::output>&, const fee&);
+
+    }
+
+}
+
+#endif
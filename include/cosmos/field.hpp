@@ -0,0 +1,77 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_FIELD
+#define COSMOS_FIELD
+
+#include "keys.hpp"
+#include "field/lanes.hpp"
+
+namespace cosmos::bitcoin {
+
+    // Arithmetic in the secp256k1 field on eight elements at once,
+    // one in each lane of a vector, for adding many independent
+    // points. With AVX-512 IFMA the limbs are multiplied with
+    // vpmadd52luq and vpmadd52huq. Otherwise the same code runs on
+    // plain integers, which is the fallback and also how the vector
+    // code is checked on a host without IFMA.
+    namespace field {
+
+        enum backend {
+            portable = 0,
+            ifma = 1
+        };
+
+        const char* name(backend);
+
+        // whether this build and this CPU can run the backend.
+        bool supported(backend);
+
+        // IFMA where it is supported, unless the environment
+        // variable COSMOS_FIELD is set to portable.
+        backend best();
+
+        // Compare the backend with GMP on count vectors of random
+        // products, differences and inverses, and with the library
+        // on points from a walk. Returns the number of mismatches.
+        uint64_t check(backend, uint32 count, uint64_t seed = 1);
+
+        // The pubkeys of start, start + step, start + 2 step and so on,
+        // a batch at a time. Each batch moves every one of its points
+        // on by a batch of steps, so the additions are independent and
+        // share one inversion, and are spread across the lanes.
+        class walk {
+            kernels Kernels;
+            uint32 Vectors;
+
+            // points in 52-bit limbs, as laid out in lanes.hpp.
+            vector<uint64_t> X;
+            vector<uint64_t> Y;
+            vector<uint64_t> Scratch;
+
+            // size steps, in every lane.
+            vector<uint64_t> Qx;
+            vector<uint64_t> Qy;
+            keys::pubkey_bytes Q;
+
+            void write(keys::pubkey_bytes*) const;
+            void read(const keys::pubkey_bytes*);
+
+        public:
+            // size is rounded up to a multiple of eight.
+            walk(const secret& start, uint32 step, uint32 size = 256, backend = best());
+
+            uint32 size() const {
+                return Vectors * lanes;
+            }
+
+            // the next size pubkeys, in order.
+            void next(keys::pubkey_bytes*);
+        };
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,301 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_FIELD_LANES
+#define COSMOS_FIELD_LANES
+
+#include <cstdint>
+#include <cstring>
+
+namespace cosmos::bitcoin::field {
+
+    // Eight elements are kept as five limbs of eight lanes, limb
+    // first, so that one limb of all eight elements is one vector.
+    // A limb holds 52 bits once it is normalized, and a normalized
+    // element is less than 2^260 but need not be less than p.
+    constexpr uint32_t lanes = 8;
+    constexpr uint32_t limbs = 5;
+    constexpr uint32_t stride = limbs * lanes;
+
+    // what each backend provides, on vectors of eight elements.
+    struct kernels {
+        void (*Mul)(const uint64_t* a, const uint64_t* b, uint64_t* out);
+        void (*Sub)(const uint64_t* a, const uint64_t* b, uint64_t* out);
+        void (*Inv)(const uint64_t* a, uint64_t* out);
+
+        // Add the point q to each of the points in m vectors of x and y,
+        // with one inversion, using m vectors of scratch. False, and
+        // nothing is changed, if any point has the same x as q.
+        bool (*Add)(uint64_t* x, uint64_t* y, uint32_t m, const uint64_t* qx, const uint64_t* qy, uint64_t* scratch);
+    };
+
+    kernels portable_kernels();
+
+#ifdef COSMOS_IFMA
+    kernels ifma_kernels();
+#endif
+
+    constexpr uint64_t mask = (uint64_t{1} << 52) - 1;
+
+    // 2^260 mod p, since limb 5 would have weight 2^260.
+    constexpr uint64_t fold = 0x1000003d10;
+
+    // 32 p, which is added before subtracting so no limb goes below zero.
+    constexpr uint64_t p32[limbs] = {0x1ffffdfffff85e0, 0x1ffffffffffffe0, 0x1ffffffffffffe0, 0x1ffffffffffffe0, 0x1fffffffffffe0};
+
+    // Eight lanes of plain integers with the two IFMA instructions
+    // written out, which is both the portable backend and a way to
+    // run the vector code on a host without IFMA.
+    struct emulated {
+        struct vec {
+            uint64_t Lane[lanes];
+        };
+
+        static vec load(const uint64_t* p) {
+            vec v;
+            std::memcpy(v.Lane, p, sizeof(v.Lane));
+            return v;
+        }
+
+        static void store(uint64_t* p, const vec& v) {
+            std::memcpy(p, v.Lane, sizeof(v.Lane));
+        }
+
+        static vec set(uint64_t x) {
+            vec v;
+            for (uint32_t i = 0; i < lanes; i++) v.Lane[i] = x;
+            return v;
+        }
+
+        static vec add(const vec& a, const vec& b) {
+            vec v;
+            for (uint32_t i = 0; i < lanes; i++) v.Lane[i] = a.Lane[i] + b.Lane[i];
+            return v;
+        }
+
+        static vec sub(const vec& a, const vec& b) {
+            vec v;
+            for (uint32_t i = 0; i < lanes; i++) v.Lane[i] = a.Lane[i] - b.Lane[i];
+            return v;
+        }
+
+        static vec low(const vec& a) {
+            vec v;
+            for (uint32_t i = 0; i < lanes; i++) v.Lane[i] = a.Lane[i] & mask;
+            return v;
+        }
+
+        static vec high(const vec& a) {
+            vec v;
+            for (uint32_t i = 0; i < lanes; i++) v.Lane[i] = a.Lane[i] >> 52;
+            return v;
+        }
+
+        // vpmadd52luq: add the low 52 bits of the product of the low 52 bits.
+        static vec madd_low(const vec& c, const vec& a, const vec& b) {
+            vec v;
+            for (uint32_t i = 0; i < lanes; i++)
+                v.Lane[i] = c.Lane[i] + (uint64_t((unsigned __int128)(a.Lane[i] & mask) * (b.Lane[i] & mask)) & mask);
+            return v;
+        }
+
+        // vpmadd52huq: add the high 52 bits of the same product.
+        static vec madd_high(const vec& c, const vec& a, const vec& b) {
+            vec v;
+            for (uint32_t i = 0; i < lanes; i++)
+                v.Lane[i] = c.Lane[i] + uint64_t(((unsigned __int128)(a.Lane[i] & mask) * (b.Lane[i] & mask)) >> 52);
+            return v;
+        }
+    };
+
+    // The arithmetic, written once for any vector type V with the
+    // operations of emulated.
+    template <typename V>
+    struct arithmetic {
+        using vec = typename V::vec;
+
+        struct element {
+            vec L[limbs];
+        };
+
+        static element load(const uint64_t* p) {
+            element e;
+            for (uint32_t i = 0; i < limbs; i++) e.L[i] = V::load(p + i * lanes);
+            return e;
+        }
+
+        static void store(uint64_t* p, const element& e) {
+            for (uint32_t i = 0; i < limbs; i++) V::store(p + i * lanes, e.L[i]);
+        }
+
+        // Carry so every limb has 52 bits, and fold anything above
+        // 2^260 back into limb 0. Limbs may be up to 2^63 going in.
+        static void normalize(vec l[limbs]) {
+            const vec r = V::set(fold);
+            for (int pass = 0; pass < 2; pass++) {
+                for (uint32_t i = 0; i < limbs - 1; i++) {
+                    l[i + 1] = V::add(l[i + 1], V::high(l[i]));
+                    l[i] = V::low(l[i]);
+                }
+
+                vec t = V::high(l[limbs - 1]);
+                l[limbs - 1] = V::low(l[limbs - 1]);
+
+                // At most 1 on the second pass, and then the rest is
+                // too small for limb 0 to overflow again.
+                l[0] = V::madd_low(l[0], t, r);
+            }
+        }
+
+        static element add(const element& a, const element& b) {
+            element e;
+            for (uint32_t i = 0; i < limbs; i++) e.L[i] = V::add(a.L[i], b.L[i]);
+            normalize(e.L);
+            return e;
+        }
+
+        static element sub(const element& a, const element& b) {
+            element e;
+            for (uint32_t i = 0; i < limbs; i++) e.L[i] = V::sub(V::add(a.L[i], V::set(p32[i])), b.L[i]);
+            normalize(e.L);
+            return e;
+        }
+
+        static element mul(const element& a, const element& b) {
+            const vec zero = V::set(0);
+            vec c[2 * limbs];
+            for (uint32_t k = 0; k < 2 * limbs; k++) c[k] = zero;
+
+            for (uint32_t i = 0; i < limbs; i++) for (uint32_t j = 0; j < limbs; j++) {
+                c[i + j] = V::madd_low(c[i + j], a.L[i], b.L[j]);
+                c[i + j + 1] = V::madd_high(c[i + j + 1], a.L[i], b.L[j]);
+            }
+
+            // the upper half must be in 52-bit limbs to be multiplied again.
+            for (uint32_t k = limbs; k < 2 * limbs - 1; k++) {
+                c[k + 1] = V::add(c[k + 1], V::high(c[k]));
+                c[k] = V::low(c[k]);
+            }
+            vec top = V::high(c[2 * limbs - 1]);
+            c[2 * limbs - 1] = V::low(c[2 * limbs - 1]);
+
+            // limb k + 5 times 2^260 is limb k times fold. What lands
+            // on limb 5 again is folded once more.
+            const vec r = V::set(fold);
+            vec over = zero;
+            for (uint32_t k = 0; k < limbs; k++) {
+                c[k] = V::madd_low(c[k], c[k + limbs], r);
+                if (k + 1 < limbs) c[k + 1] = V::madd_high(c[k + 1], c[k + limbs], r);
+                else over = V::madd_high(over, c[k + limbs], r);
+            }
+            over = V::madd_low(over, top, r);
+            c[0] = V::madd_low(c[0], over, r);
+            c[1] = V::madd_high(c[1], over, r);
+
+            element e;
+            for (uint32_t k = 0; k < limbs; k++) e.L[k] = c[k];
+            normalize(e.L);
+            return e;
+        }
+
+        static element sqr(const element& a, uint32_t n = 1) {
+            element e = a;
+            for (uint32_t i = 0; i < n; i++) e = mul(e, e);
+            return e;
+        }
+
+        // a^(p - 2), with the addition chain used by libsecp256k1.
+        static element inv(const element& a) {
+            element x2 = mul(sqr(a), a);
+            element x3 = mul(sqr(x2), a);
+            element x6 = mul(sqr(x3, 3), x3);
+            element x9 = mul(sqr(x6, 3), x3);
+            element x11 = mul(sqr(x9, 2), x2);
+            element x22 = mul(sqr(x11, 11), x11);
+            element x44 = mul(sqr(x22, 22), x22);
+            element x88 = mul(sqr(x44, 44), x44);
+            element x176 = mul(sqr(x88, 88), x88);
+            element x220 = mul(sqr(x176, 44), x44);
+            element x223 = mul(sqr(x220, 3), x3);
+
+            element t = mul(sqr(x223, 23), x22);
+            t = mul(sqr(t, 5), a);
+            t = mul(sqr(t, 3), x2);
+            return mul(sqr(t, 2), a);
+        }
+
+        // whether lane i of a normalized element is 0 mod p, which
+        // is when it is a multiple of p below 2^260.
+        static bool zero(const uint64_t* e, uint32_t i) {
+            constexpr uint64_t p[limbs] = {0xffffefffffc2f, mask, mask, mask, 0xffffffffffff};
+            for (uint64_t k = 0; k <= 16; k++) {
+                // k p in limbs, compared limb by limb.
+                uint64_t carry = 0;
+                bool equal = true;
+                for (uint32_t j = 0; j < limbs; j++) {
+                    unsigned __int128 x = (unsigned __int128)(p[j]) * k + carry;
+                    if ((uint64_t(x) & mask) != e[j * lanes + i]) equal = false;
+                    carry = uint64_t(x >> 52);
+                }
+                if (equal && carry == 0) return true;
+            }
+            return false;
+        }
+
+        static void mul(const uint64_t* a, const uint64_t* b, uint64_t* out) {
+            store(out, mul(load(a), load(b)));
+        }
+
+        static void sub(const uint64_t* a, const uint64_t* b, uint64_t* out) {
+            store(out, sub(load(a), load(b)));
+        }
+
+        static void inv(const uint64_t* a, uint64_t* out) {
+            store(out, inv(load(a)));
+        }
+
+        static bool add(uint64_t* x, uint64_t* y, uint32_t m, const uint64_t* qx, const uint64_t* qy, uint64_t* scratch) {
+            const element Qx = load(qx);
+            const element Qy = load(qy);
+
+            // running products of the differences in x.
+            element product = sub(Qx, load(x));
+            store(scratch, product);
+            for (uint32_t k = 1; k < m; k++) {
+                product = mul(product, sub(Qx, load(x + k * stride)));
+                store(scratch + k * stride, product);
+            }
+
+            // if any difference is zero, so is the product in its lane.
+            for (uint32_t i = 0; i < lanes; i++) if (zero(scratch + (m - 1) * stride, i)) return false;
+
+            element inverse = inv(product);
+            for (uint32_t k = m; k-- > 0;) {
+                const element X = load(x + k * stride);
+                const element Y = load(y + k * stride);
+
+                // the inverse of this difference alone.
+                element d = inverse;
+                if (k > 0) {
+                    d = mul(inverse, load(scratch + (k - 1) * stride));
+                    inverse = mul(inverse, sub(Qx, X));
+                }
+
+                const element lambda = mul(sub(Qy, Y), d);
+                const element X3 = sub(sub(sqr(lambda), X), Qx);
+                store(y + k * stride, sub(mul(lambda, sub(X, X3)), Y));
+                store(x + k * stride, X3);
+            }
+
+            return true;
+        }
+
+        static kernels make() {
+            return kernels{&arithmetic::mul, &arithmetic::sub, &arithmetic::inv, &arithmetic::add};
+        }
+    };
+
+}
+
+#endif
@@ -36,6 +36,11 @@ namespace cosmos {
             void operator()(string& t, stringstream& ss) const;
         };
         
+        // a string as text is itself. 
+        inline void write<text, string>::operator()(const string& t, stringstream& ss) const {
+            ss << t;
+        }
+        
         template <> struct write<hex, bytes> {
             void operator()(const bytes& t, stringstream& ss) const;
         };
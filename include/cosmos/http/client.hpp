@@ -0,0 +1,145 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_HTTP_CLIENT
+#define COSMOS_HTTP_CLIENT
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <cosmos/cosmos.hpp>
+
+namespace cosmos::http {
+
+    class error : public std::exception {
+        std::string Message;
+
+    public:
+        error(std::string s) : Message{s} {}
+
+        const char* what() const noexcept final override {
+            return Message.c_str();
+        }
+    };
+
+    struct url {
+        std::string Host;
+        uint16_t Port;
+        std::string Path;
+
+        // only plain http is supported since we talk to a local indexer.
+        static url read(const std::string&);
+
+        std::string origin() const {
+            return Host + ":" + std::to_string(Port);
+        }
+    };
+
+    struct response {
+        int Status;
+
+        // names are in lower case.
+        std::map<std::string, std::string> Headers;
+        std::string Body;
+
+        // whether the body came from the disk cache.
+        bool Cached;
+
+        // set if the request could not be made.
+        std::string Error;
+
+        bool valid() const {
+            return Error.empty() && Status >= 200 && Status < 300;
+        }
+
+        std::string header(const std::string& name) const {
+            auto i = Headers.find(name);
+            return i == Headers.end() ? std::string{} : i->second;
+        }
+    };
+
+    // on-disk cache of responses. Entries marked immutable are served
+    // without asking the server again; entries with an ETag are
+    // revalidated with If-None-Match.
+    class cache {
+        file::path Directory;
+
+    public:
+        struct entry {
+            std::string ETag;
+            bool Immutable;
+            std::string Body;
+        };
+
+        cache(file::path d) : Directory{d} {}
+
+        bool enabled() const {
+            return !Directory.empty();
+        }
+
+        bool get(const std::string& url, entry&) const;
+        void put(const std::string& url, const entry&) const;
+    };
+
+    struct options {
+        // open connections to any one host.
+        uint32 Connections = 4;
+
+        // connections in use at once over all hosts, which are
+        // no more than the global workers can run at once.
+        uint32 Concurrency = 16;
+
+        // requests sent on a connection before the first response is read.
+        uint32 Pipeline = 8;
+
+        std::chrono::milliseconds Timeout{10000};
+
+        // no disk cache if empty.
+        file::path Cache{};
+
+        // paths beginning with one of these never change, such as
+        // raw transactions by txid, and are cached forever even if
+        // the server does not say so.
+        vector<std::string> Immutable{};
+    };
+
+    class connection;
+
+    // HTTP/1.1 client which keeps connections open
+    // between requests and pipelines them.
+    class client {
+        options Options;
+        http::cache Cache;
+
+        struct host {
+            vector<std::unique_ptr<connection>> Idle;
+            uint32 Open = 0;
+        };
+
+        std::map<std::string, host> Hosts;
+        std::mutex Mutex;
+        std::condition_variable Released;
+
+        std::unique_ptr<connection> acquire(const url&);
+        void release(const url&, std::unique_ptr<connection>);
+
+        bool immutable(const url&) const;
+
+        // send a batch of GETs to one host, in order.
+        void pipeline(const url& host, const vector<std::pair<size_t, url>>&, const vector<std::string>&, vector<response>&);
+
+    public:
+        client(options o);
+        ~client();
+
+        response get(const std::string& url);
+
+        // responses are returned in the same order as the urls.
+        vector<response> get(const vector<std::string>& urls);
+    };
+
+}
+
+#endif
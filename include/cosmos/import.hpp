@@ -0,0 +1,55 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_IMPORT
+#define COSMOS_IMPORT
+
+#include "keyring.hpp"
+
+namespace cosmos::bitcoin {
+
+    // Lists of keys, one on each line, as WIF, 64 hex digits of
+    // secret or a hex pubkey, compressed or not. Blank lines and
+    // lines starting with # are skipped. Lines are parsed and checked
+    // in parallel batches, so that the slow part, which is the curve
+    // arithmetic, is spread over every core.
+    namespace import {
+
+        // a line that could not be imported. Lines count from 1.
+        struct error {
+            uint32 Line;
+            std::string Message;
+        };
+
+        // Keys from a list. Secrets, which we can spend from, each
+        // in the form it was given in, and pubkeys without secrets,
+        // which we can watch but not spend from.
+        struct watched {
+            vector<ptr<const keyring::entry>> Secrets;
+            vector<keys::pubkey_bytes> Pubkeys;
+            vector<keys::hash160> Addresses;
+        };
+
+        struct report {
+            uint32 Secrets;
+            uint32 Pubkeys;
+
+            // in order of line.
+            vector<error> Errors;
+        };
+
+        // whether a compressed pubkey is a point on the curve, which
+        // is whether x^3 + 7 has a square root. This is checked with
+        // the Jacobi symbol, so the root is never computed.
+        bool valid(const keys::pubkey_bytes&);
+
+        // Keys are added to the end of watched in the order they
+        // appear. Secrets already in the keyring are not made again.
+        report keys(const std::string& text, const keyring&, watched&);
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_KEYRING
+#define COSMOS_KEYRING
+
+#include "utxo.hpp"
+
+namespace cosmos::bitcoin {
+
+    // Secret keys by the address they redeem. The pubkey and address
+    // are computed once when a key is made into an entry, so finding
+    // the key for an output is a hash lookup with no curve arithmetic.
+    //
+    // A keyring is persistent, like the workspace that holds it. Adding
+    // a key makes a new ring which shares everything but the path to
+    // the key with the old one, so every version of a workspace has
+    // the keys that were added to it and no others.
+    class keyring {
+    public:
+        // Pubkey is always the compressed point. Address is the
+        // address of the pubkey in the form the key was given in.
+        struct entry {
+            secret Secret;
+            keys::pubkey_bytes Pubkey;
+            keys::hash160 Address;
+            bool Compressed;
+        };
+
+        // the pubkey and address of a key, which is the slow part
+        // of adding it, and which may be done on any thread.
+        static ptr<const entry> make(const secret&, bool compressed = true);
+
+    private:
+        // a hash trie over the bytes of a key.
+        template <size_t size>
+        struct node;
+
+        ptr<const node<20>> ByAddress;
+
+        // by the secret read backwards, since mined keys often
+        // share their high bytes, and then whether it is compressed.
+        ptr<const node<33>> BySecret;
+
+        size_t Size;
+
+    public:
+        keyring() : ByAddress{}, BySecret{}, Size{0} {}
+
+        // this ring if the key is already here.
+        keyring add(const secret&, bool compressed = true) const;
+        keyring add(ptr<const entry>) const;
+
+        // nullptr if the key is not here in this form.
+        ptr<const entry> find(const secret&, bool compressed = true) const;
+
+        // nullptr if we have no key for the address.
+        ptr<const entry> find(const keys::hash160&) const;
+
+        ptr<const entry> find(const address& a) const {
+            return find(keys::write(a));
+        }
+
+        size_t size() const {
+            return Size;
+        }
+
+        // memory used by the nodes of this ring, including
+        // those which it shares with other versions.
+        size_t memory() const;
+    };
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_KEYS
+#define COSMOS_KEYS
+
+#include <array>
+#include <algorithm>
+#include "cosmos.hpp"
+
+namespace cosmos::bitcoin {
+
+    // raw byte forms of keys and addresses. Everything
+    // in Cosmos that needs to look inside a key goes
+    // through here rather than touching the library types.
+    namespace keys {
+
+        using secret_bytes = std::array<byte, 32>;
+        using pubkey_bytes = std::array<byte, 33>;
+        using hash160 = std::array<byte, 20>;
+
+        // big-endian scalar.
+        inline secret_bytes write(const secret& s) {
+            secret_bytes b{};
+            std::copy(s.Secret.Value.begin(), s.Secret.Value.end(), b.begin());
+            return b;
+        }
+
+        // compressed point.
+        inline pubkey_bytes write(const pubkey& p) {
+            pubkey_bytes b{};
+            std::copy(p.Pubkey.Value.begin(), p.Pubkey.Value.end(), b.begin());
+            return b;
+        }
+
+        inline hash160 write(const address& a) {
+            hash160 b{};
+            std::copy(a.Digest.begin(), a.Digest.end(), b.begin());
+            return b;
+        }
+
+        inline secret read_secret(const secret_bytes& b) {
+            secret s{};
+            std::copy(b.begin(), b.end(), s.Secret.Value.begin());
+            return s;
+        }
+
+        inline pubkey read_pubkey(const pubkey_bytes& b) {
+            pubkey p{};
+            std::copy(b.begin(), b.end(), p.Pubkey.Value.begin());
+            return p;
+        }
+
+        inline address read_address(const hash160& b) {
+            address a{};
+            std::copy(b.begin(), b.end(), a.Digest.begin());
+            return a;
+        }
+
+        // -P has the same x coordinate and the opposite parity.
+        inline pubkey_bytes negate(pubkey_bytes b) {
+            b[0] ^= 1;
+            return b;
+        }
+
+        // the generator point.
+        inline pubkey generator() {
+            secret_bytes one{};
+            one[31] = 1;
+            return read_secret(one).to_public();
+        }
+
+    }
+
+}
+
+#endif
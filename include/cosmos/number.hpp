@@ -0,0 +1,199 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_NUMBER
+#define COSMOS_NUMBER
+
+#include <gmp.h>
+#include "format.hpp"
+
+namespace cosmos {
+
+    // natural numbers as they appear in the interpreter. Values
+    // that fit in 64 bits are stored inline and anything larger
+    // is moved into a GMP integer. Results are always shrunk back
+    // to the inline form when they fit, so two equal numbers
+    // always have the same representation.
+    class number {
+        bool Big;
+        int64_t Small;
+        mpz_t Large;
+
+        // takes ownership of an initialized mpz_t.
+        static number make(mpz_t);
+
+        // Give up our own mpz_t to the result, which
+        // is shrunk back to the inline form if it fits.
+        number release() {
+            Big = false;
+            return make(Large);
+        }
+
+        // Set an initialized z to a + b, a - b or a * b without copying
+        // either operand into an mpz_t of its own. z may be the Large
+        // of either operand.
+        static void add(mpz_ptr z, const number& a, const number& b);
+        static void subtract(mpz_ptr z, const number& a, const number& b);
+        static void multiply(mpz_ptr z, const number& a, const number& b);
+
+        void clear() {
+            if (Big) mpz_clear(Large);
+            Big = false;
+        }
+
+    public:
+        number() : Big{false}, Small{0} {}
+        number(int64_t n) : Big{false}, Small{n} {}
+
+        // read a decimal string.
+        explicit number(const std::string&);
+
+        number(const number& n) : Big{n.Big}, Small{n.Small} {
+            if (Big) mpz_init_set(Large, n.Large);
+        }
+
+        number(number&& n) noexcept : Big{n.Big}, Small{n.Small} {
+            if (Big) {
+                *Large = *n.Large;
+                n.Big = false;
+            }
+        }
+
+        number& operator=(const number& n) {
+            if (this == &n) return *this;
+            if (n.Big) {
+                if (Big) mpz_set(Large, n.Large);
+                else mpz_init_set(Large, n.Large);
+            } else clear();
+            Big = n.Big;
+            Small = n.Small;
+            return *this;
+        }
+
+        number& operator=(number&& n) noexcept {
+            if (this == &n) return *this;
+            clear();
+            Big = n.Big;
+            Small = n.Small;
+            if (Big) {
+                *Large = *n.Large;
+                n.Big = false;
+            }
+            return *this;
+        }
+
+        ~number() {
+            clear();
+        }
+
+        bool small() const {
+            return !Big;
+        }
+
+        bool valid() const {
+            return true;
+        }
+
+        number operator+(const number&) const&;
+        number operator-(const number&) const&;
+        number operator*(const number&) const&;
+
+        // a result which does not fit inline is kept in our own
+        // mpz_t when we are about to go away anyway.
+        number operator+(const number&) &&;
+        number operator-(const number&) &&;
+        number operator*(const number&) &&;
+
+        bool operator==(const number&) const;
+        bool operator<(const number&) const;
+
+        bool operator!=(const number& n) const {
+            return !(*this == n);
+        }
+
+        bool operator>(const number& n) const {
+            return n < *this;
+        }
+
+        bool operator<=(const number& n) const {
+            return !(n < *this);
+        }
+
+        bool operator>=(const number& n) const {
+            return !(*this < n);
+        }
+
+        std::string write() const;
+    };
+
+    inline number number::operator+(const number& n) const& {
+        int64_t r;
+        if (!Big && !n.Big && !__builtin_add_overflow(Small, n.Small, &r)) return number{r};
+        mpz_t z;
+        mpz_init(z);
+        add(z, *this, n);
+        return make(z);
+    }
+
+    inline number number::operator+(const number& n) && {
+        if (!Big) return static_cast<const number&>(*this) + n;
+        add(Large, *this, n);
+        return release();
+    }
+
+    inline number number::operator-(const number& n) const& {
+        int64_t r;
+        if (!Big && !n.Big && !__builtin_sub_overflow(Small, n.Small, &r)) return number{r};
+        mpz_t z;
+        mpz_init(z);
+        subtract(z, *this, n);
+        return make(z);
+    }
+
+    inline number number::operator-(const number& n) && {
+        if (!Big) return static_cast<const number&>(*this) - n;
+        subtract(Large, *this, n);
+        return release();
+    }
+
+    inline number number::operator*(const number& n) const& {
+        int64_t r;
+        if (!Big && !n.Big && !__builtin_mul_overflow(Small, n.Small, &r)) return number{r};
+        mpz_t z;
+        mpz_init(z);
+        multiply(z, *this, n);
+        return make(z);
+    }
+
+    inline number number::operator*(const number& n) && {
+        if (!Big) return static_cast<const number&>(*this) * n;
+        multiply(Large, *this, n);
+        return release();
+    }
+
+    inline bool number::operator==(const number& n) const {
+        // normalization means a small and a big number are never equal.
+        if (Big != n.Big) return false;
+        if (!Big) return Small == n.Small;
+        return mpz_cmp(Large, n.Large) == 0;
+    }
+
+    inline bool number::operator<(const number& n) const {
+        if (!Big && !n.Big) return Small < n.Small;
+        if (Big && n.Big) return mpz_cmp(Large, n.Large) < 0;
+        if (Big) return mpz_sgn(Large) < 0;
+        return mpz_sgn(n.Large) > 0;
+    }
+
+    namespace format {
+        template <> struct write<text, number> {
+            void operator()(const number& n, stringstream& ss) const {
+                ss << n.write();
+            }
+        };
+    }
+
+}
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef COSMOS_PARSER
 #define COSMOS_PARSER
 
-#include "cosmos.hpp"
+#include "expression.hpp"
+#include "name.hpp"
+#include "number.hpp"
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/qi_lexeme.hpp>
 
@@ -21,6 +23,24 @@ namespace cosmos {
         const auto times = qi::lexeme["*"];
         const auto concat = qi::lexeme["<>"];
         
+        class error : public std::exception {
+            std::string Message;
+            
+        public:
+            error(std::string);
+            
+            const char* what() const noexcept final override;
+        };
+        
+        // Read one statement, up to a separator or the end of the input. 
+        // Operators are read with times before plus before concat, and 
+        // set, which takes a name on the left, last. Throws error if the 
+        // statement cannot be read. 
+        ptr<expression> statement(stringstream&);
+        
+        // statements separated by separators, up to the end of the input. 
+        expression::parameters program(stringstream&);
+        
     };
     
 }
@@ -0,0 +1,142 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_PRECOMPUTE
+#define COSMOS_PRECOMPUTE
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "keys.hpp"
+#include "topology.hpp"
+
+namespace cosmos::bitcoin {
+
+    // precomputed multiples of points so that scalar
+    // multiplication becomes a short sequence of additions.
+    //
+    // None of this is constant time: zero digits are skipped and
+    // tables are indexed by the scalar, so timing and cache access
+    // reveal it. Use it for public scalars only, such as in
+    // verification and public derivation. Private keys and nonces
+    // go through the library.
+    namespace precompute {
+
+        // comb table for the generator point. Entry (i, j)
+        // is j * 256^i * G, so a secret is converted to a
+        // pubkey with one addition for each nonzero byte.
+        class generator {
+            const byte* Table;
+            std::vector<byte> Owned;
+            void* Mapped;
+            size_t MappedSize;
+
+            // a copy, made by the thread that will use it.
+            topology::region Copy;
+
+            generator();
+            generator(const generator&, bool huge);
+
+        public:
+            constexpr static uint32 windows = 32;
+            constexpr static uint32 width = 255;
+            constexpr static size_t size = size_t{windows} * width * 33;
+
+            // A cache file begins with a magic number and the SHA-256
+            // of the table, which is checked whenever it is mapped.
+            constexpr static size_t header = 8 + 32;
+
+            // Set a file in which to keep the table between runs.
+            // Must be called before the table is first used.
+            static void cache(file::path);
+
+            // write a table to a cache file.
+            static void save(const file::path&, const byte* table);
+
+            // whether the bytes of a cache file hold an undamaged table.
+            static bool check(const byte* file, size_t size);
+
+            // The table is built (or mapped) on first use.
+            static const generator& get();
+
+            // Use a copy of the table on this NUMA node for this thread
+            // from now on, in huge pages if there are any. The copy
+            // for each node is made by the first thread to ask for it,
+            // which should already be pinned to a CPU on that node.
+            static const generator& place(uint32 node);
+
+            // the table this thread uses.
+            static const generator& local();
+
+            // what a copy is kept in, or none for the shared table.
+            topology::region::backing backed() const {
+                return Copy.backed();
+            }
+
+            const byte* table() const {
+                return Table;
+            }
+
+            keys::pubkey_bytes entry(uint32 window, byte j) const;
+
+            pubkey to_public(const secret&) const;
+
+            ~generator();
+
+            generator(const generator&) = delete;
+            generator& operator=(const generator&) = delete;
+        };
+
+        // odd multiples P, 3P, ... 15P of a single base,
+        // used to multiply with width-5 non-adjacent form.
+        struct table {
+            constexpr static uint32 window = 5;
+            constexpr static uint32 size = 1 << (window - 2);
+
+            std::array<keys::pubkey_bytes, size> Odd;
+
+            table(const pubkey&);
+
+            pubkey times(const secret&) const;
+        };
+
+        // least-recently-used collection of tables for
+        // pubkeys that are multiplied repeatedly.
+        class bases {
+            struct hash {
+                size_t operator()(const keys::pubkey_bytes& p) const {
+                    size_t h = 0;
+                    for (int i = 1; i < 9; i++) h = (h << 8) | p[i];
+                    return h;
+                }
+            };
+
+            using entry = std::pair<keys::pubkey_bytes, ptr<const table>>;
+
+            size_t Capacity;
+            std::list<entry> Recent;
+            std::unordered_map<keys::pubkey_bytes, std::list<entry>::iterator, hash> Index;
+            std::mutex Mutex;
+
+        public:
+            bases(size_t capacity) : Capacity{capacity}, Recent{}, Index{}, Mutex{} {}
+
+            ptr<const table> get(const pubkey&);
+
+            static bases& global();
+        };
+
+        inline pubkey to_public(const secret& s) {
+            return generator::local().to_public(s);
+        }
+
+        inline pubkey times(const pubkey& p, const secret& s) {
+            return bases::global().get(p)->times(s);
+        }
+
+    }
+
+}
+
+#endif
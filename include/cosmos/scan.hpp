@@ -0,0 +1,149 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_SCAN
+#define COSMOS_SCAN
+
+#include "utxo.hpp"
+#include "wire.hpp"
+
+namespace cosmos::bitcoin {
+
+    // rebuilds a wallet from the blk*.dat files written by a node.
+    namespace scan {
+
+        // the pay-to-address pattern recognized by
+        // abstractions::script::pay_to_address:
+        // OP_DUP OP_HASH160 <20 bytes> OP_EQUALVERIFY OP_CHECKSIG
+        inline bool pay_to_address(wire::slice script, keys::hash160& a) {
+            if (script.size() != 25) return false;
+            const byte* s = script.Begin;
+            if (s[0] != 0x76 || s[1] != 0xa9 || s[2] != 0x14 || s[23] != 0x88 || s[24] != 0xac) return false;
+            std::copy(s + 3, s + 23, a.begin());
+            return true;
+        }
+
+        // bloom filter over hash160s. Since these are already uniform,
+        // the probe positions are taken directly from their bytes.
+        class filter {
+            std::vector<uint64_t> Bits;
+            uint64_t Mask;
+
+            constexpr static uint32 probes = 4;
+
+            static uint32 word(const keys::hash160& a, uint32 i) {
+                return uint32(a[4 * i]) | (uint32(a[4 * i + 1]) << 8) | (uint32(a[4 * i + 2]) << 16) | (uint32(a[4 * i + 3]) << 24);
+            }
+
+        public:
+            filter(const vector<keys::hash160>&);
+
+            bool maybe(const keys::hash160& a) const {
+                for (uint32 i = 0; i < probes; i++) {
+                    uint64_t b = word(a, i) & Mask;
+                    if ((Bits[b >> 6] & (uint64_t{1} << (b & 63))) == 0) return false;
+                }
+
+                return true;
+            }
+        };
+
+        struct statistics {
+            uint64_t Bytes;
+            uint64_t Files;
+            uint64_t Blocks;
+            uint64_t Transactions;
+            uint64_t Outputs;
+
+            // outputs that passed the filter.
+            uint64_t Candidates;
+
+            uint64_t Matches;
+
+            // matches which were spent by a later transaction.
+            uint64_t Spent;
+
+            // blocks that could not be parsed and were skipped.
+            uint64_t Invalid;
+
+            // blocks that are not on the best chain, which were skipped.
+            uint64_t Stale;
+
+            double Seconds;
+
+            double rate() const {
+                return Seconds == 0 ? 0 : double(Bytes) / Seconds / 1e9;
+            }
+
+            statistics& operator+=(const statistics&);
+        };
+
+        struct result {
+            // outputs that are still unspent.
+            vector<utxo::entry> Outputs;
+
+            // outpoints of matches that were found to be spent.
+            vector<utxo::outpoint> Spent;
+
+            // every address that was paid, including those whose
+            // outputs have all been spent, for restoring a keysource.
+            std::unordered_set<keys::hash160, utxo::hash> Used;
+
+            statistics Statistics;
+
+            // add everything found to a wallet.
+            void add_to(utxo::index& x) const {
+                x.update({}, Outputs);
+            }
+        };
+
+        using digest = std::array<byte, 32>;
+
+        // what the scan needs of a block header.
+        struct header {
+            digest Hash;
+            digest Previous;
+
+            // the target in compact form.
+            uint32 Bits;
+
+            // where the block begins in its file.
+            uint64_t Offset;
+        };
+
+        // the headers of the blocks in a block file.
+        vector<header> headers(wire::slice);
+
+        // A node keeps the blocks of branches that lost and may write
+        // a block more than once. The best chain is found by linking
+        // each header to its parent and taking the tip with the most
+        // work. This gives where its blocks are for each file, in order.
+        vector<vector<uint64_t>> best_chain(const vector<vector<header>>&);
+
+        // all block files in a node's blocks directory, in order.
+        vector<file::path> block_files(const file::path& blocks);
+
+        // Scan files for outputs paying to the given addresses,
+        // spreading the files over the given number of threads
+        // (0 means one for each core). The headers are read first
+        // so that only blocks on the best chain are scanned. Since
+        // blocks are not stored in order, the files are read again
+        // for inputs that spend what was found, which are removed.
+        result run(const vector<file::path>&, const vector<keys::hash160>& addresses, uint32 threads = 0);
+
+        // Scan the bytes of a single block file for outputs, in the blocks
+        // at the given offsets if there are any and otherwise in every block.
+        result block_file(wire::slice, const filter&, const std::unordered_set<keys::hash160, utxo::hash>&,
+            const vector<uint64_t>* blocks = nullptr);
+
+        // Scan the bytes of a single block file for inputs
+        // spending any of the given outpoints.
+        result block_file(wire::slice, const std::unordered_set<utxo::outpoint, utxo::hash>& spent,
+            const vector<uint64_t>* blocks = nullptr);
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_SECP256K1
+#define COSMOS_SECP256K1
+
+#include <cosmos/keys.hpp>
+#include <gmp.h>
+
+// The numbers of the curve and a wrapper for GMP, for the
+// arithmetic in Cosmos that the library does not do for us.
+namespace cosmos::bitcoin::secp256k1 {
+
+    // order of the group.
+    constexpr keys::secret_bytes order{{
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+        0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41}};
+
+    // the field prime.
+    constexpr keys::secret_bytes prime{{
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xff, 0xff, 0xfc, 0x2f}};
+
+    // an mpz_t that cleans up after itself.
+    struct integer {
+        mpz_t Value;
+
+        integer() {
+            mpz_init(Value);
+        }
+
+        integer(const byte* b, size_t n) {
+            mpz_init(Value);
+            read(b, n);
+        }
+
+        template <size_t n>
+        integer(const std::array<byte, n>& b) : integer{b.data(), n} {}
+
+        ~integer() {
+            mpz_clear(Value);
+        }
+
+        integer(const integer&) = delete;
+        integer& operator=(const integer&) = delete;
+
+        // n big-endian bytes.
+        void read(const byte* b, size_t n) {
+            mpz_import(Value, n, 1, 1, 1, 0, b);
+        }
+
+        // minimal big-endian encoding.
+        bytes write() const {
+            bytes b((mpz_sizeinbase(Value, 2) + 7) / 8);
+            size_t n = 0;
+            mpz_export(b.data(), &n, 1, 1, 1, 0, Value);
+            b.resize(n);
+            return b;
+        }
+
+        // false if it does not fit in n bytes.
+        template <size_t n>
+        bool write(std::array<byte, n>& b) const {
+            b.fill(0);
+            if (mpz_sgn(Value) == 0) return true;
+            const size_t size = (mpz_sizeinbase(Value, 2) + 7) / 8;
+            if (size > n) return false;
+            mpz_export(b.data() + n - size, nullptr, 1, 1, 1, 0, Value);
+            return true;
+        }
+
+        // must be less than 2^(8n).
+        template <size_t n>
+        std::array<byte, n> fixed() const {
+            std::array<byte, n> b{};
+            write(b);
+            return b;
+        }
+    };
+
+}
+
+#endif
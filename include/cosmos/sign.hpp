@@ -0,0 +1,93 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_SIGN
+#define COSMOS_SIGN
+
+#include "utxo.hpp"
+#include "wire.hpp"
+#include "crypto/sha256.hpp"
+
+namespace cosmos::bitcoin {
+
+    // signs every input of a transaction at once.
+    namespace sign {
+
+        // SIGHASH_ALL | SIGHASH_FORKID, which is the only type we use.
+        constexpr uint32 sighash_all = 0x41;
+
+        struct input {
+            utxo::outpoint Outpoint;
+            uint64_t Value;
+
+            // the script of the output being redeemed.
+            bytes Script;
+
+            uint32 Sequence;
+            secret Key;
+
+            // the pubkey of Key if it is already known,
+            // or zeros if it is to be computed.
+            keys::pubkey_bytes Pubkey;
+        };
+
+        struct output {
+            uint64_t Value;
+            bytes Script;
+        };
+
+        // a transaction whose inputs have not been signed yet.
+        struct transaction {
+            uint32 Version;
+            vector<input> Inputs;
+            vector<output> Outputs;
+            uint32 Locktime;
+
+            // serialize, with the given input scripts.
+            bytes write(const vector<bytes>& scripts) const;
+        };
+
+        // the parts of the signature hash preimage that are the same
+        // for every input, computed once per transaction. The first
+        // 64 bytes of every preimage are the same as well, so hashing
+        // of each input's preimage starts from a shared midstate.
+        struct preimage {
+            crypto::sha256::digest Prevouts;
+            crypto::sha256::digest Sequences;
+            crypto::sha256::digest Outputs;
+
+            // state after version, Prevouts and 28 bytes of Sequences.
+            crypto::sha256 Midstate;
+
+            const transaction& Transaction;
+
+            preimage(const transaction&);
+
+            // the message signed by input i.
+            crypto::sha256::digest digest(uint32 i) const;
+        };
+
+        // deterministic nonce according to RFC 6979 with SHA-256.
+        // Pass attempt > 0 to get the next candidate if one fails.
+        keys::secret_bytes nonce(const keys::secret_bytes& key, const crypto::sha256::digest& message, uint32 attempt = 0);
+
+        // DER-encoded low-S ECDSA signature.
+        bytes signature(const keys::secret_bytes& key, const crypto::sha256::digest& message);
+
+        // <signature + type> <pubkey>
+        bytes pay_to_address_script(const bytes& signature, const keys::pubkey_bytes&);
+
+        // Sign every input as a pay-to-address redemption, in parallel.
+        // Returns the input scripts, in order.
+        vector<bytes> batch(const transaction&);
+
+        inline bytes sign(const transaction& t) {
+            return t.write(batch(t));
+        }
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_TEMPLATES
+#define COSMOS_TEMPLATES
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include "cosmos.hpp"
+
+namespace cosmos::bitcoin {
+
+    // Scripts of the same shape differ only in a few bytes, so rather
+    // than building and compiling a script tree for every output we
+    // compile each shape once and then copy it and patch the field.
+    namespace templates {
+
+        // a compiled script with a hole for one field of fixed width.
+        class skeleton {
+            bytes Script;
+            size_t Offset;
+            size_t Width;
+
+        public:
+            skeleton() : Script{}, Offset{0}, Width{0} {}
+
+            // From two compiles of the same shape with field values x and y
+            // which differ in every byte. Invalid unless the compiles differ
+            // in exactly one run of bytes, which holds x and y.
+            static skeleton learn(const bytes& a, const byte* x, const bytes& b, const byte* y, size_t width);
+
+            bool valid() const {
+                return Width != 0;
+            }
+
+            size_t offset() const {
+                return Offset;
+            }
+
+            void fill(const byte* field, bytes& out) const {
+                out.assign(Script.begin(), Script.end());
+                std::copy(field, field + Width, out.begin() + Offset);
+            }
+
+            bytes fill(const byte* field) const {
+                bytes b{};
+                fill(field, b);
+                return b;
+            }
+        };
+
+        // Skeletons of one shape of script for the most recently used
+        // values of whatever else is in it, such as a target. If a shape
+        // cannot be made into a skeleton, because the encoding of the
+        // field depends on its value, every script is compiled instead.
+        template <typename fixed, size_t width>
+        class cache {
+        public:
+            using field = std::array<byte, width>;
+            using compiler = std::function<bytes(const fixed&, const field&)>;
+
+        private:
+            compiler Compile;
+            size_t Capacity;
+            std::list<std::pair<fixed, skeleton>> Recent;
+            std::mutex Mutex;
+
+            skeleton make(const fixed& k) const {
+                field x{};
+                field y{};
+                field z{};
+                x.fill(0x00);
+                y.fill(0xff);
+                for (size_t i = 0; i < width; i++) z[i] = byte(0x80 + 37 * i);
+
+                skeleton s = skeleton::learn(Compile(k, x), x.data(), Compile(k, y), y.data(), width);
+
+                // check with another value in case the shape depends on it.
+                if (s.valid() && s.fill(z.data()) != Compile(k, z)) return skeleton{};
+                return s;
+            }
+
+            skeleton get(const fixed& k) {
+                std::lock_guard<std::mutex> lock{Mutex};
+                for (auto i = Recent.begin(); i != Recent.end(); i++) if (i->first == k) {
+                    Recent.splice(Recent.begin(), Recent, i);
+                    return i->second;
+                }
+
+                Recent.emplace_front(k, make(k));
+                if (Recent.size() > Capacity) Recent.pop_back();
+                return Recent.front().second;
+            }
+
+        public:
+            cache(compiler c, size_t capacity = 16) : Compile{c}, Capacity{capacity}, Recent{}, Mutex{} {}
+
+            bytes operator()(const fixed& k, const field& f) {
+                skeleton s = get(k);
+                if (!s.valid()) return Compile(k, f);
+                return s.fill(f.data());
+            }
+
+            // whether scripts for k are patched rather than compiled.
+            bool patched(const fixed& k) {
+                return get(k).valid();
+            }
+        };
+
+    }
+
+}
+
+#endif
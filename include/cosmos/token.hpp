@@ -22,7 +22,7 @@ namespace cosmos {
         struct times;
         struct concat;
         
-        template <operand op> struct operand;
+        template <cosmos::op o> struct operand;
         
         template <> struct operand<cosmos::plus> {
             using token = plus;
@@ -36,6 +36,18 @@ namespace cosmos {
             using token = concat;
         };
         
+        template <> struct operand<cosmos::set> {
+            using token = set;
+        };
+        
+        // the words for functions and constructors. 
+        const char* word(function);
+        const char* word(constructor);
+        
+        // false if the word is not a function or a constructor. 
+        bool lookup(const std::string&, function&);
+        bool lookup(const std::string&, constructor&);
+        
         template <typename x> struct write {
             write() = delete;
             void operator()(stringstream& ss) const;
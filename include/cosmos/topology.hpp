@@ -0,0 +1,89 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_TOPOLOGY
+#define COSMOS_TOPOLOGY
+
+#include "cosmos.hpp"
+
+namespace cosmos {
+
+    // Where threads run and where their memory is, on Linux. Memory
+    // is placed by first touch, so memory made by a thread which has
+    // been pinned to a CPU is on that CPU's NUMA node.
+    namespace topology {
+
+        struct node {
+            uint32 Index;
+
+            // the CPUs of this node that this process may run on.
+            vector<uint32> Cpus;
+        };
+
+        // Nodes with at least one CPU we may use. Without NUMA
+        // information, one node with every CPU we may use.
+        vector<node> nodes();
+
+        // the node of a CPU, or 0 if it is not known.
+        uint32 node_of(uint32 cpu);
+
+        // Pin the calling thread to a CPU. False if it is not allowed.
+        bool pin(uint32 cpu);
+
+        // the CPU the calling thread is running on.
+        uint32 cpu();
+
+        // Memory from mmap, touched by the thread that makes it. With
+        // huge set, it is backed by 2 MB pages from hugetlbfs if there
+        // are any free, and otherwise advised to use transparent huge
+        // pages, and otherwise ordinary pages.
+        class region {
+        public:
+            enum backing {
+                none = 0,
+                normal = 1,
+                transparent = 2,
+                hugetlb = 3
+            };
+
+        private:
+            byte* Data;
+            size_t Size;
+            size_t Mapped;
+            backing Backing;
+
+        public:
+            region() : Data{nullptr}, Size{0}, Mapped{0}, Backing{none} {}
+            region(size_t size, bool huge);
+            ~region();
+
+            region(region&&);
+            region& operator=(region&&);
+
+            region(const region&) = delete;
+            region& operator=(const region&) = delete;
+
+            byte* data() const {
+                return Data;
+            }
+
+            size_t size() const {
+                return Size;
+            }
+
+            backing backed() const {
+                return Backing;
+            }
+        };
+
+        const char* name(region::backing);
+
+        // nodes, their CPUs and memory, and the huge pages available.
+        void write(ostream&);
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_TRANSACTION_VIEW
+#define COSMOS_TRANSACTION_VIEW
+
+#include <mutex>
+#include "utxo.hpp"
+#include "wire.hpp"
+
+namespace cosmos::bitcoin {
+
+    // a serialized transaction together with the offsets of its
+    // inputs and outputs, found in one pass when it is read. Nothing
+    // is copied out of the bytes until it is asked for, and the txid
+    // is only computed the first time it is needed. Copies share
+    // the bytes and the index.
+    class transaction_view {
+        struct entry {
+            uint32 Begin;
+            uint32 Script;
+            uint32 ScriptSize;
+        };
+
+        struct index {
+            bytes Data;
+            uint32 Version;
+            uint32 Locktime;
+
+            // segwit serialization has a marker and a witness,
+            // which are not part of the txid.
+            bool Witness;
+            uint32 Body;
+            uint32 BodyEnd;
+
+            vector<entry> Inputs;
+            vector<entry> Outputs;
+
+            std::once_flag Hashed;
+            std::array<byte, 32> Id;
+        };
+
+        ptr<index> Index;
+
+        transaction_view(ptr<index> x) : Index{x} {}
+
+    public:
+        struct input {
+            utxo::outpoint Outpoint;
+            wire::slice Script;
+            uint32 Sequence;
+        };
+
+        struct output {
+            uint64_t Value;
+            wire::slice Script;
+        };
+
+        transaction_view() : Index{nullptr} {}
+
+        // invalid if the bytes are not exactly one transaction.
+        static transaction_view read(bytes);
+
+        bool valid() const {
+            return Index != nullptr;
+        }
+
+        uint32 version() const {
+            return Index->Version;
+        }
+
+        uint32 locktime() const {
+            return Index->Locktime;
+        }
+
+        size_t inputs() const {
+            return Index->Inputs.size();
+        }
+
+        size_t outputs() const {
+            return Index->Outputs.size();
+        }
+
+        input get_input(size_t i) const;
+
+        output get_output(size_t j) const;
+
+        const std::array<byte, 32>& id() const;
+
+        // heap memory held by the bytes and the index, which
+        // is shared with every copy of this view.
+        size_t memory() const {
+            if (Index == nullptr) return 0;
+            return sizeof(index) + Index->Data.capacity() +
+                (Index->Inputs.capacity() + Index->Outputs.capacity()) * sizeof(entry);
+        }
+
+        wire::slice write() const {
+            const byte* b = Index->Data.data();
+            return wire::slice{b, b + Index->Data.size()};
+        }
+    };
+
+}
+
+#endif
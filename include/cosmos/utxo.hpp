@@ -0,0 +1,152 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_UTXO
+#define COSMOS_UTXO
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include "keys.hpp"
+
+namespace cosmos::bitcoin {
+
+    // the set of unspent outputs belonging to a wallet.
+    namespace utxo {
+
+        struct outpoint {
+            std::array<byte, 32> Txid;
+            index Index;
+
+            bool operator==(const outpoint& o) const {
+                return Index == o.Index && Txid == o.Txid;
+            }
+
+            bool operator!=(const outpoint& o) const {
+                return !(*this == o);
+            }
+
+            bool operator<(const outpoint& o) const {
+                return Txid < o.Txid || (Txid == o.Txid && Index < o.Index);
+            }
+        };
+
+        struct entry {
+            outpoint Outpoint;
+            uint64_t Value;
+            keys::hash160 Address;
+            bytes Script;
+        };
+
+        // txids and hash160s are already uniformly distributed.
+        struct hash {
+            size_t operator()(const outpoint& o) const {
+                size_t h = o.Index;
+                for (int i = 0; i < 8; i++) h = (h << 8) ^ o.Txid[i];
+                return h;
+            }
+
+            size_t operator()(const keys::hash160& a) const {
+                size_t h = 0;
+                for (int i = 0; i < 8; i++) h = (h << 8) | a[i];
+                return h;
+            }
+        };
+
+        // outputs by outpoint with secondary indices by value and by
+        // address. Each is a treap whose nodes never change once made,
+        // so an update copies only the nodes on the paths it touches
+        // and a copy of an index shares everything else with it. Every
+        // operation is O(log n), and so is making a changed copy.
+        class index {
+            template <typename key>
+            struct node;
+
+            ptr<const node<outpoint>> Outputs;
+            ptr<const node<std::pair<uint64_t, outpoint>>> ByValue;
+            ptr<const node<std::pair<keys::hash160, outpoint>>> ByAddress;
+            size_t Size;
+            uint64_t Total;
+
+        public:
+            index() : Outputs{}, ByValue{}, ByAddress{}, Size{0}, Total{0} {}
+
+            size_t size() const {
+                return Size;
+            }
+
+            uint64_t value() const {
+                return Total;
+            }
+
+            // approximate heap memory, counting every node
+            // as if it were not shared with another index.
+            size_t memory() const;
+
+            // nullptr if the output is not in the wallet.
+            const entry* find(const outpoint&) const;
+
+            vector<outpoint> find(const keys::hash160&) const;
+
+            // Outputs in order of value and then outpoint, starting at
+            // the least worth at least v, until f returns false.
+            void ascending(uint64_t v, std::function<bool(const entry&)> f) const;
+
+            // The same in reverse, starting at the greatest worth less
+            // than v, or at the greatest of all without v.
+            void descending(uint64_t v, std::function<bool(const entry&)> f) const;
+            void descending(std::function<bool(const entry&)> f) const;
+
+            bool insert(entry);
+            bool remove(const outpoint&);
+
+            // Incremental update as applied by the update function:
+            // outputs spent by a new transaction are removed and
+            // outputs it creates for the wallet are added.
+            void update(const vector<outpoint>& spent, const vector<entry>& created);
+        };
+
+        // parameters for choosing inputs. All amounts in satoshis.
+        struct request {
+            uint64_t Target;
+
+            // the fee for including one more input.
+            uint64_t InputCost;
+
+            // the cost of adding a change output and spending it later.
+            // A selection that overshoots by less than this needs no change.
+            uint64_t ChangeCost;
+
+            // the smallest change output worth creating.
+            uint64_t MinChange;
+        };
+
+        struct selection {
+            vector<outpoint> Inputs;
+
+            // the total value of the inputs.
+            uint64_t Value;
+
+            // total input cost.
+            uint64_t Fee;
+
+            bool Change;
+
+            bool valid() const {
+                return !Inputs.empty();
+            }
+        };
+
+        // Choose outputs to spend. Looks first for a selection with no
+        // change by branch and bound over the outputs no larger than
+        // the target, and otherwise takes the smallest single output
+        // that covers the target or failing that the largest outputs.
+        // An invalid selection means the wallet has too little.
+        selection select(const index&, const request&);
+
+    }
+
+}
+
+#endif
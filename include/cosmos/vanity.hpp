@@ -0,0 +1,107 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_VANITY
+#define COSMOS_VANITY
+
+#include "keys.hpp"
+
+namespace cosmos::bitcoin {
+
+    // Vanity prefixes for pay-to-address addresses. A prefix of the
+    // Base58Check encoding corresponds to a few ranges of hash160
+    // digests, so candidates can be tested by comparing digests and
+    // only need to be encoded when they fall inside a range.
+    namespace vanity {
+
+        class error : public std::exception {
+            std::string Message;
+
+        public:
+            error(std::string s) : Message{s} {}
+
+            const char* what() const noexcept final override {
+                return Message.c_str();
+            }
+        };
+
+        // inclusive range of digests.
+        struct interval {
+            keys::hash160 First;
+            keys::hash160 Last;
+
+            bool contains(const keys::hash160& h) const {
+                return First <= h && h <= Last;
+            }
+        };
+
+        // A single prefix such as "1Cosmos". The digests at either end of
+        // an interval only match for some checksums, so a digest inside
+        // an interval is a candidate which must be confirmed by matches().
+        struct prefix {
+            std::string Pattern;
+            bool CaseSensitive;
+
+            // sorted and disjoint.
+            vector<interval> Intervals;
+
+            // chance that a random key matches.
+            double Probability;
+
+            // expected number of keys to try.
+            double difficulty() const {
+                return 1 / Probability;
+            }
+
+            bool matches(const std::string& address) const;
+        };
+
+        // Throws if the pattern cannot be the start of a mainnet
+        // pay-to-address address. Case-insensitive patterns are
+        // expanded into every variant that uses valid characters.
+        prefix compile(const std::string& pattern, bool case_sensitive = true);
+
+        // Many prefixes at once, tested with a binary
+        // search over the union of their intervals.
+        class pattern {
+            vector<prefix> Prefixes;
+            vector<keys::hash160> First;
+            vector<keys::hash160> Last;
+            double Probability;
+
+        public:
+            pattern(vector<prefix>);
+
+            const vector<prefix>& prefixes() const {
+                return Prefixes;
+            }
+
+            size_t intervals() const {
+                return First.size();
+            }
+
+            // chance that a random key is a candidate.
+            double probability() const {
+                return Probability;
+            }
+
+            // whether the digest might match any prefix.
+            bool test(const keys::hash160& h) const {
+                auto i = std::upper_bound(First.begin(), First.end(), h);
+                if (i == First.begin()) return false;
+                return h <= Last[i - First.begin() - 1];
+            }
+
+            // indices of the prefixes that an encoded address matches.
+            vector<uint32> match(const std::string& address) const;
+
+            // difficulty of each prefix.
+            void write(ostream&) const;
+        };
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_VERIFY
+#define COSMOS_VERIFY
+
+#include "sign.hpp"
+#include "transaction_view.hpp"
+
+namespace cosmos::bitcoin {
+
+    // Checks redemptions of pay-to-address outputs without running the
+    // script machine. The locking script must be exactly
+    //     OP_DUP OP_HASH160 <20 bytes> OP_EQUALVERIFY OP_CHECKSIG
+    // and the unlocking script exactly two direct pushes, a strict DER
+    // low-S signature with SIGHASH_ALL | SIGHASH_FORKID and a compressed
+    // pubkey. Then the script succeeds if and only if the pubkey hashes
+    // to the address and the signature is valid, which is checked
+    // directly. Anything else is left to bitcoin::machine.
+    namespace verify {
+
+        enum result : byte {
+            reject = 0,
+            accept = 1,
+
+            // not a redemption of the form above; run the machine.
+            unknown = 2
+        };
+
+        // the output redeemed by an input.
+        struct previous {
+            uint64_t Value;
+            bytes Script;
+        };
+
+        // ECDSA verification of a strict DER signature. unknown if
+        // the encoding is not strict or S is high, since then what the
+        // machine does depends on its flags.
+        result signature(const keys::pubkey_bytes&, wire::slice der, const crypto::sha256::digest& message);
+
+        // the signature hash preimage is computed once for
+        // the whole transaction and shared by every input.
+        class transaction {
+            transaction_view View;
+            sign::transaction Unsigned;
+            sign::preimage Preimage;
+
+        public:
+            // previous outputs are given in the order of the inputs.
+            transaction(transaction_view, const vector<previous>&);
+
+            transaction(const transaction&) = delete;
+            transaction& operator=(const transaction&) = delete;
+
+            result input(uint32 n) const;
+        };
+
+    }
+
+}
+
+#endif
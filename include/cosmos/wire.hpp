@@ -0,0 +1,148 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COSMOS_WIRE
+#define COSMOS_WIRE
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace cosmos::wire {
+
+    using byte = uint8_t;
+
+    // a range of serialized bytes owned by someone else.
+    struct slice {
+        const byte* Begin;
+        const byte* End;
+
+        size_t size() const {
+            return End - Begin;
+        }
+
+        bool empty() const {
+            return Begin == End;
+        }
+
+        const byte& operator[](size_t i) const {
+            return Begin[i];
+        }
+    };
+
+    // reads Bitcoin's serialization format without copying. Once
+    // a read runs off the end every later read fails as well.
+    class reader {
+        const byte* Position;
+        const byte* End;
+        bool Valid;
+
+    public:
+        reader(const byte* b, const byte* e) : Position{b}, End{e}, Valid{b <= e} {}
+        reader(slice s) : reader{s.Begin, s.End} {}
+
+        bool valid() const {
+            return Valid;
+        }
+
+        const byte* position() const {
+            return Position;
+        }
+
+        size_t remaining() const {
+            return Valid ? End - Position : 0;
+        }
+
+        bool skip(size_t n) {
+            if (!Valid || size_t(End - Position) < n) return Valid = false;
+            Position += n;
+            return true;
+        }
+
+        slice take(size_t n) {
+            const byte* b = Position;
+            if (!skip(n)) return slice{End, End};
+            return slice{b, Position};
+        }
+
+        // peek at the next byte without consuming it.
+        int peek() const {
+            if (!Valid || Position == End) return -1;
+            return *Position;
+        }
+
+        // little-endian.
+        template <typename word>
+        word read() {
+            const byte* b = Position;
+            if (!skip(sizeof(word))) return 0;
+            word w = 0;
+            for (size_t i = 0; i < sizeof(word); i++) w |= word(b[i]) << (8 * i);
+            return w;
+        }
+
+        uint64_t varint() {
+            byte b = read<byte>();
+            switch (b) {
+                case 0xfd: return read<uint16_t>();
+                case 0xfe: return read<uint32_t>();
+                case 0xff: return read<uint64_t>();
+                default: return b;
+            }
+        }
+
+        // a script or other length-prefixed string.
+        slice var_bytes() {
+            uint64_t n = varint();
+            if (!Valid || n > remaining()) {
+                Valid = false;
+                return slice{End, End};
+            }
+
+            return take(n);
+        }
+    };
+
+    // appends Bitcoin's serialization format to a byte vector.
+    struct writer {
+        std::vector<byte>& Out;
+
+        template <typename word>
+        writer& write(word w) {
+            for (size_t i = 0; i < sizeof(word); i++) Out.push_back(byte(w >> (8 * i)));
+            return *this;
+        }
+
+        writer& varint(uint64_t n) {
+            if (n < 0xfd) return write<byte>(n);
+            if (n <= 0xffff) return write<byte>(0xfd).write<uint16_t>(n);
+            if (n <= 0xffffffff) return write<byte>(0xfe).write<uint32_t>(n);
+            return write<byte>(0xff).write<uint64_t>(n);
+        }
+
+        writer& append(const byte* b, size_t n) {
+            Out.insert(Out.end(), b, b + n);
+            return *this;
+        }
+
+        template <typename range>
+        writer& append(const range& r) {
+            Out.insert(Out.end(), r.begin(), r.end());
+            return *this;
+        }
+
+        template <typename range>
+        writer& var_bytes(const range& r) {
+            return varint(r.size()).append(r);
+        }
+    };
+
+    inline size_t varint_size(uint64_t n) {
+        return n < 0xfd ? 1 : n <= 0xffff ? 3 : n <= 0xffffffff ? 5 : 9;
+    }
+
+}
+
+#endif
@@ -7,6 +7,14 @@
 
 #include "expression.hpp"
 #include "name.hpp"
+#include "utxo.hpp"
+#include "transaction_view.hpp"
+#include "fees.hpp"
+#include "bip32.hpp"
+#include "keyring.hpp"
+#include "import.hpp"
+#include "base58.hpp"
+#include "accounting.hpp"
 
 namespace cosmos {
     
@@ -18,67 +26,303 @@ namespace cosmos {
         // workspace is an item. 
         struct item {
             virtual ptr<expression> express() const = 0;
+            
+            virtual accounting::kind kind() const {
+                return accounting::other;
+            }
+            
+            // memory used by this item, including what it owns. 
+            virtual size_t size() const = 0;
+            
+            // the keyring with any keys this item holds. 
+            virtual bitcoin::keyring index(const bitcoin::keyring& k) const {
+                return k;
+            }
         };
         
         // the workspace. 
-        struct space final : public item {
+        struct space final : public item, public accounting::counted<space, accounting::space> {
             bool Valid;
             map<name, ptr<item>> Contents;
             
+            // every key that has been set in this workspace 
+            // or in those it came from, by address. 
+            bitcoin::keyring Keys;
+            
             bool valid() const {
                 if (Valid == false) return false;
                 return Contents.valid();
             }
             
-            space(const space& s) : Valid{s.Valid}, Contents{s.Contents} {}
-            space() : Valid{true}, Contents{} {};
+            space(const space& s) : Valid{s.Valid}, Contents{s.Contents}, Keys{s.Keys} {}
+            space() : Valid{true}, Contents{}, Keys{} {};
             
             space& operator=(const space& s) {
+                Valid = s.Valid;
                 Contents = s.Contents; 
+                Keys = s.Keys;
                 return *this;
             }
             
+            // the item set under a name, or nothing. 
+            ptr<item> get(name) const;
+            
+            // the key that redeems an address, without any curve arithmetic. 
+            ptr<const bitcoin::keyring::entry> key(const bitcoin::address& a) const {
+                return Keys.find(a);
+            }
+            
+            // Import a list of keys. They are set under the name as one 
+            // watch item, if there are any, and the secrets go into the 
+            // keyring. Lines that could not be read are reported. 
+            space import(name, const std::string& text, bitcoin::import::report&) const;
+            
             ptr<expression> express() const override;
             
+            accounting::kind kind() const override {
+                return accounting::space;
+            }
+            
+            size_t size() const override {
+                return accounting::measure(*this).total();
+            }
+            
         private:
             space set(name, ptr<item>) const;
             
-            space(bool b) : Valid{b}, Contents{} {}
+            // this space with the keys the item holds. 
+            space index(ptr<item>) const;
+            
+            space(bool b) : Valid{b}, Contents{}, Keys{} {}
             
             friend struct operation;
         };
         
         template <typename X>
-        struct atom final : public item {
+        struct atom final : public item, public accounting::counted<atom<X>, accounting::atom> {
             X Atom;
             
             atom(X a) : Atom{a} {}
             
             ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::atom;
+            }
+            
+            size_t size() const override {
+                return sizeof(atom);
+            }
+            
+            bitcoin::keyring index(const bitcoin::keyring& k) const override {
+                if constexpr (std::is_same_v<X, bitcoin::secret>) return k.add(Atom);
+                else return k;
+            }
+        };
+        
+        template <typename X>
+        inline ptr<expression> atom<X>::express() const {
+            return std::make_shared<expression::atomic<X>>(Atom);
+        }
+        
+        struct output final : public bitcoin::output::representation, public item, public accounting::counted<output, accounting::output> {
+            ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::output;
+            }
+            
+            size_t size() const override {
+                return sizeof(output);
+            }
+        };
+        
+        struct outpoint final : public bitcoin::outpoint::representation, public item, public accounting::counted<outpoint, accounting::outpoint> {
+            ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::outpoint;
+            }
+            
+            size_t size() const override {
+                return sizeof(outpoint);
+            }
         };
         
-        struct output final : public bitcoin::output::representation, public item {
+        struct input final : public bitcoin::input, public item, public accounting::counted<input, accounting::input> {
             ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::input;
+            }
+            
+            size_t size() const override {
+                return sizeof(input);
+            }
         };
         
-        struct outpoint final : public bitcoin::outpoint::representation, public item {
+        // transactions are kept serialized and only
+        // the parts that are used are ever read. 
+        struct transaction final : public item, public accounting::counted<transaction, accounting::transaction> {
+            bitcoin::transaction_view View;
+            
+            transaction(bitcoin::transaction_view v) : View{v} {}
+            
+            bool valid() const {
+                return View.valid();
+            }
+            
             ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::transaction;
+            }
+            
+            size_t size() const override {
+                return sizeof(transaction) + View.memory();
+            }
         };
         
-        struct input final : public bitcoin::input, public item {
+        // outputs spent and created since a wallet was last
+        // updated, which is what is fetched for update. 
+        struct changes final : public item, public accounting::counted<changes, accounting::other> {
+            vector<bitcoin::utxo::outpoint> Spent;
+            vector<bitcoin::utxo::entry> Created;
+            
+            changes(vector<bitcoin::utxo::outpoint> s, vector<bitcoin::utxo::entry> c) : Spent{s}, Created{c} {}
+            
             ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::other;
+            }
+            
+            size_t size() const override {
+                size_t m = sizeof(changes) + Spent.capacity() * sizeof(bitcoin::utxo::outpoint) + 
+                    Created.capacity() * sizeof(bitcoin::utxo::entry);
+                for (const bitcoin::utxo::entry& e : Created) m += e.Script.capacity();
+                return m;
+            }
         };
         
-        struct transaction final : public bitcoin::transaction::representation, public item {
+        struct wallet final : public item, public accounting::counted<wallet, accounting::wallet> {
+            // unspent outputs belonging to this wallet, used by spend 
+            // to choose inputs. They never change once the wallet is 
+            // made, so every version of a workspace keeps its own. 
+            ptr<const bitcoin::utxo::index> Outputs;
+            
+            wallet() : Outputs{std::make_shared<const bitcoin::utxo::index>()} {}
+            wallet(ptr<const bitcoin::utxo::index> o) : Outputs{o} {}
+            
+            // a new wallet with the changes applied. The copy of the 
+            // outputs shares all but the changed paths with this one, 
+            // which is left as it was. 
+            ptr<wallet> update(const changes& c) const {
+                ptr<bitcoin::utxo::index> x = std::make_shared<bitcoin::utxo::index>(*Outputs);
+                x->update(c.Spent, c.Created);
+                return std::make_shared<wallet>(x);
+            }
+            
+            bitcoin::utxo::selection select(const bitcoin::utxo::request& r) const {
+                return bitcoin::utxo::select(*Outputs, r);
+            }
+            
+            // inputs to pay for these outputs with the fee, 
+            // which depends on how many inputs are chosen. 
+            bitcoin::utxo::selection select(const vector<bitcoin::sign::output>& o, const bitcoin::fees::fee& f) const {
+                return select(bitcoin::fees::request(o, f));
+            }
+            
             ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::wallet;
+            }
+            
+            size_t size() const override {
+                return sizeof(wallet) + Outputs->memory();
+            }
         };
         
-        struct wallet final : public item {
+        // an HD wallet. Children are derived as they are needed and 
+        // shared by every copy, since they never change. 
+        struct keysource final : public item, public accounting::counted<keysource, accounting::keysource> {
+            ptr<bitcoin::bip32::chain> Chain;
+            
+            // the next child to give out. 
+            uint32 Next;
+            
+            keysource() : Chain{nullptr}, Next{0} {}
+            keysource(ptr<bitcoin::bip32::chain> c, uint32 n) : Chain{c}, Next{n} {}
+            
+            bool valid() const {
+                return Chain != nullptr;
+            }
+            
+            // after the last address that was ever paid, with the usual gap limit. 
+            static keysource restore(const bitcoin::bip32::extended& x, 
+                const std::unordered_set<bitcoin::keys::hash160, bitcoin::utxo::hash>& used, uint32 gap = 20) {
+                ptr<bitcoin::bip32::chain> c = std::make_shared<bitcoin::bip32::chain>(x);
+                return keysource{c, c->scan(used, gap)};
+            }
+            
+            // the index of the address returned by next_address, 
+            // skipping children that do not exist. 
+            uint32 position() const {
+                uint32 n = Next;
+                while (!Chain->exists(n)) n++;
+                return n;
+            }
+            
+            bitcoin::address next_address() const {
+                return bitcoin::keys::read_address(Chain->address(position()));
+            }
+            
+            keysource next() const {
+                return keysource{Chain, position() + 1};
+            }
+            
             ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::keysource;
+            }
+            
+            size_t size() const override {
+                return sizeof(keysource) + (Chain == nullptr ? 0 : sizeof(bitcoin::bip32::chain) + Chain->memory());
+            }
         };
         
-        struct keysource final : public item {
+        // imported keys, which are shared by every copy, since 
+        // they never change. Secrets go into the keyring when 
+        // this is set, and pubkeys are only watched. 
+        struct watch final : public item, public accounting::counted<watch, accounting::watch> {
+            ptr<const bitcoin::import::watched> Watched;
+            
+            watch(ptr<const bitcoin::import::watched> w) : Watched{w} {}
+            
+            size_t count() const {
+                return Watched->Pubkeys.size();
+            }
+            
+            bitcoin::keyring index(const bitcoin::keyring& k) const override {
+                bitcoin::keyring x = k;
+                for (const ptr<const bitcoin::keyring::entry>& e : Watched->Secrets) x = x.add(e);
+                return x;
+            }
+            
             ptr<expression> express() const override;
+            
+            accounting::kind kind() const override {
+                return accounting::watch;
+            }
+            
+            size_t size() const override {
+                return sizeof(watch) + sizeof(bitcoin::import::watched) + 
+                    Watched->Secrets.capacity() * sizeof(ptr<const bitcoin::keyring::entry>) + 
+                    Watched->Pubkeys.capacity() * sizeof(bitcoin::keys::pubkey_bytes) + 
+                    Watched->Addresses.capacity() * sizeof(bitcoin::keys::hash160);
+            }
         };
         
     }
@@ -0,0 +1,399 @@
+#include "coordinator.hpp"
+#include <cosmos/secp256k1.hpp>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace cosmos::bitcoin::coordinator {
+
+    namespace {
+
+        // a socket which reads and writes json one line at a time.
+        class connection {
+            int Socket;
+            std::string Input;
+
+        public:
+            connection(int s) : Socket{s}, Input{} {}
+
+            ~connection() {
+                if (Socket >= 0) ::close(Socket);
+            }
+
+            connection(const connection&) = delete;
+            connection& operator=(const connection&) = delete;
+
+            bool send(const json& j) {
+                std::string x = j.dump() + "\n";
+                size_t sent = 0;
+                while (sent < x.size()) {
+                    ssize_t n = ::send(Socket, x.data() + sent, x.size() - sent, MSG_NOSIGNAL);
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n <= 0) return false;
+                    sent += n;
+                }
+                return true;
+            }
+
+            // read what has arrived. False if the other side has gone away.
+            bool read() {
+                char b[4096];
+                ssize_t n;
+                do n = ::recv(Socket, b, sizeof(b), 0);
+                while (n < 0 && errno == EINTR);
+                if (n <= 0) return false;
+                Input.append(b, n);
+                return true;
+            }
+
+            // the next complete line, if there is one.
+            bool next(json& j) {
+                size_t end = Input.find('\n');
+                if (end == std::string::npos) return false;
+                std::string line = Input.substr(0, end);
+                Input.erase(0, end + 1);
+                j = json::parse(line);
+                return true;
+            }
+
+            // null if the other side has gone away.
+            json receive() {
+                json j;
+                while (!next(j)) if (!read()) return nullptr;
+                return j;
+            }
+        };
+
+        struct endpoint {
+            int Family;
+            sockaddr_storage Address;
+            socklen_t Size;
+        };
+
+        endpoint resolve(const std::string& address) {
+            endpoint e{};
+            if (address.compare(0, 5, "unix:") == 0) {
+                sockaddr_un a{};
+                a.sun_family = AF_UNIX;
+                std::string path = address.substr(5);
+                if (path.size() >= sizeof(a.sun_path)) throw std::runtime_error{"socket path too long: " + path};
+                std::strncpy(a.sun_path, path.c_str(), sizeof(a.sun_path) - 1);
+                e.Family = AF_UNIX;
+                std::memcpy(&e.Address, &a, sizeof(a));
+                e.Size = sizeof(a);
+                return e;
+            }
+
+            size_t colon = address.rfind(':');
+            if (colon == std::string::npos) throw std::runtime_error{"expected unix:<path> or <host>:<port>"};
+            std::string host = address.substr(0, colon);
+            std::string port = address.substr(colon + 1);
+
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = AI_PASSIVE;
+            addrinfo* r = nullptr;
+            if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &r) != 0 || r == nullptr)
+                throw std::runtime_error{"cannot resolve " + address};
+
+            e.Family = r->ai_family;
+            std::memcpy(&e.Address, r->ai_addr, r->ai_addrlen);
+            e.Size = r->ai_addrlen;
+            ::freeaddrinfo(r);
+            return e;
+        }
+
+        int listen(const std::string& address) {
+            endpoint e = resolve(address);
+            if (e.Family == AF_UNIX) ::unlink(address.substr(5).c_str());
+
+            int s = ::socket(e.Family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int yes = 1;
+            if (e.Family != AF_UNIX) ::setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            if (s < 0 || ::bind(s, reinterpret_cast<sockaddr*>(&e.Address), e.Size) != 0 || ::listen(s, 128) != 0)
+                throw std::runtime_error{"cannot listen on " + address + ": " + std::strerror(errno)};
+            return s;
+        }
+
+        int connect(const std::string& address) {
+            endpoint e = resolve(address);
+            int s = ::socket(e.Family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (s < 0 || ::connect(s, reinterpret_cast<sockaddr*>(&e.Address), e.Size) != 0)
+                throw std::runtime_error{"cannot connect to " + address + ": " + std::strerror(errno)};
+            return s;
+        }
+
+        void save(const std::string& file, json j, const ledger& l, const best& b, uint32 keep) {
+            j["ledger"] = l.write();
+            j["max_size"] = keep;
+            j["keys"] = b.write();
+
+            std::string tmp = file + ".tmp";
+            {
+                std::ofstream o{tmp};
+                o << j.dump(1);
+                if (!o) throw std::runtime_error{"cannot write " + tmp};
+            }
+            std::rename(tmp.c_str(), file.c_str());
+        }
+
+    }
+
+    void serve(const options& o, ledger l, best b, json state) {
+        int listener = listen(o.Address);
+
+        // Workers are named by when they connected rather than by their
+        // sockets, since a socket may be reused by a later connection
+        // while leases are still held under the name of the old one.
+        struct worker {
+            ptr<connection> Connection;
+            std::string Name;
+        };
+
+        std::map<int, worker> workers{};
+        uint64_t connections = 0;
+
+        // The state is saved when a lease is granted, completed, expires
+        // or is dropped. Progress and candidates sent with heartbeats
+        // are saved along with the next of these.
+        bool changed = false;
+
+        // heartbeats are due three times per timeout.
+        const uint64_t heartbeat = std::max<uint64_t>(1, o.Timeout.count() / 3);
+
+        auto answer = [&](const std::string& worker, const json& m) -> json {
+            const std::string type = m.at("type").get<std::string>();
+            const clock::time_point now = clock::now();
+
+            if (type == "status")
+                return json{{"type", "status"}, {"done", l.done()}, {"active", l.active()}, {"keys", b.write()}};
+
+            for (const json& c : m.value("candidates", json::array())) b.add(candidate::read(c));
+
+            if (type == "lease") {
+                changed = true;
+                return json{{"type", "lease"}, {"lease", l.issue(worker, now).write()}, {"heartbeat", heartbeat}};
+            }
+
+            if (type == "heartbeat") {
+                bool ok = l.renew(m.at("id").get<uint64_t>(), worker, m.at("done").get<uint64_t>(), now);
+                return json{{"type", ok ? "ok" : "revoked"}};
+            }
+
+            if (type == "candidates") return json{{"type", "ok"}};
+
+            if (type == "done") {
+                bool ok = l.complete(m.at("id").get<uint64_t>(), worker);
+                changed |= ok;
+                return json{{"type", ok ? "ok" : "revoked"}};
+            }
+
+            return json{{"type", "error"}, {"message", "unknown request " + type}};
+        };
+
+        while (true) {
+            vector<pollfd> fds{{listener, POLLIN, 0}};
+            for (auto& w : workers) fds.push_back({w.first, POLLIN, 0});
+
+            if (::poll(fds.data(), fds.size(), 1000) < 0 && errno != EINTR)
+                throw std::runtime_error{std::string{"poll: "} + std::strerror(errno)};
+
+            if (fds[0].revents & POLLIN) {
+                int c = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+                if (c >= 0) workers[c] = worker{std::make_shared<connection>(c), std::to_string(++connections)};
+            }
+
+            for (size_t i = 1; i < fds.size(); i++) {
+                if (fds[i].revents == 0) continue;
+                int fd = fds[i].fd;
+                const worker w = workers[fd];
+                ptr<connection> c = w.Connection;
+
+                bool open = c->read();
+                try {
+                    json m;
+                    while (open && c->next(m)) {
+                        json reply;
+                        try {
+                            reply = answer(w.Name, m);
+                        } catch (const std::exception& e) {
+                            reply = json{{"type", "error"}, {"message", e.what()}};
+                        }
+
+                        open = c->send(reply);
+                    }
+                } catch (const json::exception&) {
+                    open = false;
+                }
+
+                if (!open) {
+                    changed |= l.drop(w.Name) > 0;
+                    workers.erase(fd);
+                }
+            }
+
+            if (l.expire(clock::now()) > 0) changed = true;
+
+            if (changed) {
+                save(o.State, state, l, b, o.Keep);
+                changed = false;
+            }
+        }
+    }
+
+    void work(const std::string& address, uint32 threads, uint32 keep, hasher h) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        connection c{connect(address)};
+
+        while (true) {
+            if (!c.send(json{{"type", "lease"}})) return;
+            json r = c.receive();
+            if (r.is_null() || r.value("type", "") != "lease") return;
+
+            const lease l = lease::read(r.at("lease"));
+            const auto interval = std::chrono::seconds{r.at("heartbeat").get<uint64_t>()};
+
+            // thread t does keys t, t + threads, ... and has
+            // done every one of them before Position[t].
+            std::atomic<bool> stop{false};
+            vector<std::atomic<uint64_t>> position(threads);
+            std::mutex mutex{};
+            best found{keep};
+            vector<candidate> fresh{};
+
+            auto mine = [&](uint32 t) {
+                best mine{keep};
+                vector<candidate> kept{};
+                const unsigned __int128 step = (unsigned __int128)(threads) * l.Stride;
+                keys::secret_bytes k = l.key(t);
+                uint64_t i = t;
+                while (i < l.Count && !stop) {
+                    candidate x{h(k), k};
+                    if (mine.add(x)) kept.push_back(x);
+
+                    i += threads;
+                    k = plus(k, step);
+
+                    if ((i / threads) % 4096 == 0 || i >= l.Count) {
+                        std::lock_guard<std::mutex> lock{mutex};
+                        for (const candidate& y : kept) if (found.add(y)) fresh.push_back(y);
+                        kept.clear();
+                        position[t] = std::min(i, l.Count);
+                    }
+                }
+            };
+
+            for (uint32 t = 0; t < threads; t++) position[t] = t;
+            vector<std::thread> miners{};
+            for (uint32 t = 0; t < threads; t++) miners.emplace_back(mine, t);
+
+            auto report = [&]() -> json {
+                std::lock_guard<std::mutex> lock{mutex};
+                uint64_t done = l.Count;
+                for (const auto& p : position) done = std::min<uint64_t>(done, p);
+                json candidates = json::array();
+                for (const candidate& x : fresh) candidates.push_back(x.write());
+                fresh.clear();
+                return json{{"id", l.Id}, {"done", done}, {"candidates", candidates}};
+            };
+
+            auto finished = [&]() -> bool {
+                std::lock_guard<std::mutex> lock{mutex};
+                for (const auto& p : position) if (p < l.Count) return false;
+                return true;
+            };
+
+            bool connected = true;
+            auto last = clock::now();
+            while (!finished() && !stop) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{50});
+                if (clock::now() - last < interval) continue;
+                last = clock::now();
+
+                json m = report();
+                m["type"] = "heartbeat";
+                json a;
+                if (!c.send(m) || (a = c.receive()).is_null()) connected = false;
+                if (!connected || a.value("type", "") != "ok") stop = true;
+            }
+
+            for (std::thread& t : miners) t.join();
+            if (!connected) return;
+
+            // a revoked lease is being mined by someone else, but
+            // the candidates found so far are still worth keeping.
+            json m = report();
+            m["type"] = stop ? "candidates" : "done";
+            if (!c.send(m) || c.receive().is_null()) return;
+        }
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    using namespace cosmos;
+    using namespace cosmos::bitcoin;
+
+    auto usage = []() -> int {
+        std::cout << "usage: coordinator serve <address> <state file> [stride] [lease size] [keep] [timeout seconds]\n"
+            << "       coordinator work <address> [threads] [keep]\n"
+            << "address is unix:<path> or <host>:<port>" << std::endl;
+        return 1;
+    };
+
+    if (argc < 3) return usage();
+    const std::string command = argv[1];
+    auto arg = [argc, argv](int i, uint64_t d) -> uint64_t {
+        return argc > i ? std::stoull(argv[i]) : d;
+    };
+
+    try {
+        if (command == "serve" && argc >= 4) {
+            coordinator::options o{argv[2], argv[3], uint32(arg(6, 100)), std::chrono::seconds{arg(7, 60)}};
+
+            // the state may be a miner's, whose keys are kept.
+            coordinator::json j = coordinator::json::object();
+            std::ifstream in{o.State};
+            if (in) in >> j;
+
+            coordinator::best b{o.Keep};
+            if (j.count("keys")) b.read(j["keys"]);
+
+            if (j.count("ledger")) {
+                coordinator::serve(o, coordinator::ledger::read(j["ledger"], o.Timeout), b, j);
+                return 0;
+            }
+
+            // a new keyspace starts at a random key.
+            keys::secret_bytes start{};
+            std::random_device r{};
+            do for (byte& x : start) x = byte(r());
+            while (start == keys::secret_bytes{} || !(start < secp256k1::order));
+
+            coordinator::serve(o, coordinator::ledger{start, uint32(arg(4, 1)), arg(5, 1 << 24), o.Timeout}, b, j);
+            return 0;
+        }
+
+        if (command == "work") {
+            coordinator::work(argv[2], uint32(arg(3, 0)), uint32(arg(4, 100)), [](const keys::secret_bytes& k) -> keys::hash160 {
+                return keys::write(keys::read_secret(k).to_public().address());
+            });
+            return 0;
+        }
+    } catch (std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    return usage();
+}
@@ -0,0 +1,150 @@
+#ifndef COSMOS_RELEASE_COORDINATOR
+#define COSMOS_RELEASE_COORDINATOR
+
+#include <cosmos/keys.hpp>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <set>
+
+// Address mining spread over several processes. A coordinator hands
+// out leases on ranges of the keyspace and workers mine them and send
+// back their best candidates. Workers report progress regularly and a
+// lease which is not renewed in time is taken back, and whatever part
+// of it was not reported as done is handed out again.
+namespace cosmos::bitcoin::coordinator {
+    using json = nlohmann::json;
+    using clock = std::chrono::steady_clock;
+
+    // b + n modulo the order of the group.
+    keys::secret_bytes plus(keys::secret_bytes b, unsigned __int128 n);
+
+    // keys Start, Start + Stride, ... Start + (Count - 1) * Stride.
+    struct lease {
+        uint64_t Id;
+        keys::secret_bytes Start;
+        uint32 Stride;
+        uint64_t Count;
+
+        keys::secret_bytes key(uint64_t i) const;
+
+        json write() const;
+        static lease read(const json&);
+    };
+
+    struct candidate {
+        keys::hash160 Digest;
+        keys::secret_bytes Key;
+
+        bool operator<(const candidate& c) const {
+            return Digest < c.Digest || (Digest == c.Digest && Key < c.Key);
+        }
+
+        json write() const;
+        static candidate read(const json&);
+    };
+
+    // the candidates with the smallest digests, which are the ones
+    // the miner keeps in its addresses, and written the way it saves
+    // them, so that the two can be read from the same state.
+    class best {
+        uint32 Size;
+        std::set<candidate> Set;
+
+    public:
+        best(uint32 size) : Size{size}, Set{} {}
+
+        // whether the candidate was kept.
+        bool add(const candidate&);
+
+        const std::set<candidate>& candidates() const {
+            return Set;
+        }
+
+        json write() const;
+        void read(const json&);
+    };
+
+    // the state of the keyspace, without any networking.
+    class ledger {
+        struct outstanding {
+            lease Lease;
+            std::string Worker;
+            uint64_t Done;
+            clock::time_point Expires;
+        };
+
+        keys::secret_bytes Next;
+        uint32 Stride;
+        uint64_t Count;
+        clock::duration Timeout;
+        uint64_t NextId;
+
+        std::map<uint64_t, outstanding> Active;
+
+        // parts of leases that were taken back, given out first.
+        std::deque<lease> Returned;
+
+        uint64_t Done;
+
+        void take_back(const outstanding&);
+
+    public:
+        ledger(keys::secret_bytes start, uint32 stride, uint64_t count, clock::duration timeout) :
+            Next{start}, Stride{stride}, Count{count}, Timeout{timeout},
+            NextId{1}, Active{}, Returned{}, Done{0} {}
+
+        lease issue(const std::string& worker, clock::time_point now);
+
+        // the worker has done the first n keys of the lease. False if
+        // the lease has expired or is not held by this worker, which
+        // should then stop.
+        bool renew(uint64_t id, const std::string& worker, uint64_t n, clock::time_point now);
+
+        // false if the lease is not held by this worker.
+        bool complete(uint64_t id, const std::string& worker);
+
+        // take back leases which have not been renewed in time.
+        uint32 expire(clock::time_point now);
+
+        // take back every lease held by a worker which has gone away.
+        uint32 drop(const std::string& worker);
+
+        uint64_t done() const {
+            return Done;
+        }
+
+        size_t active() const {
+            return Active.size();
+        }
+
+        // Leases which are out are saved as returned, so
+        // that nothing is lost if the coordinator restarts.
+        json write() const;
+        static ledger read(const json&, clock::duration timeout);
+    };
+
+    struct options {
+        // "unix:<path>" or "<host>:<port>"
+        std::string Address;
+        std::string State;
+        uint32 Keep;
+        std::chrono::seconds Timeout;
+    };
+
+    // Serve leases until the process is stopped. The state is saved with
+    // the candidates as the miner's "keys", and whatever else is in it,
+    // such as the rest of a miner's state, is kept as it is.
+    void serve(const options&, ledger, best, json state);
+
+    // key to hash160 of the compressed pubkey.
+    using hasher = std::function<keys::hash160(const keys::secret_bytes&)>;
+
+    // mine leases from the coordinator until it goes away.
+    void work(const std::string& address, uint32 threads, uint32 keep, hasher);
+
+}
+
+#endif
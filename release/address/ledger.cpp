@@ -0,0 +1,189 @@
+#include "coordinator.hpp"
+#include <cosmos/secp256k1.hpp>
+#include <cosmos/base58.hpp>
+
+namespace cosmos::bitcoin::coordinator {
+
+    namespace {
+
+        template <size_t n>
+        std::string hex(const std::array<byte, n>& b) {
+            const char digits[] = "0123456789abcdef";
+            std::string x{};
+            for (byte z : b) {
+                x += digits[z >> 4];
+                x += digits[z & 15];
+            }
+            return x;
+        }
+
+        template <size_t n>
+        std::array<byte, n> unhex(const std::string& x) {
+            if (x.size() != 2 * n) throw std::runtime_error{"expected " + std::to_string(n) + " bytes of hex"};
+            std::array<byte, n> b{};
+            for (size_t i = 0; i < n; i++) b[i] = byte(std::stoul(x.substr(2 * i, 2), nullptr, 16));
+            return b;
+        }
+
+    }
+
+    keys::secret_bytes plus(keys::secret_bytes b, unsigned __int128 n) {
+        unsigned __int128 carry = n;
+        for (int i = 31; i >= 0 && carry != 0; i--) {
+            carry += b[i];
+            b[i] = byte(carry);
+            carry >>= 8;
+        }
+
+        // less than twice the order, so once is enough.
+        if (carry == 0 && b < secp256k1::order) return b;
+        int borrow = 0;
+        for (int i = 31; i >= 0; i--) {
+            int d = int(b[i]) - int(secp256k1::order[i]) - borrow;
+            borrow = d < 0;
+            b[i] = byte(d);
+        }
+        return b;
+    }
+
+    keys::secret_bytes lease::key(uint64_t i) const {
+        return plus(Start, (unsigned __int128)(i) * Stride);
+    }
+
+    json lease::write() const {
+        return json{{"id", Id}, {"start", hex(Start)}, {"stride", Stride}, {"count", Count}};
+    }
+
+    lease lease::read(const json& j) {
+        return lease{j.at("id").get<uint64_t>(), unhex<32>(j.at("start").get<std::string>()),
+            j.at("stride").get<uint32>(), j.at("count").get<uint64_t>()};
+    }
+
+    json candidate::write() const {
+        return json{{"digest", hex(Digest)}, {"key", hex(Key)}};
+    }
+
+    candidate candidate::read(const json& j) {
+        return candidate{unhex<20>(j.at("digest").get<std::string>()), unhex<32>(j.at("key").get<std::string>())};
+    }
+
+    bool best::add(const candidate& c) {
+        if (Size == 0) return false;
+        if (Set.size() == Size && !(c < *Set.rbegin())) return false;
+        if (!Set.insert(c).second) return false;
+        if (Set.size() > Size) Set.erase(std::prev(Set.end()));
+        return true;
+    }
+
+    json best::write() const {
+        vector<keys::secret_bytes> secrets{};
+        vector<keys::hash160> digests{};
+        for (const candidate& c : Set) {
+            secrets.push_back(c.Key);
+            digests.push_back(c.Digest);
+        }
+
+        vector<std::string> wifs = base58::write_wifs(secrets);
+        vector<std::string> addresses = base58::write_addresses(digests);
+
+        json j = json::array();
+        for (size_t i = 0; i < wifs.size(); i++) j.push_back(json{{"key", wifs[i]}, {"address", addresses[i]}});
+        return j;
+    }
+
+    void best::read(const json& j) {
+        for (const json& x : j) {
+            candidate c{};
+            bool compressed;
+            if (!base58::read_wif(x.at("key").get<std::string>(), c.Key, compressed) || !compressed ||
+                !base58::read_address(x.at("address").get<std::string>(), c.Digest))
+                throw std::runtime_error{"cannot read key " + x.dump()};
+            add(c);
+        }
+    }
+
+    void ledger::take_back(const outstanding& o) {
+        if (o.Done >= o.Lease.Count) return;
+        Returned.push_back(lease{0, o.Lease.key(o.Done), o.Lease.Stride, o.Lease.Count - o.Done});
+    }
+
+    lease ledger::issue(const std::string& worker, clock::time_point now) {
+        lease l{NextId++, Next, Stride, Count};
+        if (!Returned.empty()) {
+            lease r = Returned.front();
+            Returned.pop_front();
+            l.Start = r.Start;
+            l.Stride = r.Stride;
+            l.Count = r.Count;
+        } else Next = l.key(Count);
+
+        Active[l.Id] = outstanding{l, worker, 0, now + Timeout};
+        return l;
+    }
+
+    bool ledger::renew(uint64_t id, const std::string& worker, uint64_t n, clock::time_point now) {
+        auto i = Active.find(id);
+        if (i == Active.end() || i->second.Worker != worker) return false;
+        outstanding& o = i->second;
+        n = std::min(n, o.Lease.Count);
+        if (n > o.Done) {
+            Done += n - o.Done;
+            o.Done = n;
+        }
+        o.Expires = now + Timeout;
+        return true;
+    }
+
+    bool ledger::complete(uint64_t id, const std::string& worker) {
+        auto i = Active.find(id);
+        if (i == Active.end() || i->second.Worker != worker) return false;
+        Done += i->second.Lease.Count - i->second.Done;
+        Active.erase(i);
+        return true;
+    }
+
+    uint32 ledger::expire(clock::time_point now) {
+        uint32 n = 0;
+        for (auto i = Active.begin(); i != Active.end();) {
+            if (i->second.Expires < now) {
+                take_back(i->second);
+                i = Active.erase(i);
+                n++;
+            } else i++;
+        }
+        return n;
+    }
+
+    uint32 ledger::drop(const std::string& worker) {
+        uint32 n = 0;
+        for (auto i = Active.begin(); i != Active.end();) {
+            if (i->second.Worker == worker) {
+                take_back(i->second);
+                i = Active.erase(i);
+                n++;
+            } else i++;
+        }
+        return n;
+    }
+
+    json ledger::write() const {
+        json returned = json::array();
+        for (const lease& l : Returned) returned.push_back(l.write());
+        for (const auto& a : Active) {
+            const outstanding& o = a.second;
+            if (o.Done < o.Lease.Count)
+                returned.push_back(lease{0, o.Lease.key(o.Done), o.Lease.Stride, o.Lease.Count - o.Done}.write());
+        }
+
+        return json{{"next", hex(Next)}, {"stride", Stride}, {"count", Count}, {"done", Done}, {"returned", returned}};
+    }
+
+    ledger ledger::read(const json& j, clock::duration timeout) {
+        ledger l{unhex<32>(j.at("next").get<std::string>()), j.at("stride").get<uint32>(),
+            j.at("count").get<uint64_t>(), timeout};
+        l.Done = j.at("done").get<uint64_t>();
+        for (const json& r : j.at("returned")) l.Returned.push_back(lease::read(r));
+        return l;
+    }
+
+}
@@ -2,6 +2,7 @@
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 namespace cosmos::bitcoin {
     using json = nlohmann::json;
@@ -11,6 +12,7 @@ namespace cosmos::bitcoin {
     miner::running* worker{};
     
     void miner::running::program::operator()(state s) {
+        if (Cpu >= 0 && topology::pin(Cpu)) precompute::generator::place(topology::node_of(Cpu));
         c.put(miner::run(s, User));
     }
         
@@ -21,21 +23,112 @@ namespace cosmos::bitcoin {
         delete worker;
     }
 
-    /*data::program::output miner::operator()(int argc, char* argv[]) {
-        list<std::string> inputs = data::program::list_input_parser<list<std::string>>{}(argc, argv));
-        // TODO open file here. 
-        worker = running::run(state::restore());
+    // address <increment> <keep> [--cpu n] [--vanity prefix]... [--insensitive]
+    // The first key is read as a WIF from the standard input. The miner 
+    // runs until ctrl-c, and then the best keys found are written out, 
+    // along with any that match a vanity prefix. 
+    data::program::output miner::operator()(int argc, char* argv[]) {
+        const std::string usage = "usage: address <increment> <keep> [--cpu n] [--vanity prefix]... [--insensitive]";
+        
+        vector<std::string> inputs{};
+        vector<std::string> prefixes{};
+        bool case_sensitive = true;
+        int cpu = -1;
+        for (int i = 1; i < argc; i++) {
+            const std::string x = argv[i];
+            if (x == "--cpu" || x == "--vanity") {
+                if (i + 1 == argc) return {usage};
+                if (x == "--cpu") cpu = std::stoi(argv[++i]);
+                else prefixes.push_back(argv[++i]);
+            } else if (x == "--insensitive") case_sensitive = false;
+            else inputs.push_back(x);
+        }
+        
+        if (inputs.size() != 2) return {usage};
+        
+        std::string wif;
+        std::cout << "provide entropy for next key: "; 
+        std::cin >> wif;
+        secret next = address::read_wif(wif);
+        if (!next.valid()) return {"invalid wif"};
+        
+        state s{uint32(std::stoul(inputs[0])), addresses{uint32(std::stoul(inputs[1])), {}}, next};
+        
+        // compile throws for a prefix that no address can start with. 
+        if (!prefixes.empty()) {
+            vector<vanity::prefix> compiled{};
+            for (const std::string& p : prefixes) compiled.push_back(vanity::compile(p, case_sensitive));
+            s.Vanity = std::make_shared<const vanity::pattern>(compiled);
+            s.Vanity->write(std::cout);
+        }
+        
+        worker = running::run(s, cpu);
         signal(SIGINT, on_ctrl_c);
         state end;
         c.get(end);
-    }*/
+        if (!end.Error.empty()) return {end.Error};
+        
+        std::stringstream out;
+        end.save(out);
+        return {out.str()};
+    }
+    
+    namespace {
+        
+        keys::secret_bytes plus(keys::secret_bytes b, uint32 n) {
+            uint64_t carry = n;
+            for (int i = 31; i >= 0 && carry != 0; i--) {
+                carry += b[i];
+                b[i] = byte(carry);
+                carry >>= 8;
+            }
+            return b;
+        }
+        
+    }
+    
+    void miner::state::take(const address& next) {
+        // only candidates inside the pattern's ranges are encoded. 
+        if (Vanity != nullptr && Vanity->test(keys::write(next.Address)) && 
+            !Vanity->match(base58::write_address(keys::write(next.Address))).empty()) Matches.push_back(next);
+        
+        Addresses = Addresses.update(next);
+    }
+    
+    void miner::state::round() {
+        take(address{Next});
+        Next = keys::read_secret(plus(keys::write(Next), Increment));
+    }
+    
+    void miner::state::rounds(uint32 n) {
+        if (Walk == nullptr) Walk = std::make_shared<field::walk>(Next, Increment);
+        
+        vector<keys::pubkey_bytes> pubkeys(Walk->size());
+        for (uint32 done = 0; done < n; done += Walk->size()) {
+            Walk->next(pubkeys.data());
+            for (const keys::pubkey_bytes& p : pubkeys) {
+                take(address{Next, keys::read_pubkey(p)});
+                Next = keys::read_secret(plus(keys::write(Next), Increment));
+            }
+        }
+    }
     
     std::vector<json> save_addresses(data::ordered_list<miner::address> l) {
-        std::vector<json> j{l.size()};
+        vector<keys::secret_bytes> secrets{};
+        vector<keys::hash160> digests{};
+        for (; !l.empty(); l = l.rest()) {
+            secrets.push_back(keys::write(l.first().Secret));
+            digests.push_back(keys::write(l.first().Address));
+        }
+        
+        // encoded all at once since there may be millions. 
+        vector<std::string> wifs = base58::write_wifs(secrets);
+        vector<std::string> addresses = base58::write_addresses(digests);
+        
+        std::vector<json> j{wifs.size()};
         for (int i = 0; i < j.size(); i++) {
-            j[i]["key"] = l.first().Secret.write();
-            j[i]["address"] = l.first().Address.write();
-            l = l.rest();
+            j[i]["key"] = wifs[i];
+            j[i]["address"] = addresses[i];
         }
         return j;
     }
@@ -55,6 +148,13 @@ namespace cosmos::bitcoin {
         j["increment"] = std::to_string(Increment);
         j["max_size"] = Addresses.MaxSize;
         j["keys"] = save_addresses(Addresses.List);
+        
+        std::vector<json> matches{Matches.size()};
+        for (int i = 0; i < matches.size(); i++) {
+            matches[i]["key"] = base58::write_wif(keys::write(Matches[i].Secret));
+            matches[i]["address"] = base58::write_address(keys::write(Matches[i].Address));
+        }
+        if (Vanity != nullptr) j["vanity"] = matches;
         out << j;
     };
     
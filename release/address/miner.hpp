@@ -2,6 +2,11 @@
 #define COSMOS_RELEASE_MINER
 
 #include <cosmos/cosmos.hpp>
+#include <cosmos/precompute.hpp>
+#include <cosmos/field.hpp>
+#include <cosmos/topology.hpp>
+#include <cosmos/vanity.hpp>
+#include <cosmos/base58.hpp>
 #include <data/tools/ordered_list.hpp>
 #include <thread>
 #include <csignal>
@@ -25,7 +30,18 @@ namespace cosmos::bitcoin {
             }
             
             address(secret s) : Secret{s}, Pubkey{s.to_public()}, Address{Pubkey.address()} {}
-            address(std::string& wif) : address(secret{wif}) {}
+            address(secret s, pubkey p) : Secret{s}, Pubkey{p}, Address{Pubkey.address()} {}
+            address(std::string& wif) : address(read_wif(wif)) {}
+            
+            // Invalid if the string is not a WIF secret. Addresses here are
+            // of compressed pubkeys, so a WIF for an uncompressed one is 
+            // invalid as well rather than read as a different address. 
+            static secret read_wif(const std::string& wif) {
+                keys::secret_bytes k{};
+                bool compressed;
+                if (!base58::read_wif(wif, k, compressed) || !compressed) return secret{};
+                return keys::read_secret(k);
+            }
         };
         
         // ordered list of addresses. 
@@ -54,14 +70,28 @@ namespace cosmos::bitcoin {
             secret Next;
             std::string Error;
             
+            // if set, addresses matching any of these prefixes
+            // are kept in addition to the best by digest. 
+            ptr<const vanity::pattern> Vanity;
+            vector<address> Matches;
+            
+            // pubkeys of the keys from Next on, made a batch at a time. 
+            // Copies share it, so only the latest copy may be run. It is 
+            // made by the thread that runs it, so its buffers are on that 
+            // thread's node. The walk is not constant time, so the 
+            // keys it makes can leak to anything sharing the machine. 
+            ptr<field::walk> Walk;
+            
             state() {}
             state(const std::string& e) : Error{e} {}
             state(uint32 i, addresses a, secret n) : Increment{i}, Addresses{a}, Next{n} {}
             
-            void round(); /*{
-                Addresses = Addresses.update(Next);
-                Next.Secret.Value += Increment;
-            }*/
+            void round();
+            
+            // at least n keys, in whole batches of the walk. 
+            void rounds(uint32 n);
+            
+            void take(const address&);
         
             // read in program state from user input.
             static state restore(std::istream& disk);
@@ -77,7 +107,7 @@ namespace cosmos::bitcoin {
         static state work(state s, data::channel<command> user) {
             const uint32 rounds = 10000;
             while (true) {
-                for (uint32 i = 0; i < rounds; i++) s.round();
+                s.rounds(rounds);
                 command c;
                 if (user.get(c, false))
                     switch (c) {
@@ -103,16 +133,22 @@ namespace cosmos::bitcoin {
         class running {
             struct program {
                 data::channel<command> User;
+                
+                // the CPU to pin the thread to, if any. 
+                int Cpu;
+                
                 void operator()(state s);
             };
         
             std::thread Program;
             data::channel<command> User;
             
-            running(state s, data::channel<command> user) : Program{program{user}, s} {}
+            running(state s, data::channel<command> user, int cpu) : Program{program{user, cpu}, s} {}
         public:
-            static running* run(state s) {
-                return new running{s, data::channel<command>{}};
+            // With a CPU, the miner runs only on that CPU and uses 
+            // a copy of the generator table on its NUMA node. 
+            static running* run(state s, int cpu = -1) {
+                return new running{s, data::channel<command>{}, cpu};
             }
             
             state stop() {
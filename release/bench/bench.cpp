@@ -0,0 +1,363 @@
+#include "../pow/pow.hpp"
+#include <cosmos/precompute.hpp>
+#include <cosmos/field.hpp>
+#include <cosmos/topology.hpp>
+#include <cosmos/workspace.hpp>
+#include <cosmos/parser.hpp>
+#include <cosmos/number.hpp>
+#include <cosmos/evaluation/async.hpp>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+
+// benchmarks of the parts of pow and of the wallet, which
+// print what they measure along with any mismatches.
+namespace cosmos::bitcoin {
+    
+    namespace bench {
+        using namespace pow;
+        
+        // bench scripts <exponent> <value> [count]   compare compiling output 
+        //                                            scripts with patching templates. 
+        std::string scripts(const vector<std::string>& args) {
+            if (args.size() < 2) throw error{"target exponent and value required"};
+            const work::target t = read_target(args[0], args[1]);
+            const uint count = args.size() > 2 ? read_uint_dec(args[2]) : 100000;
+            
+            std::mt19937_64 random{1};
+            vector<digest_bytes> digests(count);
+            vector<keys::hash160> addresses(count);
+            for (digest_bytes& d : digests) for (byte& b : d) b = byte(random());
+            for (keys::hash160& a : addresses) for (byte& b : a) b = byte(random());
+            
+            std::stringstream out;
+            auto compare = [&out, count](const std::string& shape, bool patched, auto compiled, auto templated) {
+                uint mismatches = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (uint i = 0; i < count; i++) if (compiled(i).empty()) mismatches++;
+                double tree = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                
+                start = std::chrono::steady_clock::now();
+                for (uint i = 0; i < count; i++) if (templated(i).empty()) mismatches++;
+                double patch = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                
+                for (uint i = 0; i < count; i++) if (compiled(i) != templated(i)) mismatches++;
+                
+                out << shape << (patched ? " (patched)" : " (compiled; the shape depends on the field)") << ": "
+                    << count / tree << " compiled/s, " << count / patch << " from template/s, "
+                    << tree / patch << "x; " << mismatches << " mismatches\n";
+            };
+            
+            compare("pow lock", pow_locks().patched(t),
+                [&](uint i) -> bytes { return compile_pow_lock(t, digests[i]); },
+                [&](uint i) -> bytes { return pow_locks()(t, digests[i]); });
+            
+            compare("pay to address", pay_to_addresses().patched(0),
+                [&](uint i) -> bytes { return compile_pay_to(0, addresses[i]); },
+                [&](uint i) -> bytes { return pay_to_addresses()(0, addresses[i]); });
+            
+            return out.str();
+        }
+        
+        // bench field [count]   check each field backend this machine can 
+        //                       run against GMP and the library, and time it. 
+        std::string field_backends(const vector<std::string>& args) {
+            const uint count = args.empty() ? 10000 : read_uint_dec(args[0]);
+            
+            std::stringstream out;
+            out << "best: " << field::name(field::best()) << "\n";
+            for (field::backend b : {field::portable, field::ifma}) {
+                if (!field::supported(b)) {
+                    out << field::name(b) << ": not supported here\n";
+                    continue;
+                }
+                
+                const uint64_t mismatches = field::check(b, count);
+                
+                std::mt19937_64 random{1};
+                keys::secret_bytes s{};
+                for (byte& x : s) x = byte(random());
+                s[0] &= 0x7f;
+                
+                field::walk w{keys::read_secret(s), 1, 1024, b};
+                vector<keys::pubkey_bytes> p(w.size());
+                const uint batches = 100;
+                const auto start = std::chrono::steady_clock::now();
+                for (uint i = 0; i < batches; i++) w.next(p.data());
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                
+                out << field::name(b) << ": " << mismatches << " mismatches, " 
+                    << batches * w.size() / seconds << " pubkeys/s\n";
+            }
+            
+            return out.str();
+        }
+        
+        // bench topology [seconds]   the nodes and huge pages here, and keys/s 
+        //                            with a thread on every CPU we may use, 
+        //                            with and without pinning the threads 
+        //                            and placing their memory on their node. 
+        std::string placement(const vector<std::string>& args) {
+            const double seconds = args.empty() ? 2 : std::stod(args[0]);
+            
+            std::stringstream out;
+            topology::write(out);
+            
+            vector<uint32> cpus{};
+            for (const topology::node& n : topology::nodes()) cpus.insert(cpus.end(), n.Cpus.begin(), n.Cpus.end());
+            
+            auto start = [](size_t t) -> keys::secret_bytes {
+                std::mt19937_64 random{t + 1};
+                keys::secret_bytes s{};
+                for (byte& x : s) x = byte(random());
+                s[0] &= 0x7f;
+                return s;
+            };
+            
+            topology::region::backing backing = topology::region::none;
+            
+            // Unplaced threads use the shared table and walks made on 
+            // this thread. Each thread is timed from when it is ready. 
+            auto measure = [&](bool placed, bool walk) -> double {
+                std::atomic<bool> stop{false};
+                vector<double> rates(cpus.size());
+                vector<ptr<field::walk>> walks(cpus.size());
+                if (walk && !placed) for (size_t t = 0; t < cpus.size(); t++) 
+                    walks[t] = std::make_shared<field::walk>(keys::read_secret(start(t)), 1);
+                
+                vector<std::thread> threads{};
+                for (size_t t = 0; t < cpus.size(); t++) threads.emplace_back([&, t]() {
+                    if (placed && topology::pin(cpus[t])) {
+                        precompute::generator::place(topology::node_of(cpus[t]));
+                        if (t == 0) backing = precompute::generator::local().backed();
+                    }
+                    
+                    keys::secret_bytes s = start(t);
+                    if (walk && placed) walks[t] = std::make_shared<field::walk>(keys::read_secret(s), 1);
+                    vector<keys::pubkey_bytes> p(walk ? walks[t]->size() : 0);
+                    
+                    uint64_t n = 0;
+                    const auto begin = std::chrono::steady_clock::now();
+                    while (!stop) {
+                        if (walk) {
+                            walks[t]->next(p.data());
+                            n += p.size();
+                        } else {
+                            s[31] = byte(n) | 1;
+                            s[30] = byte(n >> 8);
+                            precompute::to_public(keys::read_secret(s));
+                            n++;
+                        }
+                    }
+                    rates[t] = n / std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                });
+                
+                std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+                stop = true;
+                for (std::thread& t : threads) t.join();
+                
+                double total = 0;
+                for (double r : rates) total += r;
+                return total;
+            };
+            
+            for (bool walk : {false, true}) {
+                const double free = measure(false, walk);
+                const double placed = measure(true, walk);
+                out << cpus.size() << " threads, " << (walk ? "field walk" : "comb table") << ": " 
+                    << free << " keys/s unplaced, " << placed << " keys/s pinned and placed\n";
+            }
+            out << "placed tables in " << topology::name(backing) << "\n";
+            
+            return out.str();
+        }
+        
+        // bench import <file>   import a list of keys into a workspace 
+        //                       and report the lines that were not keys. 
+        std::string import_keys(const vector<std::string>& args) {
+            if (args.empty()) throw error{"file required"};
+            std::ifstream file{args[0], std::ios::binary};
+            if (!file) throw error{"could not read " + args[0]};
+            const std::string text{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+            
+            import::report r{};
+            const auto start = std::chrono::steady_clock::now();
+            const cosmos::work::space w = cosmos::work::space{}.import(cosmos::name{"watch"}, text, r);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            std::stringstream out;
+            for (const import::error& e : r.Errors) out << "line " << e.Line << ": " << e.Message << "\n";
+            out << r.Secrets << " secrets (" << w.Keys.size() << " distinct), " << r.Pubkeys << " pubkeys, " 
+                << r.Errors.size() << " invalid in " << seconds << "s\n";
+            return out.str();
+        }
+        
+        
+        // bench restore [used] [gap]   restore a keysource from a scan which 
+        //                              found the first used addresses paid. 
+        std::string restoration(const vector<std::string>& args) {
+            const uint used = args.size() > 0 ? read_uint_dec(args[0]) : 100000;
+            const uint gap = args.size() > 1 ? read_uint_dec(args[1]) : 20;
+            
+            bip32::extended x{};
+            x.Pubkey = keys::write(precompute::to_public(keys::read_secret(keys::secret_bytes{{1}})));
+            x.ChainCode.fill(7);
+            
+            // the addresses are derived from another chain, 
+            // so that the one restored starts from nothing. 
+            std::unordered_set<keys::hash160, utxo::hash> paid{};
+            bip32::chain c{x};
+            for (uint i = 0; i < used; i++) if (c.exists(i)) paid.insert(c.address(i));
+            
+            const auto start = std::chrono::steady_clock::now();
+            const cosmos::work::keysource k = cosmos::work::keysource::restore(x, paid, gap);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            std::stringstream out;
+            out << "restored " << used << " used addresses with a gap of " << gap << " in " << seconds << "s: " 
+                << k.Chain->derived() / seconds << " children/s, next address " << k.Next 
+                << (k.Next == used ? "" : " (expected " + std::to_string(used) + ")") << "\n";
+            return out.str();
+        }
+        
+        
+        // bench numbers [count]   arithmetic/s on interpreter numbers, inline and 
+        //                         in GMP, with the left operand kept and given up. 
+        std::string numbers(const vector<std::string>& args) {
+            const uint count = args.size() > 0 ? read_uint_dec(args[0]) : 1000000;
+            
+            const number big{"340282366920938463463374607431768211457"};
+            
+            // a left and a right operand. The left is copied each time, 
+            // so that giving it up is measured against keeping it. 
+            struct shape {
+                std::string Name;
+                number Left;
+                number Right;
+                op Operator;
+            };
+            
+            const vector<shape> shapes{
+                {"inline + inline", number{1}, number{3}, cosmos::plus}, 
+                {"GMP + inline", big, number{3}, cosmos::plus}, 
+                {"GMP + GMP", big, big, cosmos::plus}, 
+                {"GMP * inline", big, number{-7}, cosmos::times}, 
+                {"GMP * GMP", big, big, cosmos::times}};
+            
+            std::stringstream out;
+            for (const shape& x : shapes) {
+                auto run = [&x, count](bool give) -> std::pair<double, number> {
+                    number r{};
+                    const auto start = std::chrono::steady_clock::now();
+                    for (uint i = 0; i < count; i++) {
+                        number a = x.Left;
+                        if (x.Operator == cosmos::plus) r = give ? std::move(a) + x.Right : a + x.Right;
+                        else r = give ? std::move(a) * x.Right : a * x.Right;
+                    }
+                    return {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), r};
+                };
+                
+                std::pair<double, number> kept = run(false);
+                std::pair<double, number> given = run(true);
+                out << x.Name << ": " << count / kept.first << " operations/s kept, " 
+                    << count / given.first << " operations/s given up" 
+                    << (kept.second == given.second ? "" : " (results differ)") << "\n";
+            }
+            
+            return out.str();
+        }
+        
+        // bench async [statements] [sessions] [latency]   statements/s through the 
+        //                                                 executor when every one waits 
+        //                                                 on a backend which answers 
+        //                                                 after latency microseconds. 
+        std::string asynchronous(const vector<std::string>& args) {
+            const uint count = args.size() > 0 ? read_uint_dec(args[0]) : 10000;
+            const uint sessions = args.size() > 1 ? read_uint_dec(args[1]) : 100;
+            const std::chrono::microseconds latency{args.size() > 2 ? read_uint_dec(args[2]) : 1000};
+            if (sessions == 0) throw error{"at least one session required"};
+            
+            evaluation::loop l{};
+            evaluation::async::slow_backend b{l, latency};
+            evaluation::async::executor x{l, b};
+            
+            vector<ptr<expression>> statements{};
+            for (uint i = 0; i < count; i++) {
+                stringstream ss{"update(" + std::to_string(i) + ")"};
+                statements.push_back(parse::statement(ss));
+            }
+            
+            uint answered = 0;
+            uint failed = 0;
+            const auto start = std::chrono::steady_clock::now();
+            l.post([&]() {
+                for (uint i = 0; i < count; i++) x.submit(i % sessions, statements[i], [&](evaluation::response r) {
+                    if (r.error()) failed++;
+                    if (++answered == count) l.stop();
+                });
+            });
+            if (count > 0) l.run();
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            // statements in a session are answered in order, so one session 
+            // can do no better than this however it waits. 
+            const double limit = 1e6 / latency.count();
+            
+            std::stringstream out;
+            out << count << " statements in " << sessions << " sessions, " << latency.count() << "us latency: " 
+                << count / seconds << " statements/s, " << b.requests() << " requests, " << failed << " failed; "
+                << "at most " << limit << "/s in one session\n";
+            return out.str();
+        }
+        
+    }
+    
+}
+
+namespace cosmos {
+
+    // bench <mode> [arguments...]
+    using mode = std::function<std::string(const vector<std::string>&)>;
+    
+    const std::map<std::string, mode>& modes() {
+        static const std::map<std::string, mode> Modes{
+            {"scripts", bitcoin::bench::scripts}, 
+            {"field", bitcoin::bench::field_backends}, 
+            {"topology", bitcoin::bench::placement}, 
+            {"import", bitcoin::bench::import_keys}, 
+            {"restore", bitcoin::bench::restoration}, 
+            {"numbers", bitcoin::bench::numbers}, 
+            {"async", bitcoin::bench::asynchronous}};
+        return Modes;
+    }
+    
+    std::string usage() {
+        std::string u = "usage: bench <mode> [arguments...]\nmodes:";
+        for (const auto& m : modes()) u += " " + m.first;
+        return u + "\n";
+    }
+
+    std::string run(const vector<std::string>& input) noexcept {
+        try {
+            if (input.empty()) return usage();
+            auto m = modes().find(input[0]);
+            if (m == modes().end()) return usage();
+            return m->second(vector<std::string>(input.begin() + 1, input.end()));
+        } catch (std::exception& e) {
+            return std::string{e.what()} + "\n";
+        } catch (...) {
+            return "unknown error.\n";
+        }
+    }
+    
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << cosmos::run(cosmos::vector<std::string>(argv + 1, argv + argc));
+    return 0;
+}
@@ -0,0 +1,269 @@
+#include "cosmosd.hpp"
+#include <cosmos/parser.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace cosmos::daemon {
+
+    bool writes(const std::string& script) {
+        stringstream ss{script};
+        expression::parameters p{};
+        try {
+            p = parse::program(ss);
+        } catch (const parse::error&) {
+            // it will fail again when it is evaluated.
+            return false;
+        }
+
+        for (ptr<expression> e : p) if (e->writes()) return true;
+        return false;
+    }
+
+    void latency::add(std::chrono::nanoseconds d) {
+        std::lock_guard<std::mutex> lock{Mutex};
+        Samples[Count % size] = d.count();
+        Count++;
+    }
+
+    std::string latency::report() const {
+        vector<uint64_t> s{};
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            s.assign(Samples.begin(), Samples.begin() + std::min<uint64_t>(Count, size));
+        }
+
+        if (s.empty()) return "no requests";
+        std::sort(s.begin(), s.end());
+
+        auto at = [&s](double p) -> double {
+            return s[std::min<size_t>(s.size() - 1, size_t(p * s.size()))] / 1000.0;
+        };
+
+        std::stringstream ss;
+        ss << s.size() << " requests; microseconds p50 " << at(.5) << " p90 " << at(.9)
+            << " p99 " << at(.99) << " p99.9 " << at(.999) << " max " << s.back() / 1000.0;
+        return ss.str();
+    }
+
+    pool::pool(uint32 threads) : Threads{}, Jobs{}, Mutex{}, Ready{}, Done{false} {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32 i = 0; i < threads; i++) Threads.emplace_back([this]() { work(); });
+    }
+
+    pool::~pool() {
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            Done = true;
+        }
+
+        Ready.notify_all();
+        for (std::thread& t : Threads) t.join();
+    }
+
+    void pool::submit(std::function<void()> f) {
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            Jobs.push_back(std::move(f));
+        }
+
+        Ready.notify_one();
+    }
+
+    void pool::work() {
+        while (true) {
+            std::function<void()> f;
+            {
+                std::unique_lock<std::mutex> lock{Mutex};
+                Ready.wait(lock, [this]() -> bool { return Done || !Jobs.empty(); });
+                if (Jobs.empty()) return;
+                f = std::move(Jobs.front());
+                Jobs.pop_front();
+            }
+
+            f();
+        }
+    }
+
+    // a connected client. Requests are lines and are
+    // answered one at a time in the order received.
+    struct session {
+        int Socket;
+        std::string Input;
+        std::atomic<bool> Busy;
+        bool Closed;
+        evaluation::memo Memo;
+
+        session(int s) : Socket{s}, Input{}, Busy{false}, Closed{false}, Memo{4096} {}
+
+        ~session() {
+            ::close(Socket);
+        }
+    };
+
+    namespace {
+
+        std::string write(const evaluation::response& r) {
+            if (r.error()) return "error: " + r.Error.Message;
+            if (r.Return == nullptr) return "ok";
+            stringstream ss;
+            r.Return->express()->write(ss);
+            return ss.str();
+        }
+
+        // the accounting report on one line, since
+        // every response is a single line.
+        std::string memory(const work::space& w) {
+            stringstream ss;
+            accounting::write(ss, accounting::measure(w));
+            accounting::write(ss);
+            std::string x = ss.str();
+            std::replace(x.begin(), x.end(), '\n', ';');
+            return x;
+        }
+
+        void send_all(int s, const std::string& x) {
+            size_t sent = 0;
+            while (sent < x.size()) {
+                ssize_t n = ::send(s, x.data() + sent, x.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return;
+                sent += n;
+            }
+        }
+
+        constexpr uint32 attempts = 16;
+
+    }
+
+    server::server(const std::string& path, uint32 threads, work::space w)
+        : Path{path}, Listen{-1}, Wake{-1, -1}, Store{w}, Latency{}, Pool{threads} {
+        sockaddr_un a{};
+        a.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(a.sun_path)) throw std::runtime_error{"socket path too long"};
+        std::strcpy(a.sun_path, path.c_str());
+        ::unlink(path.c_str());
+
+        Listen = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (Listen < 0 ||
+            ::bind(Listen, reinterpret_cast<sockaddr*>(&a), sizeof(a)) != 0 ||
+            ::listen(Listen, 128) != 0 ||
+            ::pipe(Wake) != 0)
+            throw std::runtime_error{std::string{"cannot listen on "} + path + ": " + std::strerror(errno)};
+    }
+
+    server::~server() {
+        if (Listen >= 0) ::close(Listen);
+        if (Wake[0] >= 0) ::close(Wake[0]);
+        if (Wake[1] >= 0) ::close(Wake[1]);
+        ::unlink(Path.c_str());
+    }
+
+    std::string server::evaluate(session& s, const std::string& script) {
+        if (script == "stats") return Latency.report();
+        if (script == "memory") return memory(Store.get().Space);
+
+        const bool w = writes(script);
+        for (uint32 i = 0; i < attempts; i++) {
+            store::snapshot x = Store.get();
+            stringstream ss{script};
+            evaluation::response r = cosmos::evaluate(x.Space, ss, s.Memo);
+            if (!w || r.error() || Store.commit(x, r.Result)) return write(r);
+        }
+
+        return "error: could not commit; too many concurrent writers";
+    }
+
+    void server::run() {
+        std::map<int, ptr<session>> sessions{};
+
+        while (true) {
+            vector<pollfd> fds{{Listen, POLLIN, 0}, {Wake[0], POLLIN, 0}};
+            for (auto& s : sessions) if (!s.second->Busy && !s.second->Closed) fds.push_back({s.first, POLLIN, 0});
+
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error{std::string{"poll: "} + std::strerror(errno)};
+            }
+
+            if (fds[1].revents & POLLIN) {
+                char b[256];
+                ::read(Wake[0], b, sizeof(b));
+            }
+
+            if (fds[0].revents & POLLIN) {
+                int c = ::accept4(Listen, nullptr, nullptr, SOCK_CLOEXEC);
+                if (c >= 0) sessions[c] = std::make_shared<session>(c);
+            }
+
+            for (size_t i = 2; i < fds.size(); i++) {
+                if (fds[i].revents == 0) continue;
+                session& s = *sessions[fds[i].fd];
+                char b[4096];
+                ssize_t n = ::recv(s.Socket, b, sizeof(b), 0);
+                if (n > 0) s.Input.append(b, n);
+                else if (n == 0 || errno != EINTR) s.Closed = true;
+            }
+
+            for (auto i = sessions.begin(); i != sessions.end();) {
+                ptr<session> s = i->second;
+                if (s->Busy) {
+                    i++;
+                    continue;
+                }
+
+                size_t end = s->Input.find('\n');
+                if (end == std::string::npos) {
+                    if (s->Closed) i = sessions.erase(i);
+                    else i++;
+                    continue;
+                }
+
+                std::string script = s->Input.substr(0, end);
+                s->Input.erase(0, end + 1);
+                s->Busy = true;
+
+                Pool.submit([this, s, script]() {
+                    auto start = std::chrono::steady_clock::now();
+                    std::string answer;
+                    try {
+                        answer = evaluate(*s, script);
+                    } catch (const std::exception& e) {
+                        answer = std::string{"error: "} + e.what();
+                    }
+
+                    send_all(s->Socket, answer + "\n");
+                    Latency.add(std::chrono::steady_clock::now() - start);
+                    s->Busy = false;
+                    char w = 0;
+                    ::write(Wake[1], &w, 1);
+                });
+
+                i++;
+            }
+        }
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cout << "usage: cosmosd <socket path> [threads]" << std::endl;
+        return 1;
+    }
+
+    try {
+        cosmos::daemon::server s{argv[1], argc == 3 ? uint32_t(std::stoul(argv[2])) : 0, cosmos::work::space{}};
+        s.run();
+    } catch (std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
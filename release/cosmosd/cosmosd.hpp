@@ -0,0 +1,108 @@
+#ifndef COSMOS_RELEASE_COSMOSD
+#define COSMOS_RELEASE_COSMOSD
+
+#include <cosmos/evaluation/interpreter.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace cosmos::daemon {
+
+    // the workspace shared by every session. Readers take a snapshot
+    // with an atomic load and so never wait for writers. Writers
+    // evaluate against a snapshot and commit only if nobody else
+    // has committed since, and otherwise evaluate again.
+    class store {
+        struct version {
+            uint64_t Number;
+            work::space Space;
+        };
+
+        ptr<const version> Current;
+
+    public:
+        struct snapshot {
+            uint64_t Number;
+            work::space Space;
+        };
+
+        store(work::space w) : Current{std::make_shared<const version>(version{0, w})} {}
+
+        snapshot get() const {
+            ptr<const version> v = std::atomic_load(&Current);
+            return snapshot{v->Number, v->Space};
+        }
+
+        // false if another commit came first.
+        bool commit(const snapshot& base, work::space next) {
+            ptr<const version> expected = std::atomic_load(&Current);
+            if (expected->Number != base.Number) return false;
+            ptr<const version> v = std::make_shared<const version>(version{base.Number + 1, next});
+            return std::atomic_compare_exchange_strong(&Current, &expected, v);
+        }
+    };
+
+    // whether a script can change the workspace.
+    bool writes(const std::string& script);
+
+    // request latencies, kept for the most recent requests.
+    class latency {
+        constexpr static size_t size = 1 << 16;
+
+        vector<uint64_t> Samples;
+        uint64_t Count;
+        mutable std::mutex Mutex;
+
+    public:
+        latency() : Samples(size), Count{0}, Mutex{} {}
+
+        void add(std::chrono::nanoseconds);
+
+        // percentiles in microseconds.
+        std::string report() const;
+    };
+
+    // fixed set of threads taking jobs from a queue.
+    class pool {
+        vector<std::thread> Threads;
+        std::deque<std::function<void()>> Jobs;
+        std::mutex Mutex;
+        std::condition_variable Ready;
+        bool Done;
+
+        void work();
+
+    public:
+        pool(uint32 threads);
+        ~pool();
+
+        void submit(std::function<void()>);
+    };
+
+    struct session;
+
+    class server {
+        std::string Path;
+        int Listen;
+        int Wake[2];
+        store Store;
+        latency Latency;
+        pool Pool;
+
+        // answer one request.
+        std::string evaluate(session&, const std::string&);
+
+    public:
+        server(const std::string& path, uint32 threads, work::space w);
+        ~server();
+
+        // serve until the process is stopped.
+        void run();
+    };
+
+}
+
+#endif
@@ -1,40 +1,37 @@
-#include <cosmos/cosmos.hpp>
+#include "pow.hpp"
+#include <cosmos/sign.hpp>
+#include <cosmos/verify.hpp>
+#include <cosmos/fees.hpp>
+#include <cosmos/keyring.hpp>
+#include <cosmos/workspace.hpp>
+#include <cosmos/transaction_view.hpp>
+#include <cosmos/calibrate.hpp>
+#include <cosmos/base58.hpp>
 #include <data/encoding/ascii.hpp>
-#include <abstractions/script/pow.hpp>
-#include <abstractions/script/pay_to_address.hpp>
 #include <abstractions/pattern/pay_to_address.hpp>
 #include <abstractions/crypto/address.hpp>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <sstream>
 
 namespace cosmos::bitcoin {
     
     namespace pow {
             
-        class error : std::exception {
-            std::string Message;
-                
-        public:
-            error(std::string s) : Message{s} {}
-            
-            const char* what() const noexcept final override {
-                return Message.c_str();
-            }
-        };
-        
         // patterns recognized by this wallet (only one for now) 
         abstractions::pattern::pay_to_address<secret, pubkey, address, transaction> p2pkh{};
         
-        uint read_uint_dec(const std::string&);
-        
-        byte read_byte_dec(const std::string&);
-        
-        satoshi read_satoshi_amount(const std::string&);
-        
-        abstractions::work::uint24 read_uint24_dec(const std::string&);
-        
+        // the previous output is redeemed with the compressed pubkey, 
+        // so a key for an uncompressed one would not be able to sign. 
         inline const secret read_wif(const std::string& s) {
-            secret k{s};
+            keys::secret_bytes b{};
+            bool compressed;
+            if (!base58::read_wif(s, b, compressed)) throw error{"invalid wif"};
+            if (!compressed) throw error{"wif is for an uncompressed pubkey"};
+            secret k = keys::read_secret(b);
             if (!k.valid()) throw error{"invalid wif"};
+            return k;
         }
         
         using ascii = data::encoding::ascii::string;
@@ -45,10 +42,28 @@ namespace cosmos::bitcoin {
             return z;
         }
         
+        // a fee in satoshis, or in satoshis per byte if followed by "/b". 
+        inline const fees::fee read_fee(const std::string& s) {
+            const std::string per_byte = "/b";
+            if (s.size() > per_byte.size() && s.compare(s.size() - per_byte.size(), per_byte.size(), per_byte) == 0) {
+                double r;
+                try {
+                    r = std::stod(s.substr(0, s.size() - per_byte.size()));
+                } catch (const std::exception&) {
+                    throw error{"invalid fee rate"};
+                }
+                
+                if (!(r >= 0)) throw error{"invalid fee rate"};
+                return fees::fee{0, r};
+            }
+            
+            return fees::fee{read_satoshi_amount(s)};
+        }
+        
         inline const address read_address(const std::string& s) {
-            address a{s};
-            if (!a.valid()) throw error{"invalid address"};
-            return a;
+            keys::hash160 h{};
+            if (!base58::read_address(s, h)) throw error{"invalid address"};
+            return keys::read_address(h);
         }
     
         inline const address read_address_from_script(const bytes& b) {
@@ -57,52 +72,80 @@ namespace cosmos::bitcoin {
             return p.Address;
         }
         
-        inline const work::target read_target(
-            const std::string& exponent,
-            const std::string& value) {
-            return work::target{read_byte_dec(exponent), read_uint24_dec(value)};
+        inline digest_bytes write_digest(const digest& d) {
+            digest_bytes b{};
+            std::copy(d.begin(), d.end(), b.begin());
+            return b;
         }
         
-        inline const script pow_lock(work::message m, work::target t) {
-            return abstractions::script::lock_by_pow(m, t)->compile();
+        inline const script pow_lock(const digest& d, work::target t) {
+            return script{pow_locks()(t, write_digest(d))};
         }
         
         inline const output pow_lock_output(
             satoshi s, 
-            work::message m, 
+            const digest& d, 
             work::target t) {
-            return output{s, pow_lock(m, t)};
+            return output{s, pow_lock(d, t)};
         }
         
         inline const output pay_to_address_output(satoshi s, address a) {
-            return output{s, abstractions::script::pay_to(a)->compile()};
+            return output{s, script{pay_to_addresses()(0, keys::write(a))}};
         }   
         
+        inline const sign::input redeem(const spendable& o, const keyring::entry& k) {
+            utxo::outpoint p{};
+            std::copy(o.Spendable.Reference.Reference.begin(), o.Spendable.Reference.Reference.end(), p.Txid.begin());
+            p.Index = o.Spendable.Reference.Index;
+            const bytes& script = o.Spendable.Output.ScriptPubKey;
+            return sign::input{p, o.Spendable.Output.Value, script, 0xffffffff, k.Secret, k.Pubkey};
+        }
+        
+        inline const sign::output write_output(const output& o) {
+            const bytes& script = o.ScriptPubKey;
+            return sign::output{o.Value, script};
+        }
+        
         const transaction main(
             const list<spendable> outputs, 
             const ascii data, 
             const satoshi spend, 
             const work::target target, 
             const address change, 
-            const satoshi fee);
-        /*{
-            list<spendable> to_be_redeemed{};
+            const fees::fee fee) {
+            // each key's pubkey and address are computed once, 
+            // however many outputs it redeems. 
+            keyring ring{};
+            for (spendable o : outputs) ring = ring.add(o.Spendable.Key);
+            
+            vector<sign::input> to_be_redeemed{};
             satoshi redeemed_value = 0;
             for (spendable o : outputs) {
                 if (!o.valid()) throw error{"invalid reference to previous tx"};
-                address address = read_address_from_script(o.Spendable.Output.ScriptPubKey);
-                if (!address.valid()) throw error{"invalid output script"};
-                if (address != address{o.Spendable.Key}) throw error{"cannot redeem address with key"};
-                to_be_redeemed = to_be_redeemed + o.Spendable;
+                address a = read_address_from_script(o.Spendable.Output.ScriptPubKey);
+                if (!a.valid()) throw error{"invalid output script"};
+                ptr<const keyring::entry> k = ring.find(a);
+                if (k == nullptr || keys::write(k->Secret) != keys::write(o.Spendable.Key)) throw error{"cannot redeem address with key"};
+                to_be_redeemed.push_back(redeem(o, *k));
                 redeemed_value += o.Spendable.Output.Value;
             }
             
-            return redeem({p2pkh},
-                vertex{to_be_redeemed, {
-                    abstractions::bitcoin::op_return{bytes(data)},
-                    pow_lock_output(spend, abstractions::work::reference(hash(data)), target), 
-                    pay_to_address_output(redeemed_value - fee, change)}});
-        }*/
+            if (redeemed_value < spend) throw error{"insufficient funds"};
+            
+            sign::transaction t{1, to_be_redeemed, {
+                write_output(abstractions::bitcoin::op_return{bytes(data)}),
+                write_output(pow_lock_output(spend, hash(data), target)), 
+                write_output(pay_to_address_output(0, change))}, 0};
+            
+            // the size is known before signing, so the fee and 
+            // the change are set first and we sign only once. 
+            uint64_t paid;
+            if (!fees::balance(t, fee, paid)) throw error{"insufficient funds"};
+            
+            // every input is signed at once, sharing the parts
+            // of the signature hash common to all of them. 
+            return transaction{sign::sign(t)};
+        }
 
         class program {
             list<spendable> Previous;
@@ -110,7 +153,7 @@ namespace cosmos::bitcoin {
             satoshi Spend;
             work::target Target;
             address Change;
-            satoshi Fee; 
+            fees::fee Fee; 
             
             program(
                 transaction tx, 
@@ -120,7 +163,7 @@ namespace cosmos::bitcoin {
                 satoshi s, 
                 work::target t, 
                 address c, 
-                satoshi f) : Previous{{tx, r, k}}, Data{d}, Target{t}, Change{c}, Fee{f} {}
+                fees::fee f) : Previous{{tx, r, k}}, Data{d}, Spend{s}, Target{t}, Change{c}, Fee{f} {}
         
         public:
             // Transform intput into constructed types.
@@ -130,7 +173,7 @@ namespace cosmos::bitcoin {
                 if (!p.valid()) throw error{"transaction is not valid"};
                 return program{p, outpoint{p.id(), read_uint_dec(input[1])}, 
                     read_wif(input[2]), read_ascii(input[3]), read_satoshi_amount(input[4]), 
-                    read_target(input[5], input[6]), read_address(input[7]), read_satoshi_amount(input[8])};
+                    read_target(input[5], input[6]), read_address(input[7]), read_fee(input[8])};
             }
             
             bool valid() const {
@@ -140,15 +183,25 @@ namespace cosmos::bitcoin {
             const bitcoin::transaction operator()() const {
                 const bitcoin::transaction tx{pow::main(Previous, Data, Spend, Target, Change, Fee)};
                 if (!tx.valid()) throw error{"invalid tx was produced"};
+                const bytes& serialized = tx;
+                transaction_view v = transaction_view::read(serialized);
+                if (!v.valid() || v.inputs() != Previous.size()) throw error{"invalid tx was produced"};
+                vector<verify::previous> previous{};
+                for (spendable x : Previous) previous.push_back(verify::previous{x.Spendable.Output.Value, x.Spendable.Output.ScriptPubKey});
+                
+                // pay-to-address redemptions are checked directly 
+                // and everything else by the script machine. 
+                const verify::transaction fast{v, previous};
                 auto p = Previous;
-                auto i = bitcoin::transaction::representation{tx}.Inputs;
                 uint n = 0;
                 while(!p.empty()) {
                     bitcoin::output o = p.first().Spendable.Output;
-                    if (!bitcoin::machine{tx, n, o.Value}.run(o.ScriptPubKey, i.first().ScriptSignature))
-                        throw error{"redemption script not valid"};
+                    wire::slice script = v.get_input(n).Script;
+                    verify::result r = fast.input(n);
+                    if (r == verify::unknown) 
+                        r = bitcoin::machine{tx, n, o.Value}.run(o.ScriptPubKey, bytes(script.Begin, script.End)) ? verify::accept : verify::reject;
+                    if (r != verify::accept) throw error{"redemption script not valid"};
                     p = p.rest();
-                    i = i.rest();
                     n++;
                 }
                 
@@ -160,6 +213,48 @@ namespace cosmos::bitcoin {
     
     }
 
+    namespace pow {
+        
+        inline calibrate::compact read_compact(const std::string& exponent, const std::string& value) {
+            uint v = read_uint_dec(value);
+            if (v >= 0x800000) throw error{"target value must be less than 2^23"};
+            calibrate::compact t{read_byte_dec(exponent), v};
+            if (!t.valid()) throw error{"invalid target"};
+            return t;
+        }
+        
+        // pow calibrate                          measure the hash rate of this machine. 
+        // pow calibrate <exponent> <value> ...   how long the target takes to meet. 
+        // pow calibrate time <seconds> ...       the target that takes that long. 
+        // Any further arguments are other hash rates to show. 
+        std::string calibration(const vector<std::string>& args) {
+            const calibrate::measurement m = calibrate::measure(std::chrono::seconds{2});
+            vector<double> rates{m.rate()};
+            
+            std::stringstream out;
+            out << m.Threads << " threads: " << calibrate::rate(m.rate()) << " double SHA-256\n";
+            
+            size_t extra = args.size() >= 2 ? 2 : 0;
+            for (size_t i = extra; i < args.size(); i++) rates.push_back(std::stod(args[i]));
+            
+            if (args.empty()) {
+                for (double t : {60., 3600., 86400., 30 * 86400.}) {
+                    out << "to take " << calibrate::duration(t) << ", ";
+                    calibrate::write(out, calibrate::for_time(t, m.rate()), rates);
+                }
+            } else if (args[0] == "time") {
+                if (args.size() < 2) throw error{"time in seconds required"};
+                calibrate::write(out, calibrate::for_time(std::stod(args[1]), m.rate()), rates);
+            } else {
+                if (args.size() < 2) throw error{"target exponent and value required"};
+                calibrate::write(out, read_compact(args[0], args[1]), rates);
+            }
+            
+            return out.str();
+        }
+        
+    }
+    
     const list<std::string> read_input(int argc, char* argv[]) noexcept {
         list<std::string> l{};
         for (int i = 0; i < argc; i++) l = l + std::string(argv[i]);
@@ -170,8 +265,28 @@ namespace cosmos::bitcoin {
 
 namespace cosmos {
 
+    // modes of pow other than making a transaction, by name, which
+    // are given the rest of the arguments. The benchmarks of the
+    // parts of pow are in bench.
+    using mode = std::function<std::string(const vector<std::string>&)>;
+    
+    const std::map<std::string, mode>& modes() {
+        static const std::map<std::string, mode> Modes{
+            {"calibrate", bitcoin::pow::calibration}};
+        return Modes;
+    }
+
     string run(const list<std::string> input) noexcept {
         try {
+            if (input.size() > 1) {
+                auto m = modes().find(input[1]);
+                if (m != modes().end()) {
+                    vector<std::string> args{};
+                    for (uint i = 2; i < input.size(); i++) args.push_back(input[i]);
+                    return m->second(args);
+                }
+            }
+            
             return data::encoding::hex::write(bitcoin::pow::program::make(input)());
         } catch (std::exception& e) {
             return e.what();
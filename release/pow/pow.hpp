@@ -0,0 +1,69 @@
+#ifndef COSMOS_RELEASE_POW
+#define COSMOS_RELEASE_POW
+
+#include <cosmos/cosmos.hpp>
+#include <cosmos/keys.hpp>
+#include <cosmos/templates.hpp>
+#include <abstractions/script/pow.hpp>
+#include <abstractions/script/pay_to_address.hpp>
+
+// what pow and the benchmarks of its parts have in common.
+namespace cosmos::bitcoin {
+    
+    namespace pow {
+            
+        class error : public std::exception {
+            std::string Message;
+                
+        public:
+            error(std::string s) : Message{s} {}
+            
+            const char* what() const noexcept final override {
+                return Message.c_str();
+            }
+        };
+        
+        uint read_uint_dec(const std::string&);
+        
+        byte read_byte_dec(const std::string&);
+        
+        satoshi read_satoshi_amount(const std::string&);
+        
+        abstractions::work::uint24 read_uint24_dec(const std::string&);
+        
+        inline const work::target read_target(
+            const std::string& exponent,
+            const std::string& value) {
+            return work::target{read_byte_dec(exponent), read_uint24_dec(value)};
+        }
+        
+        // Output scripts are compiled once for each shape and then
+        // patched with the digest or address; see templates.hpp. 
+        using digest_bytes = std::array<byte, 32>;
+        
+        inline bytes compile_pow_lock(const work::target& t, const digest_bytes& b) {
+            digest d{};
+            std::copy(b.begin(), b.end(), d.begin());
+            return abstractions::script::lock_by_pow(abstractions::work::reference(d), t)->compile();
+        }
+        
+        inline bytes compile_pay_to(const byte&, const keys::hash160& h) {
+            return abstractions::script::pay_to(keys::read_address(h))->compile();
+        }
+        
+        inline templates::cache<work::target, 32>& pow_locks() {
+            static templates::cache<work::target, 32> Cache{compile_pow_lock};
+            return Cache;
+        }
+        
+        // every pay-to-address script has the same shape. 
+        inline templates::cache<byte, 20>& pay_to_addresses() {
+            static templates::cache<byte, 20> Cache{compile_pay_to, 1};
+            return Cache;
+        }
+        
+    }
+    
+}
+
+#endif
@@ -0,0 +1,101 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/accounting.hpp>
+#include <cosmos/workspace.hpp>
+#include <iomanip>
+
+namespace cosmos::accounting {
+
+    namespace {
+
+        counter Counters[kinds];
+
+        // a node of the persistent map: two children, a
+        // colour and the entry, allocated in its own block.
+        constexpr size_t map_node = 3 * sizeof(void*) + sizeof(cosmos::name) + sizeof(ptr<work::item>);
+
+        // the control block of a shared_ptr made without make_shared.
+        constexpr size_t control_block = 2 * sizeof(long) + 2 * sizeof(void*);
+
+        // names longer than the small string buffer are on the heap.
+        size_t name_bytes(const cosmos::name& n) {
+            return n.capacity() > 15 ? n.capacity() + 1 : 0;
+        }
+
+        void measure(const work::space& s, footprint& f) {
+            for (const auto& e : s.Contents) {
+                f.Overhead += map_node + name_bytes(e.Key);
+                if (e.Value == nullptr) continue;
+                f.Overhead += control_block;
+
+                kind k = e.Value->kind();
+                f.Items[k]++;
+                if (k == space) {
+                    f.Bytes[k] += sizeof(work::space);
+                    measure(static_cast<const work::space&>(*e.Value), f);
+                } else f.Bytes[k] += e.Value->size();
+            }
+        }
+
+    }
+
+    const char* name(kind k) {
+        switch (k) {
+            case space: return "space";
+            case atom: return "atom";
+            case output: return "output";
+            case outpoint: return "outpoint";
+            case input: return "input";
+            case transaction: return "transaction";
+            case wallet: return "wallet";
+            case keysource: return "keysource";
+            case watch: return "watch";
+            case state: return "state";
+            default: return "other";
+        }
+    }
+
+    counter& get(kind k) {
+        return Counters[k < kinds ? k : other];
+    }
+
+    usage read(kind k) {
+        const counter& c = get(k);
+        return usage{c.Live, c.Bytes, c.Peak, c.Allocations};
+    }
+
+    footprint measure(const work::space& s) {
+        footprint f{};
+        measure(s, f);
+
+        // the keys of the outermost space, which are
+        // not items and so are not counted with them.
+        f.Overhead += s.Keys.memory();
+        return f;
+    }
+
+    void write(ostream& o) {
+        o << "kind         live      bytes       peak  allocations\n";
+        for (uint32 k = 0; k < kinds; k++) {
+            usage u = read(kind(k));
+            if (u.Allocations == 0) continue;
+            o << std::left << std::setw(12) << name(kind(k)) << std::right
+                << std::setw(6) << u.Live << std::setw(11) << u.Bytes
+                << std::setw(11) << u.Peak << std::setw(13) << u.Allocations << "\n";
+        }
+    }
+
+    void write(ostream& o, const footprint& f) {
+        o << "kind        items      bytes\n";
+        for (uint32 k = 0; k < kinds; k++) {
+            if (f.Items[k] == 0) continue;
+            o << std::left << std::setw(12) << name(kind(k)) << std::right
+                << std::setw(6) << f.Items[k] << std::setw(11) << f.Bytes[k] << "\n";
+        }
+        o << std::left << std::setw(18) << "overhead" << std::right << std::setw(11) << f.Overhead << "\n";
+        o << std::left << std::setw(18) << "total" << std::right << std::setw(11) << f.total() << "\n";
+    }
+
+}
@@ -0,0 +1,237 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/base58.hpp>
+#include <cosmos/crypto/sha256.hpp>
+#include <cosmos/evaluation/parallel.hpp>
+#include <cstring>
+
+namespace cosmos::bitcoin::base58 {
+
+    namespace {
+
+        const char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+        constexpr size_t max_size = 64;
+        constexpr size_t max_limbs = max_size / 4;
+
+        // 58^5 is the largest power of 58 below 2^32.
+        constexpr uint64_t power[] = {1, 58, 3364, 195112, 11316496, 656356768};
+        constexpr uint64_t chunk = power[5];
+
+        struct digits {
+            int8_t Value[256];
+
+            constexpr digits() : Value{} {
+                for (int i = 0; i < 256; i++) Value[i] = -1;
+                for (int i = 0; i < 58; i++) Value[uint8_t(alphabet[i])] = int8_t(i);
+            }
+        };
+
+        constexpr digits table{};
+
+        // keys given to each task of the global workers.
+        constexpr size_t split = 4096;
+
+        template <typename in>
+        vector<std::string> batch(const vector<in>& x, std::string (*f)(const in&)) {
+            vector<std::string> out(x.size());
+
+            vector<std::function<uint32()>> jobs{};
+            for (size_t begin = 0; begin < x.size(); begin += split) jobs.push_back([&x, &out, f, begin]() -> uint32 {
+                for (size_t i = begin; i < std::min(x.size(), begin + split); i++) out[i] = f(x[i]);
+                return 0;
+            });
+
+            evaluation::parallel::map(evaluation::parallel::workers::global(), jobs);
+            return out;
+        }
+
+        std::string address(const keys::hash160& h) {
+            return write_address(h);
+        }
+
+        std::string wif(const keys::secret_bytes& k) {
+            return write_wif(k);
+        }
+
+    }
+
+    std::string encode(const byte* b, size_t n) {
+        if (n > max_size) throw std::invalid_argument{"too many bytes for base58"};
+
+        size_t zeros = 0;
+        while (zeros < n && b[zeros] == 0) zeros++;
+
+        // big-endian 32-bit limbs, with the first one padded.
+        uint32 limbs[max_limbs] = {};
+        const size_t size = (n + 3) / 4;
+        const size_t pad = size * 4 - n;
+        for (size_t i = 0; i < n; i++) {
+            size_t j = i + pad;
+            limbs[j / 4] |= uint32(b[i]) << (8 * (3 - j % 4));
+        }
+
+        // repeatedly divide by 58^5, least significant chunk first.
+        uint32 chunks[2 * max_limbs] = {};
+        size_t count = 0;
+        size_t first = 0;
+        while (first < size && limbs[first] == 0) first++;
+        while (first < size) {
+            uint64_t rem = 0;
+            for (size_t i = first; i < size; i++) {
+                uint64_t x = (rem << 32) | limbs[i];
+                limbs[i] = uint32(x / chunk);
+                rem = x % chunk;
+            }
+            chunks[count++] = uint32(rem);
+            while (first < size && limbs[first] == 0) first++;
+        }
+
+        char out[2 * max_size];
+        size_t length = 0;
+        for (size_t i = count; i-- > 0;) {
+            uint32 c = chunks[i];
+            for (int j = 4; j >= 0; j--) {
+                out[length + j] = alphabet[c % 58];
+                c /= 58;
+            }
+            length += 5;
+        }
+
+        // drop the zero digits at the front of the first chunk.
+        size_t skip = 0;
+        while (skip < length && out[skip] == '1') skip++;
+
+        std::string s(zeros, '1');
+        s.append(out + skip, length - skip);
+        return s;
+    }
+
+    bool decode(const std::string& s, byte* b, size_t n) {
+        if (n > max_size || s.size() > 2 * max_size) return false;
+
+        size_t ones = 0;
+        while (ones < s.size() && s[ones] == '1') ones++;
+
+        // little-endian 32-bit limbs.
+        uint32 limbs[max_limbs + 1] = {};
+        const size_t size = (n + 3) / 4;
+
+        size_t i = ones;
+        while (i < s.size()) {
+            size_t take = (s.size() - i) % 5;
+            if (take == 0) take = 5;
+
+            uint64_t value = 0;
+            for (size_t j = 0; j < take; j++, i++) {
+                int d = table.Value[uint8_t(s[i])];
+                if (d < 0) return false;
+                value = value * 58 + d;
+            }
+
+            uint64_t carry = value;
+            for (size_t k = 0; k < size; k++) {
+                uint64_t x = uint64_t(limbs[k]) * power[take] + carry;
+                limbs[k] = uint32(x);
+                carry = x >> 32;
+            }
+            if (carry != 0) return false;
+        }
+
+        // the padding above n bytes must be zero.
+        for (size_t k = n; k < size * 4; k++) if ((limbs[k / 4] >> (8 * (k % 4))) & 0xff) return false;
+
+        for (size_t k = 0; k < n; k++) b[n - 1 - k] = byte(limbs[k / 4] >> (8 * (k % 4)));
+
+        size_t zeros = 0;
+        while (zeros < n && b[zeros] == 0) zeros++;
+        return zeros == ones;
+    }
+
+    std::array<byte, 4> checksum(const byte* b, size_t n) {
+        using sha256 = crypto::sha256;
+        std::array<byte, 4> c{};
+        sha256::digest d{};
+
+        if (n <= 55) {
+            // one padded block for the payload and one for the digest.
+            std::array<byte, 64> block{};
+            std::memcpy(block.data(), b, n);
+            block[n] = 0x80;
+            uint64_t bits = uint64_t(n) * 8;
+            for (int i = 0; i < 8; i++) block[63 - i] = byte(bits >> (8 * i));
+
+            sha256::state s = sha256::initial;
+            sha256::compress(s, block.data(), 1);
+
+            block.fill(0);
+            for (int i = 0; i < 8; i++) for (int j = 0; j < 4; j++) block[4 * i + j] = byte(s[i] >> (24 - 8 * j));
+            block[32] = 0x80;
+            block[62] = 0x01;
+
+            sha256::state t = sha256::initial;
+            sha256::compress(t, block.data(), 1);
+            for (int j = 0; j < 4; j++) c[j] = byte(t[0] >> (24 - 8 * j));
+            return c;
+        }
+
+        d = sha256::hash256(b, n);
+        std::copy(d.begin(), d.begin() + 4, c.begin());
+        return c;
+    }
+
+    std::string write_address(const keys::hash160& h, byte version) {
+        std::array<byte, 25> b{};
+        b[0] = version;
+        std::copy(h.begin(), h.end(), b.begin() + 1);
+        std::array<byte, 4> c = checksum(b.data(), 21);
+        std::copy(c.begin(), c.end(), b.begin() + 21);
+        return encode(b.data(), b.size());
+    }
+
+    bool read_address(const std::string& s, keys::hash160& h, byte version) {
+        std::array<byte, 25> b{};
+        if (s.size() > 35 || !decode(s, b.data(), b.size()) || b[0] != version) return false;
+        if (checksum(b.data(), 21) != std::array<byte, 4>{{b[21], b[22], b[23], b[24]}}) return false;
+        std::copy(b.begin() + 1, b.begin() + 21, h.begin());
+        return true;
+    }
+
+    std::string write_wif(const keys::secret_bytes& k, bool compressed, byte version) {
+        std::array<byte, 38> b{};
+        b[0] = version;
+        std::copy(k.begin(), k.end(), b.begin() + 1);
+        size_t n = 33;
+        if (compressed) b[n++] = 0x01;
+        std::array<byte, 4> c = checksum(b.data(), n);
+        std::copy(c.begin(), c.end(), b.begin() + n);
+        return encode(b.data(), n + 4);
+    }
+
+    bool read_wif(const std::string& s, keys::secret_bytes& k, bool& compressed, byte version) {
+        std::array<byte, 38> b{};
+        for (size_t n : {38, 37}) {
+            if (!decode(s, b.data(), n) || b[0] != version) continue;
+            size_t payload = n - 4;
+            if (n == 38 && b[33] != 0x01) continue;
+            if (checksum(b.data(), payload) != std::array<byte, 4>{{b[payload], b[payload + 1], b[payload + 2], b[payload + 3]}})
+                continue;
+            std::copy(b.begin() + 1, b.begin() + 33, k.begin());
+            compressed = n == 38;
+            return true;
+        }
+
+        return false;
+    }
+
+    vector<std::string> write_addresses(const vector<keys::hash160>& x) {
+        return batch(x, &address);
+    }
+
+    vector<std::string> write_wifs(const vector<keys::secret_bytes>& x) {
+        return batch(x, &wif);
+    }
+
+}
@@ -0,0 +1,143 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/bip32.hpp>
+#include <cosmos/secp256k1.hpp>
+#include <cosmos/precompute.hpp>
+#include <cosmos/evaluation/parallel.hpp>
+
+namespace cosmos::bitcoin::bip32 {
+
+    namespace {
+
+        using secp256k1::order;
+
+        // children per task when deriving in parallel.
+        constexpr uint32 task = 64;
+
+    }
+
+    parent::parent(const extended& x) : Key{x}, Keyed{x.ChainCode} {
+        Keyed.update(x.Pubkey);
+    }
+
+    bool parent::child(uint32 index, extended& x) const {
+        if (index >= hardened) return false;
+
+        const std::array<byte, 4> i{{byte(index >> 24), byte(index >> 16), byte(index >> 8), byte(index)}};
+        crypto::sha512::digest I = crypto::hmac<crypto::sha512>{Keyed}.update(i).finish();
+
+        keys::secret_bytes left{};
+        std::copy(I.begin(), I.begin() + 32, left.begin());
+        if (!(left < order) || std::all_of(left.begin(), left.end(), [](byte b) -> bool { return b == 0; })) return false;
+
+        keys::pubkey_bytes a = keys::write(precompute::to_public(keys::read_secret(left)));
+
+        // a + K is the point at infinity.
+        if (a == keys::negate(Key.Pubkey)) return false;
+
+        x.Pubkey = keys::write(keys::read_pubkey(a) + keys::read_pubkey(Key.Pubkey));
+        std::copy(I.begin() + 32, I.end(), x.ChainCode.begin());
+        return true;
+    }
+
+    vector<keys::pubkey_bytes> parent::children(uint32 first, uint32 count) const {
+        vector<keys::pubkey_bytes> pubkeys(count);
+
+        vector<std::function<uint32()>> jobs{};
+        for (uint32 begin = 0; begin < count; begin += task) jobs.push_back([this, &pubkeys, first, count, begin]() -> uint32 {
+            extended x{};
+            for (uint32 i = begin; i < std::min(count, begin + task); i++)
+                if (child(first + i, x)) pubkeys[i] = x.Pubkey;
+            return 0;
+        });
+
+        evaluation::parallel::map(evaluation::parallel::workers::global(), jobs);
+        return pubkeys;
+    }
+
+    void chain::extend(uint32 n) {
+        // until we or someone else has derived as far as n.
+        while (true) {
+            uint32 first;
+            {
+                std::lock_guard<std::mutex> lock{Mutex};
+                if (Pubkeys.size() >= n) return;
+                first = Pubkeys.size();
+            }
+
+            derive(first, n);
+        }
+    }
+
+    void chain::derive(uint32 first, uint32 n) {
+        // The lock is not held while deriving, since the workers may run
+        // other tasks that read this chain while we wait for them.
+        const uint32 count = ((n - first + Batch - 1) / Batch) * Batch;
+        vector<keys::pubkey_bytes> pubkeys = Parent.children(first, count);
+
+        // the addresses are hashed in parallel as well.
+        vector<keys::hash160> addresses(count);
+        vector<std::function<uint32()>> jobs{};
+        for (uint32 begin = 0; begin < count; begin += task) jobs.push_back([&pubkeys, &addresses, count, begin]() -> uint32 {
+            for (uint32 i = begin; i < std::min(count, begin + task); i++)
+                if (pubkeys[i][0] != 0) addresses[i] = keys::write(keys::read_pubkey(pubkeys[i]).address());
+            return 0;
+        });
+
+        evaluation::parallel::map(evaluation::parallel::workers::global(), jobs);
+
+        std::lock_guard<std::mutex> lock{Mutex};
+
+        // someone else may have got here first.
+        if (Pubkeys.size() != first) return;
+        Pubkeys.insert(Pubkeys.end(), pubkeys.begin(), pubkeys.end());
+        Addresses.insert(Addresses.end(), addresses.begin(), addresses.end());
+    }
+
+    size_t chain::derived() const {
+        std::lock_guard<std::mutex> lock{Mutex};
+        return Pubkeys.size();
+    }
+
+    bool chain::exists(uint32 i) {
+        extend(i + 1);
+        std::lock_guard<std::mutex> lock{Mutex};
+        return Pubkeys[i][0] != 0;
+    }
+
+    keys::pubkey_bytes chain::pubkey(uint32 i) {
+        extend(i + 1);
+        std::lock_guard<std::mutex> lock{Mutex};
+        return Pubkeys[i];
+    }
+
+    keys::hash160 chain::address(uint32 i) {
+        extend(i + 1);
+        std::lock_guard<std::mutex> lock{Mutex};
+        return Addresses[i];
+    }
+
+    uint32 chain::scan(const std::function<bool(const keys::hash160&)>& used, uint32 gap) {
+        uint32 next = 0;
+        for (uint32 i = 0; i < next + gap; i++) {
+            // a whole batch is derived at a time.
+            if (exists(i) && used(address(i))) next = i + 1;
+        }
+
+        return next;
+    }
+
+    uint32 chain::scan(const std::unordered_set<keys::hash160, utxo::hash>& used, uint32 gap) {
+        return scan([&used](const keys::hash160& a) -> bool {
+            return used.count(a) != 0;
+        }, gap);
+    }
+
+    size_t chain::memory() const {
+        std::lock_guard<std::mutex> lock{Mutex};
+        return Pubkeys.capacity() * sizeof(keys::pubkey_bytes) + Addresses.capacity() * sizeof(keys::hash160);
+    }
+
+}
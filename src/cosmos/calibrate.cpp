@@ -0,0 +1,179 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/calibrate.hpp>
+#include <cosmos/crypto/sha256.hpp>
+#include <cosmos/evaluation/parallel.hpp>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+
+namespace cosmos::bitcoin::calibrate {
+
+    namespace {
+
+        // a padded block holding the last 16 bytes of an 80-byte message.
+        std::array<byte, 64> tail() {
+            std::array<byte, 64> b{};
+            b[16] = 0x80;
+            b[62] = 0x02;
+            b[63] = 0x80;
+            return b;
+        }
+
+        // a padded block holding a 32-byte digest.
+        std::array<byte, 64> second() {
+            std::array<byte, 64> b{};
+            b[32] = 0x80;
+            b[62] = 0x01;
+            return b;
+        }
+
+        void hashes(uint32 seed, std::chrono::steady_clock::time_point end, std::atomic<uint64_t>& count) {
+            using sha256 = crypto::sha256;
+
+            std::array<byte, 64> first{};
+            first[0] = byte(seed);
+            sha256::state midstate = sha256::initial;
+            sha256::compress(midstate, first.data(), 1);
+
+            std::array<byte, 64> last = tail();
+            std::array<byte, 64> outer = second();
+
+            // the nonce is in the last 4 bytes of the message.
+            uint64_t n = 0;
+            byte check = 0;
+            while (std::chrono::steady_clock::now() < end) {
+                for (uint32 i = 0; i < 1024; i++, n++) {
+                    last[12] = byte(n);
+                    last[13] = byte(n >> 8);
+                    last[14] = byte(n >> 16);
+                    last[15] = byte(n >> 24);
+
+                    sha256::state s = midstate;
+                    sha256::compress(s, last.data(), 1);
+                    for (int j = 0; j < 8; j++) {
+                        outer[4 * j] = byte(s[j] >> 24);
+                        outer[4 * j + 1] = byte(s[j] >> 16);
+                        outer[4 * j + 2] = byte(s[j] >> 8);
+                        outer[4 * j + 3] = byte(s[j]);
+                    }
+
+                    sha256::state d = sha256::initial;
+                    sha256::compress(d, outer.data(), 1);
+                    check ^= byte(d[7]);
+                }
+            }
+
+            // keep the result so that the work is not optimized away.
+            volatile byte sink = check;
+            (void)sink;
+            count += n;
+        }
+
+        // the next easier and harder targets, or the same
+        // target if there is none.
+        compact easier(compact t) {
+            if (t.Value + 1 < 0x800000) return compact{t.Exponent, t.Value + 1};
+            if (t.Exponent < 32) return compact{byte(t.Exponent + 1), 0x8000};
+            return t;
+        }
+
+        compact harder(compact t) {
+            if (t.Value > 0x8000 || (t.Exponent == 3 && t.Value > 1)) return compact{t.Exponent, t.Value - 1};
+            if (t.Exponent > 3) return compact{byte(t.Exponent - 1), 0x7fffff};
+            return t;
+        }
+
+        std::string format(double x, int precision) {
+            std::stringstream ss;
+            ss << std::setprecision(precision) << x;
+            return ss.str();
+        }
+
+    }
+
+    double expected(compact t) {
+        return std::ldexp(1.0, 256) / (std::ldexp(double(t.Value), 8 * (int(t.Exponent) - 3)) + 1);
+    }
+
+    double difficulty(compact t) {
+        return expected(t) / expected(minimum);
+    }
+
+    compact for_hashes(double h) {
+        const compact hardest{3, 1};
+        const compact easiest{32, 0x7fffff};
+        if (!(h > expected(easiest))) return easiest;
+        if (h >= expected(hardest)) return hardest;
+
+        // the first exponent at which the value fits.
+        int e = 3;
+        double v = std::floor(std::ldexp(1 / h, 256));
+        while (v >= 0x800000 && e < 32) {
+            e++;
+            v = std::floor(std::ldexp(1 / h, 256 - 8 * (e - 3)));
+        }
+
+        // v is only close, so it may be off by one either way.
+        compact t{byte(e), uint32(std::min(std::max(v, 1.), double(0x7fffff)))};
+        while (expected(t) < h) t = harder(t);
+        for (compact x = easier(t); !(x == t) && expected(x) >= h; x = easier(t)) t = x;
+        return t;
+    }
+
+    measurement measure(std::chrono::milliseconds d, uint32 threads) {
+        // no more tasks than can run at once on the global workers.
+        evaluation::parallel::workers& w = evaluation::parallel::workers::global();
+        if (threads == 0 || threads > w.size()) threads = w.size();
+
+        std::atomic<uint64_t> count{0};
+
+        auto start = std::chrono::steady_clock::now();
+        const auto end = start + d;
+        vector<std::function<uint32()>> jobs{};
+        for (uint32 i = 0; i < threads; i++) jobs.push_back([i, end, &count]() -> uint32 {
+            hashes(i, end, count);
+            return 0;
+        });
+
+        evaluation::parallel::map(w, jobs);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return measurement{threads, count, elapsed.count()};
+    }
+
+    std::string duration(double s) {
+        struct unit {
+            const char* Name;
+            double Seconds;
+        };
+
+        const unit units[] = {
+            {"years", 365.25 * 86400}, {"days", 86400}, {"hours", 3600},
+            {"minutes", 60}, {"seconds", 1}, {"milliseconds", 1e-3}};
+
+        for (const unit& u : units) if (s >= u.Seconds) return format(s / u.Seconds, 3) + " " + u.Name;
+        return format(s * 1e6, 3) + " microseconds";
+    }
+
+    std::string rate(double r) {
+        const char* prefixes[] = {"", "k", "M", "G", "T", "P", "E"};
+        int i = 0;
+        while (r >= 1000 && i < 6) {
+            r /= 1000;
+            i++;
+        }
+
+        return format(r, 3) + " " + prefixes[i] + "H/s";
+    }
+
+    void write(ostream& o, compact t, const vector<double>& rates) {
+        o << "target " << int(t.Exponent) << " " << t.Value
+            << ": difficulty " << format(difficulty(t), 4)
+            << ", " << format(expected(t), 4) << " hashes expected\n";
+        for (double r : rates) o << "  at " << rate(r) << ": " << duration(seconds(t, r)) << "\n";
+    }
+
+}
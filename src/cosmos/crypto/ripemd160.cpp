@@ -0,0 +1,103 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/crypto/ripemd160.hpp>
+#include <cstring>
+
+namespace cosmos::crypto {
+
+    namespace {
+
+        // message word and rotation for each step, left line then right line.
+        constexpr uint8_t R[2][80] = {
+            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+             7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+             3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+             1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+             4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13},
+            {5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+             6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+             15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+             8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+             12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11}};
+
+        constexpr uint8_t S[2][80] = {
+            {11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+             7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+             11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+             11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+             9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6},
+            {8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+             9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+             9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+             15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+             8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11}};
+
+        constexpr uint32_t K[2][5] = {
+            {0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e},
+            {0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000}};
+
+        inline uint32_t rotl(uint32_t x, int n) {
+            return (x << n) | (x >> (32 - n));
+        }
+
+        // the round function of round j, which the right line takes in reverse.
+        inline uint32_t f(int j, uint32_t x, uint32_t y, uint32_t z) {
+            switch (j) {
+                case 0: return x ^ y ^ z;
+                case 1: return (x & y) | (~x & z);
+                case 2: return (x | ~y) ^ z;
+                case 3: return (x & z) | (y & ~z);
+                default: return x ^ (y | ~z);
+            }
+        }
+
+        void compress(uint32_t h[5], const uint8_t* b) {
+            uint32_t X[16];
+            for (int i = 0; i < 16; i++)
+                X[i] = uint32_t(b[4 * i]) | (uint32_t(b[4 * i + 1]) << 8) | (uint32_t(b[4 * i + 2]) << 16) | (uint32_t(b[4 * i + 3]) << 24);
+
+            uint32_t l[5] = {h[0], h[1], h[2], h[3], h[4]};
+            uint32_t r[5] = {h[0], h[1], h[2], h[3], h[4]};
+            for (int i = 0; i < 80; i++) {
+                const int j = i / 16;
+                uint32_t t = rotl(l[0] + f(j, l[1], l[2], l[3]) + X[R[0][i]] + K[0][j], S[0][i]) + l[4];
+                l[0] = l[4]; l[4] = l[3]; l[3] = rotl(l[2], 10); l[2] = l[1]; l[1] = t;
+
+                t = rotl(r[0] + f(4 - j, r[1], r[2], r[3]) + X[R[1][i]] + K[1][j], S[1][i]) + r[4];
+                r[0] = r[4]; r[4] = r[3]; r[3] = rotl(r[2], 10); r[2] = r[1]; r[1] = t;
+            }
+
+            const uint32_t t = h[1] + l[2] + r[3];
+            h[1] = h[2] + l[3] + r[4];
+            h[2] = h[3] + l[4] + r[0];
+            h[3] = h[4] + l[0] + r[1];
+            h[4] = h[0] + l[1] + r[2];
+            h[0] = t;
+        }
+
+    }
+
+    ripemd160::digest ripemd160::hash(const uint8_t* b, size_t n) {
+        uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64) compress(h, b + i);
+
+        // the rest, a one bit, zeros and the length in bits, little-endian.
+        uint8_t last[128]{};
+        const size_t rest = n - i;
+        std::memcpy(last, b + i, rest);
+        last[rest] = 0x80;
+        const size_t blocks = rest + 9 <= 64 ? 1 : 2;
+        const uint64_t bits = uint64_t(n) * 8;
+        for (int k = 0; k < 8; k++) last[64 * blocks - 8 + k] = uint8_t(bits >> (8 * k));
+        for (size_t k = 0; k < blocks; k++) compress(h, last + 64 * k);
+
+        digest d{};
+        for (int k = 0; k < 5; k++) for (int j = 0; j < 4; j++) d[4 * k + j] = uint8_t(h[k] >> (8 * j));
+        return d;
+    }
+
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/crypto/sha256.hpp>
+#include <cstring>
+
+namespace cosmos::crypto {
+
+    constexpr sha256::state sha256::initial;
+
+    namespace {
+
+        constexpr uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+        inline uint32_t rotr(uint32_t x, int n) {
+            return (x >> n) | (x << (32 - n));
+        }
+
+        inline uint32_t read_be(const uint8_t* b) {
+            return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | uint32_t(b[3]);
+        }
+
+        inline void write_be(uint8_t* b, uint32_t x) {
+            b[0] = x >> 24;
+            b[1] = x >> 16;
+            b[2] = x >> 8;
+            b[3] = x;
+        }
+
+    }
+
+    void sha256::compress(state& s, const uint8_t* blocks, size_t count) {
+        uint32_t w[64];
+        for (; count > 0; count--, blocks += 64) {
+            for (int i = 0; i < 16; i++) w[i] = read_be(blocks + 4 * i);
+            for (int i = 16; i < 64; i++) {
+                uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+            for (int i = 0; i < 64; i++) {
+                uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+
+            s[0] += a;
+            s[1] += b;
+            s[2] += c;
+            s[3] += d;
+            s[4] += e;
+            s[5] += f;
+            s[6] += g;
+            s[7] += h;
+        }
+    }
+
+    sha256& sha256::update(const uint8_t* b, size_t n) {
+        size_t used = Length % 64;
+        Length += n;
+
+        if (used > 0) {
+            size_t fill = 64 - used;
+            if (n < fill) {
+                std::memcpy(Buffer.data() + used, b, n);
+                return *this;
+            }
+
+            std::memcpy(Buffer.data() + used, b, fill);
+            compress(State, Buffer.data(), 1);
+            b += fill;
+            n -= fill;
+        }
+
+        compress(State, b, n / 64);
+        b += n - n % 64;
+        n %= 64;
+        std::memcpy(Buffer.data(), b, n);
+        return *this;
+    }
+
+    sha256::digest sha256::finish() {
+        uint64_t bits = Length * 8;
+        uint8_t pad[72] = {0x80};
+        size_t used = Length % 64;
+        size_t padding = (used < 56 ? 56 : 120) - used;
+        for (int i = 0; i < 8; i++) pad[padding + i] = uint8_t(bits >> (56 - 8 * i));
+        update(pad, padding + 8);
+
+        digest d;
+        for (int i = 0; i < 8; i++) write_be(d.data() + 4 * i, State[i]);
+        return d;
+    }
+
+}
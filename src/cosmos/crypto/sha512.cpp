@@ -0,0 +1,124 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/crypto/sha512.hpp>
+#include <cstring>
+
+namespace cosmos::crypto {
+
+    constexpr sha512::state sha512::initial;
+
+    namespace {
+
+        constexpr uint64_t K[80] = {
+            0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc, 0x3956c25bf348b538,
+            0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242, 0x12835b0145706fbe,
+            0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2, 0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
+            0xc19bf174cf692694, 0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+            0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5, 0x983e5152ee66dfab,
+            0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4, 0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+            0x06ca6351e003826f, 0x142929670a0e6e70, 0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed,
+            0x53380d139d95b3df, 0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+            0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30, 0xd192e819d6ef5218,
+            0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8, 0x19a4c116b8d2d0c8, 0x1e376c085141ab53,
+            0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8, 0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373,
+            0x682e6ff3d6b2b8a3, 0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+            0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b, 0xca273eceea26619c,
+            0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178, 0x06f067aa72176fba, 0x0a637dc5a2c898a6,
+            0x113f9804bef90dae, 0x1b710b35131c471b, 0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
+            0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817};
+
+        inline uint64_t rotr(uint64_t x, int n) {
+            return (x >> n) | (x << (64 - n));
+        }
+
+        inline uint64_t read_be(const uint8_t* b) {
+            uint64_t x = 0;
+            for (int i = 0; i < 8; i++) x = (x << 8) | b[i];
+            return x;
+        }
+
+        inline void write_be(uint8_t* b, uint64_t x) {
+            for (int i = 7; i >= 0; i--) {
+                b[i] = uint8_t(x);
+                x >>= 8;
+            }
+        }
+
+    }
+
+    void sha512::compress(state& s, const uint8_t* blocks, size_t count) {
+        uint64_t w[80];
+        for (; count > 0; count--, blocks += 128) {
+            for (int i = 0; i < 16; i++) w[i] = read_be(blocks + 8 * i);
+            for (int i = 16; i < 80; i++) {
+                uint64_t s0 = rotr(w[i - 15], 1) ^ rotr(w[i - 15], 8) ^ (w[i - 15] >> 7);
+                uint64_t s1 = rotr(w[i - 2], 19) ^ rotr(w[i - 2], 61) ^ (w[i - 2] >> 6);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint64_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+            for (int i = 0; i < 80; i++) {
+                uint64_t t1 = h + (rotr(e, 14) ^ rotr(e, 18) ^ rotr(e, 41)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                uint64_t t2 = (rotr(a, 28) ^ rotr(a, 34) ^ rotr(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+
+            s[0] += a;
+            s[1] += b;
+            s[2] += c;
+            s[3] += d;
+            s[4] += e;
+            s[5] += f;
+            s[6] += g;
+            s[7] += h;
+        }
+    }
+
+    sha512& sha512::update(const uint8_t* b, size_t n) {
+        size_t used = Length % 128;
+        Length += n;
+
+        if (used > 0) {
+            size_t fill = 128 - used;
+            if (n < fill) {
+                std::memcpy(Buffer.data() + used, b, n);
+                return *this;
+            }
+
+            std::memcpy(Buffer.data() + used, b, fill);
+            compress(State, Buffer.data(), 1);
+            b += fill;
+            n -= fill;
+        }
+
+        compress(State, b, n / 128);
+        b += n - n % 128;
+        n %= 128;
+        std::memcpy(Buffer.data(), b, n);
+        return *this;
+    }
+
+    sha512::digest sha512::finish() {
+        // the length is 128 bits, of which we only use the low 64.
+        uint64_t bits = Length * 8;
+        uint8_t pad[144] = {0x80};
+        size_t used = Length % 128;
+        size_t padding = (used < 112 ? 112 : 240) - used;
+        for (int i = 0; i < 8; i++) pad[padding + 8 + i] = uint8_t(bits >> (56 - 8 * i));
+        update(pad, padding + 16);
+
+        digest d;
+        for (int i = 0; i < 8; i++) write_be(d.data() + 8 * i, State[i]);
+        return d;
+    }
+
+}
@@ -0,0 +1,144 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/async.hpp>
+#include <cosmos/evaluation/transaction.hpp>
+
+namespace cosmos::evaluation::async {
+
+    namespace {
+
+        // one statement between being submitted and being answered.
+        struct statement : std::enable_shared_from_this<statement> {
+            loop& Loop;
+            backend& Backend;
+            parallel::workers& Workers;
+            const work::space Workspace;
+            frame Frame;
+
+            statement(loop& l, backend& b, parallel::workers& w, const work::space s) :
+                Loop{l}, Backend{b}, Workers{w}, Workspace{s}, Frame{} {}
+
+            // evaluate on the workers and come back to the loop.
+            template <typename X>
+            void offload(std::function<X()> f, callback<X> then) {
+                ptr<statement> self = shared_from_this();
+                Workers.push([self, f, then]() {
+                    X x = [&]() -> X {
+                        frame::scope s{&self->Frame};
+                        return f();
+                    }();
+                    self->Loop.post([then, x]() {
+                        then(x);
+                    });
+                });
+            }
+
+            // Fetch the data for every application in e that waits,
+            // innermost first since their arguments may need it. w is
+            // the workspace e will be evaluated against.
+            void fetch(ptr<expression> e, const work::space w, std::function<void()> done) {
+                const expression::compound* c = dynamic_cast<const expression::compound*>(e.get());
+                if (c == nullptr || !e->waits()) return done();
+
+                vector<ptr<expression>> ps{};
+                for (ptr<expression> p : c->Parameters) ps.push_back(p);
+
+                ptr<statement> self = shared_from_this();
+                fetch(ps, 0, w, [self, e, c, w, done]() {
+                    std::optional<cosmos::function> f = e->applies();
+                    if (!f || !cosmos::waits(*f)) return done();
+
+                    // the arguments as the function will see them.
+                    const expression::parameters ps = c->Parameters;
+                    self->offload<arguments>([ps, w]() -> arguments {
+                        arguments args{};
+                        for (const response& r : evaluation::arguments(w, ps).Responses) args.push_back(r.Return);
+                        return args;
+                    }, [self, f, done](arguments args) {
+                        self->Backend.fetch(*f, args, [self, f, args, done](ptr<work::item> x) {
+                            self->Frame.put(*f, args, x);
+                            done();
+                        });
+                    });
+                });
+            }
+
+            // Fetch for the parameters from the i-th on. As in evaluation,
+            // a run of those that do not write is fetched at the same time
+            // against w, and the ones after a writer see what it wrote,
+            // which is found by evaluating it once what it needs is in
+            // the frame.
+            void fetch(const vector<ptr<expression>>& ps, size_t i, const work::space w, std::function<void()> done) {
+                size_t j = i;
+                while (j < ps.size() && !ps[j]->writes()) j++;
+
+                ptr<statement> self = shared_from_this();
+                auto writer = [self, ps, j, w, done]() {
+                    if (j == ps.size()) return done();
+                    ptr<expression> e = ps[j];
+                    self->fetch(e, w, [self, ps, j, w, e, done]() {
+                        if (std::none_of(ps.begin() + j + 1, ps.end(), [](ptr<expression> p) -> bool { return p->waits(); }))
+                            return done();
+
+                        self->offload<work::space>([e, w]() -> work::space {
+                            response r = evaluation::evaluate(w, e);
+                            return r.error() ? w : r.Result;
+                        }, [self, ps, j, done](work::space x) {
+                            self->fetch(ps, j + 1, x, done);
+                        });
+                    });
+                };
+
+                vector<ptr<expression>> waiting{};
+                for (size_t k = i; k < j; k++) if (ps[k]->waits()) waiting.push_back(ps[k]);
+                if (waiting.empty()) return writer();
+
+                ptr<size_t> remaining = std::make_shared<size_t>(waiting.size());
+                for (ptr<expression> p : waiting) fetch(p, w, [remaining, writer]() {
+                    if (--*remaining == 0) writer();
+                });
+            }
+
+        };
+
+    }
+
+    void executor::evaluate(const work::space w, ptr<expression> e, callback<response> done) {
+        ptr<statement> s = std::make_shared<statement>(Loop, Backend, Workers, w);
+        s->fetch(e, w, [s, e, done]() {
+            const work::space w = s->Workspace;
+            s->offload<response>([w, e]() -> response {
+                return evaluation::statement(w, e);
+            }, done);
+        });
+    }
+
+    void executor::submit(uint64_t id, ptr<expression> e, callback<response> done) {
+        Sessions[id].Queue.emplace_back(e, done);
+        if (!Sessions[id].Busy) next(id);
+    }
+
+    void executor::next(uint64_t id) {
+        auto i = Sessions.find(id);
+        if (i == Sessions.end()) return;
+        session& s = i->second;
+        if (s.Queue.empty()) {
+            s.Busy = false;
+            return;
+        }
+
+        s.Busy = true;
+        auto x = s.Queue.front();
+        s.Queue.pop_front();
+
+        evaluate(s.Workspace, x.first, [this, id, done = x.second](response r) {
+            auto i = Sessions.find(id);
+            if (i != Sessions.end()) i->second.Workspace = r.Result;
+            done(r);
+            next(id);
+        });
+    }
+
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/frame.hpp>
+#include <typeinfo>
+
+namespace cosmos::evaluation::async {
+
+    namespace {
+
+        thread_local const frame* Current = nullptr;
+
+    }
+
+    // Items of different types can be written the same way, such as
+    // a transaction and the string of its hex, so each argument is
+    // keyed by its type as well as by how it is written.
+    std::string frame::key(cosmos::function f, const arguments& args) {
+        stringstream ss{};
+        ss << int(f);
+        for (const ptr<work::item>& a : args) {
+            ss << ";";
+            if (a == nullptr) continue;
+            const work::item& x = *a;
+            ss << typeid(x).name() << ":";
+            x.express()->write(ss);
+        }
+        return ss.str();
+    }
+
+    void frame::put(cosmos::function f, const arguments& args, ptr<work::item> x) {
+        std::lock_guard<std::mutex> lock{Mutex};
+        Data[key(f, args)] = x;
+    }
+
+    bool frame::get(cosmos::function f, const arguments& args, ptr<work::item>& x) const {
+        std::lock_guard<std::mutex> lock{Mutex};
+        auto i = Data.find(key(f, args));
+        if (i == Data.end()) return false;
+        x = i->second;
+        return true;
+    }
+
+    const frame* frame::current() {
+        return Current;
+    }
+
+    frame::scope::scope(const frame* f) : Previous{Current} {
+        Current = f;
+    }
+
+    frame::scope::~scope() {
+        Current = Previous;
+    }
+
+}
@@ -0,0 +1,345 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/interpreter.hpp>
+#include <cosmos/evaluation/transaction.hpp>
+#include <cosmos/parser.hpp>
+#include <cosmos/crypto/sha512.hpp>
+
+namespace cosmos::work {
+
+    // what evaluation may do to a workspace.
+    struct operation {
+        static space set(const space& w, name n, ptr<item> i) {
+            return w.set(n, i);
+        }
+
+        static space index(const space& w, ptr<item> i) {
+            return w.index(i);
+        }
+    };
+
+}
+
+namespace cosmos::evaluation {
+
+    error error::unrecognized_name(name n) {
+        return error{"unrecognized name $" + std::string{n}};
+    }
+
+    error error::format() {
+        return error{"format error"};
+    }
+
+    namespace {
+
+        template <typename X>
+        ptr<work::item> make(X x) {
+            return std::make_shared<work::atom<X>>(x);
+        }
+
+        template <typename X>
+        const X* get(const ptr<work::item>& i) {
+            const work::atom<X>* a = dynamic_cast<const work::atom<X>*>(i.get());
+            return a == nullptr ? nullptr : &a->Atom;
+        }
+
+        template <size_t n>
+        std::string hex(const std::array<byte, n>& d) {
+            constexpr char digits[] = "0123456789abcdef";
+            std::string x{};
+            for (byte b : d) {
+                x.push_back(digits[b >> 4]);
+                x.push_back(digits[b & 15]);
+            }
+            return x;
+        }
+
+        response invalid(const work::space w, cosmos::function f) {
+            return response{w, error{std::string{"invalid arguments to "} + token::word(f)}};
+        }
+
+        // Functions that wait take what was fetched for them before the
+        // statement was evaluated, from the statement's frame. They never
+        // block; without a frame or with nothing fetched they fail.
+        response fetched(const work::space w, cosmos::function f, const vector<ptr<work::item>>& args) {
+            const async::frame* fr = async::frame::current();
+            ptr<work::item> x{};
+            if (fr == nullptr || !fr->get(f, args, x))
+                return response{w, error{std::string{token::word(f)} + " needs data which is not in the workspace"}};
+            if (x == nullptr) return response{w};
+
+            // a wallet is updated with the changes fetched for it.
+            if (f == cosmos::update && args.size() == 1)
+                if (const work::wallet* a = dynamic_cast<const work::wallet*>(args[0].get()))
+                    if (const work::changes* c = dynamic_cast<const work::changes*>(x.get()))
+                        return response{w, a->update(*c)};
+
+            // keys in what was fetched are indexed like keys which are set.
+            return response{work::operation::index(w, x), x};
+        }
+
+        // apply a function to arguments that have been evaluated.
+        response call(const work::space w, cosmos::function f, const vector<ptr<work::item>>& args) {
+            if (f == cosmos::stats) return args.empty() ? evaluation::stats(w) : invalid(w, f);
+            if (cosmos::waits(f)) return fetched(w, f, args);
+            if (args.size() != 1) return invalid(w, f);
+            const ptr<work::item>& x = args[0];
+
+            switch (f) {
+                case cosmos::identity:
+                    return response{w, x};
+
+                case cosmos::SHA256:
+                    if (const std::string* s = get<std::string>(x)) return response{w, make(hex(crypto::sha256::hash(*s)))};
+                    return invalid(w, f);
+
+                case cosmos::SHA512:
+                    if (const std::string* s = get<std::string>(x)) return response{w, make(hex(crypto::sha512::hash(*s)))};
+                    return invalid(w, f);
+
+                case cosmos::address:
+                    if (const bitcoin::pubkey* p = get<bitcoin::pubkey>(x)) return response{w, make(p->address())};
+                    if (const bitcoin::secret* s = get<bitcoin::secret>(x))
+                        return response{w, make(s->to_public().address())};
+                    return invalid(w, f);
+
+                case cosmos::public_key:
+                    if (const bitcoin::secret* s = get<bitcoin::secret>(x))
+                        return response{w, make(s->to_public())};
+                    return invalid(w, f);
+
+                case cosmos::next_address:
+                    if (const work::keysource* k = dynamic_cast<const work::keysource*>(x.get()); k != nullptr && k->valid())
+                        return response{w, make(k->next_address())};
+                    return invalid(w, f);
+
+                default:
+                    return response{w, error{"unknown function"}};
+            }
+        }
+
+        // the arguments of a sequence once they have all been evaluated.
+        bool collect(const parallel::results<response>& r, vector<ptr<work::item>>& args, error& e) {
+            for (const response& x : r.Responses) {
+                if (x.error()) {
+                    e = x.Error;
+                    return false;
+                }
+
+                args.push_back(x.Return);
+            }
+
+            return true;
+        }
+
+        expression::parameters last_first(const expression::parameters& p) {
+            expression::parameters s{};
+            for (ptr<expression> e : p) s = s.prepend(e);
+            return s;
+        }
+
+        cosmos::list<ptr<work::item>> ordered(const vector<ptr<work::item>>& v) {
+            cosmos::list<ptr<work::item>> l{};
+            for (auto i = v.rbegin(); i != v.rend(); i++) l = l.prepend(*i);
+            return l;
+        }
+
+        const expression::parameters& parameters(const ptr<expression>& e) {
+            return static_cast<const expression::compound&>(*e).Parameters;
+        }
+
+        response lookup(const work::space w, const name& n) {
+            ptr<work::item> i = w.get(n);
+            if (i == nullptr) return response{w, error::unrecognized_name(n)};
+            return response{w, i};
+        }
+
+        // the parser only puts a name on the left of set.
+        response assign(const work::space w, const expression::parameters& p, memo* m) {
+            vector<ptr<expression>> x{};
+            for (ptr<expression> e : p) x.push_back(e);
+
+            const expression::atomic<name>* n = x.size() == 2 ? dynamic_cast<const expression::atomic<name>*>(x[0].get()) : nullptr;
+            if (n == nullptr) return response{w, error::format()};
+
+            response r = evaluate(w, x[1], m);
+            if (r.error()) return response{w, r.Error};
+            return response{work::operation::set(r.Result, n->Atom, r.Return), r.Return};
+        }
+
+        // operands are evaluated together and then folded from the left.
+        response fold(const work::space w, op o, const expression::parameters& p, memo* m) {
+            parallel::results<response> r = arguments(w, p, m);
+            vector<ptr<work::item>> x{};
+            error e{};
+            if (!collect(r, x, e)) return response{w, e};
+            if (x.empty()) return response{w, error::format()};
+
+            ptr<work::item> total = x[0];
+            for (size_t i = 1; i < x.size(); i++) {
+                response y = operate(r.Workspace, o, total, x[i]);
+                if (y.error()) return response{w, y.Error};
+                total = y.Return;
+            }
+
+            return response{r.Workspace, total};
+        }
+
+    }
+
+    response operate(const work::space w, op o, ptr<work::item> a, ptr<work::item> b) {
+        if (const number* x = get<number>(a)) if (const number* y = get<number>(b)) {
+            if (o == cosmos::plus) return response{w, make(cosmos::operation<number, cosmos::plus, number>{}(*x, *y))};
+            if (o == cosmos::times) return response{w, make(cosmos::operation<number, cosmos::times, number>{}(*x, *y))};
+        }
+
+        if (const bitcoin::secret* x = get<bitcoin::secret>(a)) if (const bitcoin::secret* y = get<bitcoin::secret>(b)) {
+            if (o == cosmos::plus) return response{w, make(cosmos::operation<bitcoin::secret, cosmos::plus, bitcoin::secret>{}(*x, *y))};
+            if (o == cosmos::times) return response{w, make(cosmos::operation<bitcoin::secret, cosmos::times, bitcoin::secret>{}(*x, *y))};
+        }
+
+        if (const bitcoin::pubkey* x = get<bitcoin::pubkey>(a)) {
+            if (const bitcoin::pubkey* y = get<bitcoin::pubkey>(b); y != nullptr && o == cosmos::plus)
+                return response{w, make(cosmos::operation<bitcoin::pubkey, cosmos::plus, bitcoin::pubkey>{}(*x, *y))};
+            if (const bitcoin::secret* y = get<bitcoin::secret>(b); y != nullptr && o == cosmos::times)
+                return response{w, make(cosmos::operation<bitcoin::pubkey, cosmos::times, bitcoin::secret>{}(*x, *y))};
+        }
+
+        if (const std::string* x = get<std::string>(a)) if (const std::string* y = get<std::string>(b))
+            if (o == cosmos::concat) return response{w, make(*x + *y)};
+
+        return response{w, error{"invalid operation"}};
+    }
+
+    ptr<close> operand::read_name(name n) const {
+        response r = lookup(Workspace, n);
+        if (r.error()) return std::make_shared<value>(r, Stack);
+        return std::make_shared<value>(operate(Workspace, Operator, Left, r.Return), Stack);
+    }
+
+    expression::parameters sequence::parameters() const {
+        return last_first(Sequence);
+    }
+
+    response function::apply() const {
+        parallel::results<response> r = evaluated();
+        vector<ptr<work::item>> args{};
+        error e{};
+        if (!collect(r, args, e)) return response{Workspace, e};
+        return call(r.Workspace, Function, args);
+    }
+
+    response function::apply(memo& m) const {
+        parallel::results<response> r = evaluated(&m);
+        vector<ptr<work::item>> args{};
+        error e{};
+        if (!collect(r, args, e)) return response{Workspace, e};
+
+        // errors are returned as they are and never remembered.
+        response computed{};
+        bool missed = false;
+        ptr<work::item> x = m.apply(Function, ordered(args), [&]() -> ptr<work::item> {
+            computed = call(r.Workspace, Function, args);
+            missed = true;
+            return computed.error() ? nullptr : computed.Return;
+        });
+
+        if (missed) return computed;
+        return response{r.Workspace, x};
+    }
+
+    response construction::construct(memo* m) const {
+        parallel::results<response> r = evaluated(m);
+        vector<ptr<work::item>> args{};
+        error e{};
+        if (!collect(r, args, e)) return response{Workspace, e};
+
+        // A new wallet has no outputs, which are added by update. The
+        // other constructors are not evaluated yet; their items come
+        // only from functions such as spend and from what is fetched.
+        if (Constructor == cosmos::wallet && args.empty())
+            return response{r.Workspace, std::make_shared<work::wallet>()};
+
+        return response{Workspace, error{std::string{"cannot construct "} + token::word(Constructor) + " from these arguments"}};
+    }
+
+    parallel::results<response> arguments(const work::space w, expression::parameters p, memo* m) {
+        const async::frame* f = async::frame::current();
+        transaction* t = transaction::active();
+        return parallel::evaluate(parallel::workers::global(), w, p,
+            [m, f, t](const work::space w, ptr<expression> e) -> response {
+                async::frame::scope s{f};
+                transaction::scope x{e->writes() ? t : nullptr};
+                return evaluation::evaluate(w, e, m);
+            });
+    }
+
+    response evaluate(const work::space w, ptr<expression> e, memo* m) {
+        if (e == nullptr) return response{w, error::format()};
+
+        if (std::optional<cosmos::function> f = e->applies()) {
+            function x{*f, last_first(parameters(e)), w, {}};
+            return m == nullptr ? x.apply() : x.apply(*m);
+        }
+
+        if (std::optional<cosmos::constructor> c = e->constructs())
+            return construction{*c, last_first(parameters(e)), w, {}}.construct(m);
+
+        // a savepoint is opened at ( and closed at ).
+        if (const expression::parenthesis* x = dynamic_cast<const expression::parenthesis*>(e.get()))
+            return evaluation::parenthesis(w, x->inside(), m);
+
+        if (std::optional<op> o = e->operates())
+            return *o == cosmos::set ? assign(w, parameters(e), m) : fold(w, *o, parameters(e), m);
+
+        if (const expression::atomic<number>* x = dynamic_cast<const expression::atomic<number>*>(e.get()))
+            return response{w, make(x->Atom)};
+
+        if (const expression::atomic<std::string>* x = dynamic_cast<const expression::atomic<std::string>*>(e.get()))
+            return response{w, make(x->Atom)};
+
+        if (const expression::atomic<name>* x = dynamic_cast<const expression::atomic<name>*>(e.get()))
+            return lookup(w, x->Atom);
+
+        return response{w, error{"a list is not a value"}};
+    }
+
+}
+
+namespace cosmos {
+
+    namespace {
+
+        evaluation::response evaluate(const work::space w, stringstream& s, evaluation::memo* m) {
+            expression::parameters p{};
+            try {
+                p = parse::program(s);
+            } catch (const parse::error& x) {
+                return evaluation::response{w, evaluation::error{x.what()}};
+            }
+
+            // each statement is a transaction, so one that
+            // fails leaves the workspace from the one before.
+            evaluation::response r{w};
+            for (ptr<expression> e : p) {
+                if (m != nullptr) e = m->intern(e);
+                r = evaluation::statement(r.Result, e, m);
+                if (r.error()) return r;
+            }
+
+            return r;
+        }
+
+    }
+
+    evaluation::response evaluate(const work::space w, stringstream& s) {
+        return evaluate(w, s, nullptr);
+    }
+
+    evaluation::response evaluate(const work::space w, stringstream& s, evaluation::memo& m) {
+        return evaluate(w, s, &m);
+    }
+
+}
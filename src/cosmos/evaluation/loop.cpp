@@ -0,0 +1,118 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/loop.hpp>
+#include <cstring>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace cosmos::evaluation {
+
+    loop::loop() : Epoll{::epoll_create1(EPOLL_CLOEXEC)}, Wake{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+        Mutex{}, Posted{}, Timers{}, Order{0}, Watched{}, Stopped{false} {
+        if (Epoll < 0 || Wake < 0) throw std::runtime_error{std::string{"cannot make event loop: "} + std::strerror(errno)};
+        epoll_event e{};
+        e.events = EPOLLIN;
+        e.data.fd = Wake;
+        ::epoll_ctl(Epoll, EPOLL_CTL_ADD, Wake, &e);
+    }
+
+    loop::~loop() {
+        ::close(Wake);
+        ::close(Epoll);
+    }
+
+    void loop::post(std::function<void()> f) {
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            Posted.push_back(std::move(f));
+        }
+
+        uint64_t one = 1;
+        ::write(Wake, &one, sizeof(one));
+    }
+
+    void loop::after(std::chrono::microseconds d, std::function<void()> f) {
+        Timers.push(timer{clock::now() + d, Order++, std::move(f)});
+    }
+
+    void loop::watch(int fd, uint32 events, std::function<void(uint32)> f) {
+        epoll_event e{};
+        e.events = events;
+        e.data.fd = fd;
+        int op = Watched.count(fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        if (::epoll_ctl(Epoll, op, fd, &e) != 0)
+            throw std::runtime_error{std::string{"cannot watch descriptor: "} + std::strerror(errno)};
+        Watched[fd] = std::move(f);
+    }
+
+    void loop::unwatch(int fd) {
+        ::epoll_ctl(Epoll, EPOLL_CTL_DEL, fd, nullptr);
+        Watched.erase(fd);
+    }
+
+    void loop::stop() {
+        Stopped = true;
+        uint64_t one = 1;
+        ::write(Wake, &one, sizeof(one));
+    }
+
+    void loop::run_posted() {
+        std::deque<std::function<void()>> ready{};
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            ready.swap(Posted);
+        }
+
+        for (auto& f : ready) f();
+    }
+
+    void loop::run_timers() {
+        const clock::time_point now = clock::now();
+        while (!Timers.empty() && Timers.top().When <= now) {
+            std::function<void()> f = Timers.top().Call;
+            Timers.pop();
+            f();
+        }
+    }
+
+    void loop::run() {
+        constexpr int batch = 64;
+        epoll_event events[batch];
+
+        while (!Stopped) {
+            int timeout = -1;
+            if (!Timers.empty()) {
+                auto wait = std::chrono::duration_cast<std::chrono::microseconds>(Timers.top().When - clock::now());
+                // round up so that we do not wake just before a timer is due.
+                timeout = wait.count() <= 0 ? 0 : int((wait.count() + 999) / 1000);
+            }
+
+            int n = ::epoll_wait(Epoll, events, batch, timeout);
+            if (n < 0 && errno != EINTR) throw std::runtime_error{std::string{"epoll: "} + std::strerror(errno)};
+
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == Wake) {
+                    uint64_t x;
+                    ::read(Wake, &x, sizeof(x));
+                    continue;
+                }
+
+                auto w = Watched.find(fd);
+                if (w != Watched.end()) {
+                    // the callback may unwatch itself.
+                    std::function<void(uint32)> f = w->second;
+                    f(events[i].events);
+                }
+            }
+
+            run_posted();
+            run_timers();
+        }
+    }
+
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/memo.hpp>
+
+namespace cosmos::evaluation {
+
+    memo::digest memo::hash(const expression& e) {
+        stringstream ss;
+        e.write(ss);
+        return crypto::sha256::hash(ss.str());
+    }
+
+    memo::digest memo::hash(cosmos::list<ptr<work::item>> args) {
+        // each argument is hashed separately so that the
+        // boundaries between arguments are unambiguous. Items of
+        // different types can be written the same way, such as a
+        // transaction and the string of its hex, so the type of
+        // each goes in too.
+        crypto::sha256 h{};
+        for (ptr<work::item> i : args) {
+            const work::item& x = *i;
+            h.update(crypto::sha256::hash(std::string{typeid(x).name()}));
+            h.update(hash(*x.express()));
+        }
+        return h.finish();
+    }
+
+    ptr<work::item> memo::find(const key& k) {
+        std::lock_guard<std::mutex> lock{Mutex};
+        auto i = Index.find(k);
+        if (i == Index.end()) {
+            Stats.Misses++;
+            return nullptr;
+        }
+
+        Stats.Hits++;
+        Results.splice(Results.begin(), Results, i->second);
+        return i->second->second;
+    }
+
+    void memo::insert(const key& k, ptr<work::item> r) {
+        std::lock_guard<std::mutex> lock{Mutex};
+        if (Index.count(k) != 0) return;
+        Results.emplace_front(k, r);
+        Index[k] = Results.begin();
+        if (Results.size() > Capacity) {
+            Index.erase(Results.back().first);
+            Results.pop_back();
+            Stats.Evictions++;
+        }
+    }
+
+    ptr<expression> memo::intern(ptr<expression> e) {
+        if (e == nullptr) return e;
+        digest d = hash(*e);
+
+        std::lock_guard<std::mutex> lock{Mutex};
+        auto i = Nodes.find(d);
+        if (i != Nodes.end()) {
+            ptr<expression> x = i->second.lock();
+            if (x != nullptr) {
+                Stats.Shared++;
+                return x;
+            }
+
+            i->second = e;
+            Stats.Interned++;
+            return e;
+        }
+
+        // drop nodes that nobody refers to any more before growing.
+        if (Nodes.size() >= Capacity)
+            for (auto j = Nodes.begin(); j != Nodes.end();)
+                if (j->second.expired()) j = Nodes.erase(j);
+                else j++;
+
+        Nodes[d] = e;
+        Stats.Interned++;
+        return e;
+    }
+
+    void memo::write(ostream& o) const {
+        statistics s = stats();
+        o << "memo: " << s.Hits << " hits, " << s.Misses << " misses ("
+            << s.rate() * 100 << "%), " << s.Evictions << " evictions, "
+            << s.Bypassed << " impure, " << s.Interned << " nodes interned, "
+            << s.Shared << " shared";
+    }
+
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/parallel.hpp>
+
+namespace cosmos::evaluation::parallel {
+
+    thread_local int workers::Self = -1;
+
+    workers::workers(uint32 threads) : Queues{}, Threads{}, Done{false}, Waiting{0}, Next{0}, Sleep{}, Wake{} {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32 i = 0; i < threads; i++) Queues.push_back(std::make_unique<queue>());
+        for (uint32 i = 0; i < threads; i++) Threads.emplace_back([this, i]() { work(i); });
+    }
+
+    workers::~workers() {
+        {
+            std::lock_guard<std::mutex> lock{Sleep};
+            Done = true;
+        }
+
+        Wake.notify_all();
+        for (std::thread& t : Threads) t.join();
+    }
+
+    void workers::push(std::function<void()> f) {
+        uint32 q = Self >= 0 ? uint32(Self) : Next++ % size();
+        {
+            std::lock_guard<std::mutex> lock{Queues[q]->Mutex};
+            Queues[q]->Tasks.push_back(std::move(f));
+        }
+
+        Waiting++;
+        {
+            std::lock_guard<std::mutex> lock{Sleep};
+        }
+
+        Wake.notify_one();
+    }
+
+    bool workers::run_one(uint32 home) {
+        std::function<void()> f{};
+        for (uint32 i = 0; i < size() && !f; i++) {
+            queue& q = *Queues[(home + i) % size()];
+            std::lock_guard<std::mutex> lock{q.Mutex};
+            if (q.Tasks.empty()) continue;
+
+            // our own tasks from the back, others' from the front.
+            if (i == 0) {
+                f = std::move(q.Tasks.back());
+                q.Tasks.pop_back();
+            } else {
+                f = std::move(q.Tasks.front());
+                q.Tasks.pop_front();
+            }
+        }
+
+        if (!f) return false;
+        Waiting--;
+        f();
+        return true;
+    }
+
+    void workers::work(uint32 i) {
+        Self = i;
+        while (true) {
+            if (run_one(i)) continue;
+            std::unique_lock<std::mutex> lock{Sleep};
+            Wake.wait(lock, [this]() -> bool { return Done || Waiting > 0; });
+            if (Done) return;
+        }
+    }
+
+    void workers::help(const std::function<bool()>& done) {
+        uint32 home = Self >= 0 ? uint32(Self) : 0;
+        while (!done()) if (!run_one(home)) std::this_thread::yield();
+    }
+
+    workers& workers::global() {
+        static workers w{0};
+        return w;
+    }
+
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/transaction.hpp>
+
+namespace cosmos::evaluation {
+
+    namespace {
+
+        thread_local transaction* Active = nullptr;
+
+    }
+
+    transaction::error::error(std::string s) : Message{s} {}
+
+    const char* transaction::error::what() const noexcept {
+        return Message.c_str();
+    }
+
+    void transaction::begin() {
+        Savepoints = Savepoints.prepend(Current);
+        Depth++;
+    }
+
+    void transaction::update(const work::space w) {
+        Current = w;
+    }
+
+    void transaction::commit() {
+        if (Depth == 0) throw error{"commit without a savepoint"};
+        Savepoints = Savepoints.rest();
+        Depth--;
+    }
+
+    void transaction::rollback() {
+        if (Depth == 0) throw error{"rollback without a savepoint"};
+        Current = Savepoints.first();
+        Savepoints = Savepoints.rest();
+        Depth--;
+    }
+
+    response transaction::finish(const response& r) {
+        if (r.error() || !r.valid()) {
+            rollback();
+            return response{Current, r.error() ? r.Error : evaluation::error{"invalid workspace"}};
+        }
+
+        update(r.Result);
+        commit();
+        return response{Current, r.Return};
+    }
+
+    response transaction::savepoint(const work::space w, ptr<expression> e, memo* m) {
+        update(w);
+        begin();
+        try {
+            return finish(evaluate(w, e, m));
+        } catch (const std::exception& x) {
+            return finish(response{w, evaluation::error{x.what()}});
+        }
+    }
+
+    transaction* transaction::active() {
+        return Active;
+    }
+
+    transaction::scope::scope(transaction* t) : Previous{Active} {
+        Active = t;
+    }
+
+    transaction::scope::~scope() {
+        Active = Previous;
+    }
+
+    response statement(const work::space w, ptr<expression> e, memo* m) {
+        transaction t{w};
+        transaction::scope s{&t};
+        return t.savepoint(w, e, m);
+    }
+
+    response parenthesis(const work::space w, ptr<expression> e, memo* m) {
+        if (transaction* t = transaction::active()) return t->savepoint(w, e, m);
+        return statement(w, e, m);
+    }
+
+}
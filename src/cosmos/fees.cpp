@@ -0,0 +1,73 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/fees.hpp>
+#include <cmath>
+
+namespace cosmos::bitcoin::fees {
+
+    size_t size(const vector<size_t>& inputs, const vector<size_t>& outputs) {
+        size_t s = 4 + varint(inputs.size()) + varint(outputs.size()) + 4;
+        for (size_t i : inputs) s += input(i);
+        for (size_t o : outputs) s += output(o);
+        return s;
+    }
+
+    size_t size(const sign::transaction& t) {
+        vector<size_t> outputs{};
+        for (const sign::output& o : t.Outputs) outputs.push_back(o.Script.size());
+        return size(vector<size_t>(t.Inputs.size(), pay_to_address_input_script()), outputs);
+    }
+
+    uint64_t fee::operator()(size_t size) const {
+        return Fixed + uint64_t(std::ceil(PerByte * size));
+    }
+
+    bool balance(sign::transaction& t, const fee& f, uint64_t& paid) {
+        if (t.Outputs.empty()) return false;
+
+        uint64_t in = 0;
+        for (const sign::input& i : t.Inputs) in += i.Value;
+
+        uint64_t out = 0;
+        for (size_t j = 0; j + 1 < t.Outputs.size(); j++) out += t.Outputs[j].Value;
+
+        paid = f(size(t));
+        if (in < out + paid) return false;
+
+        uint64_t change = in - out - paid;
+        if (change >= dust) {
+            t.Outputs.back().Value = change;
+            return true;
+        }
+
+        // without the change output everything left is fee, which
+        // is more than enough since the transaction is smaller.
+        t.Outputs.pop_back();
+        paid = in - out;
+        return true;
+    }
+
+    utxo::request request(const vector<sign::output>& outputs, const fee& f) {
+        vector<size_t> scripts{};
+        uint64_t value = 0;
+        for (const sign::output& o : outputs) {
+            scripts.push_back(o.Script.size());
+            value += o.Value;
+        }
+
+        const size_t one = input(pay_to_address_input_script());
+        const size_t change = output(pay_to_address_script);
+
+        // the fee for everything but the inputs.
+        const uint64_t base = f(size({}, scripts));
+
+        return utxo::request{
+            value + base,
+            uint64_t(std::ceil(f.PerByte * one)),
+            uint64_t(std::ceil(f.PerByte * (change + one))),
+            dust};
+    }
+
+}
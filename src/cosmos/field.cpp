@@ -0,0 +1,247 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/field.hpp>
+#include <cosmos/secp256k1.hpp>
+#include <cosmos/precompute.hpp>
+#include <cstdlib>
+#include <random>
+
+namespace cosmos::bitcoin::field {
+
+    namespace {
+
+        using secp256k1::order;
+        using secp256k1::prime;
+        using secp256k1::integer;
+
+        // lane i of an element from 32 big-endian bytes.
+        void read(const byte* b, uint64_t* e, uint32 i) {
+            for (uint32 j = 0; j < limbs; j++) e[j * lanes + i] = 0;
+            for (uint32 bit = 0; bit < 256; bit += 8) {
+                uint64_t x = b[31 - bit / 8];
+                e[(bit / 52) * lanes + i] |= (x << (bit % 52)) & mask;
+                if (bit % 52 > 44) e[(bit / 52 + 1) * lanes + i] |= x >> (52 - bit % 52);
+            }
+        }
+
+        // lane i of a normalized element, reduced below p.
+        void write(const uint64_t* e, uint32 i, byte* b) {
+            uint64_t l[limbs];
+            for (uint32 j = 0; j < limbs; j++) l[j] = e[j * lanes + i];
+
+            // 2^256 is 0x1000003d1 mod p. It is added to fold the
+            // bits above 256 and again to subtract p.
+            auto carry = [&l](uint64_t x) -> uint64_t {
+                l[0] += x;
+                for (uint32 j = 0; j < limbs - 1; j++) {
+                    l[j + 1] += l[j] >> 52;
+                    l[j] &= mask;
+                }
+                uint64_t top = l[limbs - 1] >> 48;
+                l[limbs - 1] &= 0xffffffffffff;
+                return top;
+            };
+
+            uint64_t top = carry(0);
+            if (carry(top * 0x1000003d1) != 0) carry(0x1000003d1);
+
+            if (l[4] == 0xffffffffffff && l[3] == mask && l[2] == mask && l[1] == mask && l[0] >= 0xffffefffffc2f)
+                carry(0x1000003d1);
+
+            for (uint32 bit = 0; bit < 256; bit += 8)
+                b[31 - bit / 8] = byte(((l[bit / 52] >> (bit % 52)) | (bit % 52 > 44 ? l[bit / 52 + 1] << (52 - bit % 52) : 0)) & 0xff);
+        }
+
+        // y for the x of a compressed pubkey, which must be valid.
+        keys::secret_bytes decompress(const keys::pubkey_bytes& p) {
+            keys::secret_bytes x{};
+            std::copy(p.begin() + 1, p.end(), x.begin());
+
+            integer P{prime};
+            integer y{x};
+            integer e{};
+            mpz_powm_ui(y.Value, y.Value, 3, P.Value);
+            mpz_add_ui(y.Value, y.Value, 7);
+
+            // p is 3 mod 4, so a square root is a power (p + 1) / 4.
+            mpz_add_ui(e.Value, P.Value, 1);
+            mpz_fdiv_q_2exp(e.Value, e.Value, 2);
+            mpz_powm(y.Value, y.Value, e.Value, P.Value);
+            if (mpz_odd_p(y.Value) != (p[0] & 1)) mpz_sub(y.Value, P.Value, y.Value);
+            return y.fixed<32>();
+        }
+
+        // a + b n mod the group order.
+        secret plus(const keys::secret_bytes& a, uint64_t b, uint64_t n) {
+            integer x{a};
+            integer N{order};
+            integer m{};
+            mpz_set_ui(m.Value, b);
+            mpz_mul_ui(m.Value, m.Value, n);
+            mpz_add(x.Value, x.Value, m.Value);
+            mpz_mod(x.Value, x.Value, N.Value);
+            return keys::read_secret(x.fixed<32>());
+        }
+
+        kernels get(backend b) {
+#ifdef COSMOS_IFMA
+            if (b == ifma) return ifma_kernels();
+#endif
+            return portable_kernels();
+        }
+
+    }
+
+    kernels portable_kernels() {
+        return arithmetic<emulated>::make();
+    }
+
+    const char* name(backend b) {
+        switch (b) {
+            case portable: return "portable";
+            case ifma: return "ifma";
+            default: return "unknown";
+        }
+    }
+
+    bool supported(backend b) {
+        if (b == portable) return true;
+#ifdef COSMOS_IFMA
+        if (b == ifma) return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma");
+#endif
+        return false;
+    }
+
+    backend best() {
+        const char* choice = std::getenv("COSMOS_FIELD");
+        if (choice != nullptr && std::string{choice} == "portable") return portable;
+        return supported(ifma) ? ifma : portable;
+    }
+
+    walk::walk(const secret& start, uint32 step, uint32 size, backend b) :
+        Kernels{get(supported(b) ? b : portable)}, Vectors{(std::max(size, 1u) + lanes - 1) / lanes},
+        X(Vectors * stride), Y(Vectors * stride), Scratch(Vectors * stride), Qx(stride), Qy(stride), Q{} {
+        const keys::secret_bytes s = keys::write(start);
+
+        vector<keys::pubkey_bytes> first(this->size());
+        for (uint32 i = 0; i < first.size(); i++) first[i] = keys::write(precompute::to_public(plus(s, step, i)));
+        read(first.data());
+
+        Q = keys::write(precompute::to_public(plus(keys::secret_bytes{}, step, this->size())));
+        const keys::secret_bytes qy = decompress(Q);
+        for (uint32 i = 0; i < lanes; i++) {
+            field::read(Q.data() + 1, Qx.data(), i);
+            field::read(qy.data(), Qy.data(), i);
+        }
+    }
+
+    void walk::read(const keys::pubkey_bytes* p) {
+        for (uint32 k = 0; k < size(); k++) {
+            const keys::secret_bytes y = decompress(p[k]);
+            field::read(p[k].data() + 1, X.data() + (k / lanes) * stride, k % lanes);
+            field::read(y.data(), Y.data() + (k / lanes) * stride, k % lanes);
+        }
+    }
+
+    void walk::write(keys::pubkey_bytes* p) const {
+        for (uint32 k = 0; k < size(); k++) {
+            keys::secret_bytes y{};
+            field::write(X.data() + (k / lanes) * stride, k % lanes, p[k].data() + 1);
+            field::write(Y.data() + (k / lanes) * stride, k % lanes, y.data());
+            p[k][0] = 0x02 | (y[31] & 1);
+        }
+    }
+
+    void walk::next(keys::pubkey_bytes* p) {
+        write(p);
+        if (Kernels.Add(X.data(), Y.data(), Vectors, Qx.data(), Qy.data(), Scratch.data())) return;
+
+        // Some point has the x of Q, which almost never happens,
+        // so the library adds them all instead.
+        vector<keys::pubkey_bytes> sums(size());
+        const pubkey q = keys::read_pubkey(Q);
+        for (uint32 k = 0; k < size(); k++) sums[k] = keys::write(keys::read_pubkey(p[k]) + q);
+        read(sums.data());
+    }
+
+    uint64_t check(backend b, uint32 count, uint64_t seed) {
+        if (!supported(b)) return 0;
+        const kernels k = get(b);
+        std::mt19937_64 random{seed};
+
+        integer P{prime};
+        integer x{};
+        integer y{};
+        integer z{};
+
+        uint64_t mismatches = 0;
+        vector<uint64_t> e(4 * stride);
+        uint64_t* A = e.data();
+        uint64_t* B = A + stride;
+        uint64_t* C = B + stride;
+        for (uint32 n = 0; n < count; n++) {
+            // random limbs, with some lanes at the largest normalized values
+            // and some that are multiples of p.
+            for (uint32 j = 0; j < 2 * stride; j++) A[j] = random() & mask;
+            if (n % 4 == 0) for (uint32 j = 0; j < limbs; j++) A[j * lanes] = B[j * lanes + 1] = mask;
+            if (n % 4 == 1) {
+                field::read(prime.data(), A, 2);
+                field::read(prime.data(), B, 3);
+            }
+
+            for (uint32 op = 0; op < 3; op++) {
+                if (op == 0) k.Mul(A, B, C);
+                else if (op == 1) k.Sub(A, B, C);
+                else k.Inv(A, C);
+
+                for (uint32 i = 0; i < lanes; i++) {
+                    // the limbs as one number.
+                    mpz_set_ui(x.Value, 0);
+                    mpz_set_ui(y.Value, 0);
+                    for (uint32 j = limbs; j-- > 0;) {
+                        mpz_mul_2exp(x.Value, x.Value, 52);
+                        mpz_add_ui(x.Value, x.Value, A[j * lanes + i]);
+                        mpz_mul_2exp(y.Value, y.Value, 52);
+                        mpz_add_ui(y.Value, y.Value, B[j * lanes + i]);
+                    }
+
+                    if (op == 0) mpz_mul(z.Value, x.Value, y.Value);
+                    else if (op == 1) mpz_sub(z.Value, x.Value, y.Value);
+                    else {
+                        mpz_mod(x.Value, x.Value, P.Value);
+                        if (mpz_sgn(x.Value) == 0) mpz_set_ui(z.Value, 0);
+                        else mpz_invert(z.Value, x.Value, P.Value);
+                    }
+                    mpz_mod(z.Value, z.Value, P.Value);
+
+                    keys::secret_bytes expected = z.fixed<32>();
+                    keys::secret_bytes got{};
+                    field::write(C, i, got.data());
+
+                    // the result must be normalized as well.
+                    bool normal = true;
+                    for (uint32 j = 0; j < limbs; j++) if (C[j * lanes + i] > mask) normal = false;
+                    if (!normal || got != expected) mismatches++;
+                }
+            }
+        }
+
+        // a walk against the library, from a random start.
+        keys::secret_bytes s{};
+        for (byte& c : s) c = byte(random());
+        s[0] &= 0x7f;
+        const uint32 step = uint32(random() % 1000) + 1;
+        walk w{keys::read_secret(s), step, 64, b};
+        vector<keys::pubkey_bytes> p(w.size());
+        for (uint32 batch = 0; batch < std::max(count / 64, 4u); batch++) {
+            w.next(p.data());
+            for (uint32 i = 0; i < p.size(); i++)
+                if (p[i] != keys::write(precompute::to_public(plus(s, step, batch * w.size() + i)))) mismatches++;
+        }
+
+        return mismatches;
+    }
+
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Built with -mavx512f -mavx512ifma, so nothing in here may be
+// called unless field::supported(field::ifma) is true.
+
+#include <cosmos/cosmos.hpp>
+#include <cosmos/field/lanes.hpp>
+#include <immintrin.h>
+
+namespace cosmos::bitcoin::field {
+
+    namespace {
+
+        struct ifma {
+            using vec = __m512i;
+
+            static vec load(const uint64_t* p) {
+                return _mm512_loadu_si512(p);
+            }
+
+            static void store(uint64_t* p, const vec& v) {
+                _mm512_storeu_si512(p, v);
+            }
+
+            static vec set(uint64_t x) {
+                return _mm512_set1_epi64(x);
+            }
+
+            static vec add(const vec& a, const vec& b) {
+                return _mm512_add_epi64(a, b);
+            }
+
+            static vec sub(const vec& a, const vec& b) {
+                return _mm512_sub_epi64(a, b);
+            }
+
+            static vec low(const vec& a) {
+                return _mm512_and_si512(a, _mm512_set1_epi64(mask));
+            }
+
+            static vec high(const vec& a) {
+                return _mm512_srli_epi64(a, 52);
+            }
+
+            static vec madd_low(const vec& c, const vec& a, const vec& b) {
+                return _mm512_madd52lo_epu64(c, a, b);
+            }
+
+            static vec madd_high(const vec& c, const vec& a, const vec& b) {
+                return _mm512_madd52hi_epu64(c, a, b);
+            }
+        };
+
+    }
+
+    kernels ifma_kernels() {
+        return arithmetic<ifma>::make();
+    }
+
+}
@@ -0,0 +1,438 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/http/client.hpp>
+#include <cosmos/crypto/sha256.hpp>
+#include <cosmos/evaluation/parallel.hpp>
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <cstring>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace cosmos::http {
+
+    url url::read(const std::string& s) {
+        const std::string scheme = "http://";
+        if (s.compare(0, scheme.size(), scheme) != 0) throw error{"only http urls are supported: " + s};
+
+        size_t begin = scheme.size();
+        size_t slash = s.find('/', begin);
+        std::string authority = s.substr(begin, slash == std::string::npos ? std::string::npos : slash - begin);
+        if (authority.empty()) throw error{"no host in url: " + s};
+
+        url u{authority, 80, slash == std::string::npos ? "/" : s.substr(slash)};
+        size_t colon = authority.rfind(':');
+        if (colon != std::string::npos) {
+            u.Host = authority.substr(0, colon);
+            try {
+                u.Port = uint16_t(std::stoul(authority.substr(colon + 1)));
+            } catch (...) {
+                throw error{"invalid port in url: " + s};
+            }
+        }
+
+        return u;
+    }
+
+    namespace {
+
+        std::string lower(std::string s) {
+            for (char& c : s) c = std::tolower(c);
+            return s;
+        }
+
+        std::string trim(const std::string& s) {
+            size_t b = s.find_first_not_of(" \t");
+            if (b == std::string::npos) return "";
+            return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+        }
+
+        std::string hex(const crypto::sha256::digest& d) {
+            static const char* digits = "0123456789abcdef";
+            std::string s{};
+            for (byte b : d) {
+                s += digits[b >> 4];
+                s += digits[b & 15];
+            }
+
+            return s;
+        }
+
+    }
+
+    class connection {
+        int Socket;
+        std::string Buffer;
+        std::chrono::milliseconds Timeout;
+        bool Open;
+
+        // A response that comes after we stop waiting for it would be
+        // read as the answer to the next request, so the connection
+        // cannot be used again.
+        void wait(short events) {
+            pollfd p{Socket, events, 0};
+            int r = ::poll(&p, 1, int(Timeout.count()));
+            if (r > 0) return;
+            Open = false;
+            if (r == 0) throw error{"timed out"};
+            throw error{std::string{"poll: "} + std::strerror(errno)};
+        }
+
+        // read more into the buffer. False on end of stream.
+        bool fill() {
+            char b[16384];
+            while (true) {
+                wait(POLLIN);
+                ssize_t n = ::recv(Socket, b, sizeof(b), 0);
+                if (n > 0) {
+                    Buffer.append(b, n);
+                    return true;
+                }
+
+                if (n == 0) {
+                    Open = false;
+                    return false;
+                }
+
+                if (errno != EAGAIN && errno != EINTR) {
+                    Open = false;
+                    throw error{std::string{"recv: "} + std::strerror(errno)};
+                }
+            }
+        }
+
+        std::string line(size_t& position) {
+            size_t end;
+            while ((end = Buffer.find("\r\n", position)) == std::string::npos)
+                if (!fill()) throw error{"connection closed"};
+            std::string l = Buffer.substr(position, end - position);
+            position = end + 2;
+            return l;
+        }
+
+        void need(size_t size) {
+            while (Buffer.size() < size) if (!fill()) throw error{"connection closed"};
+        }
+
+    public:
+        connection(const url& u, std::chrono::milliseconds timeout) : Socket{-1}, Buffer{}, Timeout{timeout}, Open{false} {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo* found = nullptr;
+            if (::getaddrinfo(u.Host.c_str(), std::to_string(u.Port).c_str(), &hints, &found) != 0 || found == nullptr)
+                throw error{"cannot resolve " + u.Host};
+
+            std::string problem = "cannot connect to " + u.origin();
+            for (addrinfo* a = found; a != nullptr; a = a->ai_next) {
+                int s = ::socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, a->ai_protocol);
+                if (s < 0) continue;
+
+                if (::connect(s, a->ai_addr, a->ai_addrlen) != 0 && errno != EINPROGRESS) {
+                    ::close(s);
+                    continue;
+                }
+
+                pollfd p{s, POLLOUT, 0};
+                int e = 0;
+                socklen_t len = sizeof(e);
+                if (::poll(&p, 1, int(timeout.count())) != 1 ||
+                    ::getsockopt(s, SOL_SOCKET, SO_ERROR, &e, &len) != 0 || e != 0) {
+                    ::close(s);
+                    continue;
+                }
+
+                int one = 1;
+                ::setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                Socket = s;
+                Open = true;
+                break;
+            }
+
+            ::freeaddrinfo(found);
+            if (!Open) throw error{problem};
+        }
+
+        ~connection() {
+            if (Socket >= 0) ::close(Socket);
+        }
+
+        bool open() const {
+            return Open;
+        }
+
+        void send(const std::string& s) {
+            size_t sent = 0;
+            while (sent < s.size()) {
+                wait(POLLOUT);
+                ssize_t n = ::send(Socket, s.data() + sent, s.size() - sent, MSG_NOSIGNAL);
+                if (n < 0) {
+                    if (errno == EAGAIN || errno == EINTR) continue;
+                    Open = false;
+                    throw error{std::string{"send: "} + std::strerror(errno)};
+                }
+
+                sent += n;
+            }
+        }
+
+        response receive() {
+            response r{0, {}, {}, false, {}};
+            size_t position = 0;
+
+            std::string status = line(position);
+            if (status.compare(0, 5, "HTTP/") != 0 || status.size() < 12) throw error{"invalid response"};
+            bool keep_alive = status.compare(0, 8, "HTTP/1.0") != 0;
+            r.Status = std::atoi(status.c_str() + 9);
+
+            for (std::string l = line(position); !l.empty(); l = line(position)) {
+                size_t colon = l.find(':');
+                if (colon == std::string::npos) continue;
+                r.Headers[lower(l.substr(0, colon))] = trim(l.substr(colon + 1));
+            }
+
+            std::string c = lower(r.header("connection"));
+            if (c == "close") keep_alive = false;
+            else if (c == "keep-alive") keep_alive = true;
+
+            bool empty = r.Status == 204 || r.Status == 304 || (r.Status >= 100 && r.Status < 200);
+            if (empty) {
+                // no body.
+            } else if (lower(r.header("transfer-encoding")).find("chunked") != std::string::npos) {
+                while (true) {
+                    size_t size = std::stoul(line(position), nullptr, 16);
+                    if (size == 0) break;
+                    need(position + size + 2);
+                    r.Body.append(Buffer, position, size);
+                    position += size + 2;
+                }
+
+                while (!line(position).empty()) {}
+            } else if (r.Headers.count("content-length") != 0) {
+                size_t size = std::stoul(r.header("content-length"));
+                need(position + size);
+                r.Body = Buffer.substr(position, size);
+                position += size;
+            } else {
+                // the body runs until the server closes the connection.
+                while (fill()) {}
+                r.Body = Buffer.substr(position);
+                position = Buffer.size();
+                keep_alive = false;
+            }
+
+            Buffer.erase(0, position);
+            if (!keep_alive) Open = false;
+            return r;
+        }
+    };
+
+    bool cache::get(const std::string& u, entry& e) const {
+        if (!enabled()) return false;
+        std::ifstream in{(Directory / hex(crypto::sha256::hash(u))).string(), std::ios::binary};
+        if (!in) return false;
+
+        std::string kind;
+        if (!std::getline(in, kind) || !std::getline(in, e.ETag)) return false;
+        e.Immutable = kind == "immutable";
+        e.Body.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+        return true;
+    }
+
+    void cache::put(const std::string& u, const entry& e) const {
+        if (!enabled()) return;
+        file::path p = Directory / hex(crypto::sha256::hash(u));
+        file::path tmp = p;
+        tmp += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            std::ofstream out{tmp.string(), std::ios::binary | std::ios::trunc};
+            if (!out) return;
+            out << (e.Immutable ? "immutable" : "etag") << "\n" << e.ETag << "\n" << e.Body;
+            if (!out) return;
+        }
+
+        boost::system::error_code ec;
+        boost::filesystem::rename(tmp, p, ec);
+    }
+
+    client::client(options o) : Options{o}, Cache{o.Cache}, Hosts{}, Mutex{}, Released{} {
+        if (Options.Connections == 0) Options.Connections = 1;
+        if (Options.Concurrency == 0) Options.Concurrency = 1;
+        if (Options.Pipeline == 0) Options.Pipeline = 1;
+        if (Cache.enabled()) boost::filesystem::create_directories(Options.Cache);
+    }
+
+    client::~client() {}
+
+    std::unique_ptr<connection> client::acquire(const url& u) {
+        {
+            std::unique_lock<std::mutex> lock{Mutex};
+            host& h = Hosts[u.origin()];
+            Released.wait(lock, [&h, this]() -> bool {
+                return !h.Idle.empty() || h.Open < Options.Connections;
+            });
+
+            if (!h.Idle.empty()) {
+                std::unique_ptr<connection> c = std::move(h.Idle.back());
+                h.Idle.pop_back();
+                return c;
+            }
+
+            h.Open++;
+        }
+
+        try {
+            return std::make_unique<connection>(u, Options.Timeout);
+        } catch (...) {
+            release(u, nullptr);
+            throw;
+        }
+    }
+
+    void client::release(const url& u, std::unique_ptr<connection> c) {
+        std::lock_guard<std::mutex> lock{Mutex};
+        host& h = Hosts[u.origin()];
+        if (c != nullptr && c->open()) h.Idle.push_back(std::move(c));
+        else h.Open--;
+        Released.notify_all();
+    }
+
+    bool client::immutable(const url& u) const {
+        for (const std::string& prefix : Options.Immutable)
+            if (u.Path.compare(0, prefix.size(), prefix) == 0) return true;
+        return false;
+    }
+
+    void client::pipeline(
+        const url& host,
+        const vector<std::pair<size_t, url>>& requests,
+        const vector<std::string>& urls,
+        vector<response>& responses) {
+
+        vector<std::pair<size_t, url>> remaining{};
+        std::map<size_t, cache::entry> cached{};
+        for (const auto& r : requests) {
+            cache::entry e;
+            if (Cache.get(urls[r.first], e)) {
+                if (e.Immutable) {
+                    responses[r.first] = response{200, {{"etag", e.ETag}}, e.Body, true, {}};
+                    continue;
+                }
+
+                cached[r.first] = e;
+            }
+
+            remaining.push_back(r);
+        }
+
+        // A connection may be closed by the server part way through a
+        // pipeline, as with Connection: close or HTTP/1.0, so what is
+        // left is sent again on a new one for as long as each try gets
+        // some responses. Two tries in a row with none is a failure,
+        // and what is left then gets the last error.
+        std::string error{"connection closed"};
+        for (int failures = 0; failures < 2 && !remaining.empty();) {
+            std::unique_ptr<connection> c{};
+            size_t done = 0;
+            try {
+                c = acquire(host);
+
+                std::string batch{};
+                for (const auto& r : remaining) {
+                    batch += "GET " + r.second.Path + " HTTP/1.1\r\nHost: " + r.second.Host + "\r\n";
+                    auto e = cached.find(r.first);
+                    if (e != cached.end() && !e->second.ETag.empty()) batch += "If-None-Match: " + e->second.ETag + "\r\n";
+                    batch += "\r\n";
+                }
+
+                c->send(batch);
+
+                for (; done < remaining.size(); done++) {
+                    size_t i = remaining[done].first;
+                    response x = c->receive();
+
+                    auto e = cached.find(i);
+                    if (x.Status == 304 && e != cached.end()) {
+                        x.Status = 200;
+                        x.Body = e->second.Body;
+                        x.Cached = true;
+                    } else if (x.Status == 200) {
+                        bool forever = immutable(remaining[done].second) ||
+                            lower(x.header("cache-control")).find("immutable") != std::string::npos;
+                        std::string tag = x.header("etag");
+                        if (forever || !tag.empty()) Cache.put(urls[i], cache::entry{tag, forever, x.Body});
+                    }
+
+                    responses[i] = std::move(x);
+
+                    if (!c->open() && done + 1 < remaining.size()) {
+                        done++;
+                        break;
+                    }
+                }
+            } catch (const std::exception& e) {
+                error = e.what();
+
+                // a connection that failed part way through
+                // a response is never given back to the pool.
+                if (c != nullptr) {
+                    c.reset();
+                    release(host, nullptr);
+                }
+            }
+
+            if (c != nullptr) release(host, std::move(c));
+            remaining.erase(remaining.begin(), remaining.begin() + done);
+            failures = done == 0 ? failures + 1 : 0;
+        }
+
+        for (const auto& r : remaining) responses[r.first].Error = error;
+    }
+
+    response client::get(const std::string& u) {
+        return get(vector<std::string>{u})[0];
+    }
+
+    vector<response> client::get(const vector<std::string>& urls) {
+        vector<response> responses(urls.size(), response{0, {}, {}, false, {}});
+
+        // group by host and cut into pipelines.
+        std::map<std::string, vector<std::pair<size_t, url>>> hosts{};
+        for (size_t i = 0; i < urls.size(); i++) {
+            try {
+                url u = url::read(urls[i]);
+                hosts[u.origin()].emplace_back(i, u);
+            } catch (const std::exception& e) {
+                responses[i].Error = e.what();
+            }
+        }
+
+        vector<vector<std::pair<size_t, url>>> jobs{};
+        for (auto& h : hosts)
+            for (size_t i = 0; i < h.second.size(); i += Options.Pipeline)
+                jobs.emplace_back(h.second.begin() + i,
+                    h.second.begin() + std::min<size_t>(i + Options.Pipeline, h.second.size()));
+
+        // no more pipelines at once than the concurrency allows.
+        std::atomic<size_t> next{0};
+        vector<std::function<uint32()>> work{};
+        for (size_t i = 0; i < std::min<size_t>(Options.Concurrency, jobs.size()); i++) work.push_back([&]() -> uint32 {
+            for (size_t j = next++; j < jobs.size(); j = next++)
+                pipeline(jobs[j].front().second, jobs[j], urls, responses);
+            return 0;
+        });
+
+        evaluation::parallel::map(evaluation::parallel::workers::global(), work);
+
+        return responses;
+    }
+
+}
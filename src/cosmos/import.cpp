@@ -0,0 +1,196 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/import.hpp>
+#include <cosmos/secp256k1.hpp>
+#include <cosmos/base58.hpp>
+#include <cosmos/crypto/ripemd160.hpp>
+#include <cosmos/evaluation/parallel.hpp>
+
+namespace cosmos::bitcoin::import {
+
+    namespace {
+
+        using secp256k1::order;
+        using secp256k1::prime;
+        using secp256k1::integer;
+
+        // lines per task.
+        constexpr size_t task = 256;
+
+        // The numbers needed to check points, made once for each
+        // task rather than once for each key.
+        struct curve {
+            integer P;
+            integer X;
+            integer Y;
+            integer Right;
+
+            curve() {
+                P.read(prime.data(), prime.size());
+            }
+
+            // x^3 + 7.
+            void right() {
+                mpz_powm_ui(Right.Value, X.Value, 3, P.Value);
+                mpz_add_ui(Right.Value, Right.Value, 7);
+                mpz_mod(Right.Value, Right.Value, P.Value);
+            }
+
+            bool compressed(const byte* b) {
+                if (b[0] != 0x02 && b[0] != 0x03) return false;
+                X.read(b + 1, 32);
+                if (mpz_cmp(X.Value, P.Value) >= 0) return false;
+                right();
+                return mpz_jacobi(Right.Value, P.Value) >= 0;
+            }
+
+            // true if y^2 = x^3 + 7, in which case c is the compressed form.
+            bool uncompressed(const byte* b, keys::pubkey_bytes& c) {
+                if (b[0] != 0x04) return false;
+                X.read(b + 1, 32);
+                Y.read(b + 33, 32);
+                if (mpz_cmp(X.Value, P.Value) >= 0 || mpz_cmp(Y.Value, P.Value) >= 0) return false;
+                right();
+                mpz_powm_ui(Y.Value, Y.Value, 2, P.Value);
+                if (mpz_cmp(Y.Value, Right.Value) != 0) return false;
+                c[0] = 0x02 | (b[64] & 1);
+                std::copy(b + 1, b + 33, c.begin() + 1);
+                return true;
+            }
+        };
+
+        int digit(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        // false unless the string is exactly 2n hex digits.
+        bool hex(const char* s, size_t size, byte* b, size_t n) {
+            if (size != 2 * n) return false;
+            for (size_t i = 0; i < n; i++) {
+                int h = digit(s[2 * i]);
+                int l = digit(s[2 * i + 1]);
+                if (h < 0 || l < 0) return false;
+                b[i] = byte(h << 4 | l);
+            }
+            return true;
+        }
+
+        bool in_range(const keys::secret_bytes& s) {
+            return s < order && std::any_of(s.begin(), s.end(), [](byte b) -> bool { return b != 0; });
+        }
+
+        bool blank(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        // what one task found.
+        struct part {
+            uint32 Secrets;
+            watched Watched;
+            vector<error> Errors;
+        };
+
+        // a secret, in the form it was found in.
+        void keep(const keyring& k, const secret& s, bool compressed, part& p) {
+            ptr<const keyring::entry> e = k.find(s, compressed);
+            p.Watched.Secrets.push_back(e != nullptr ? e : keyring::make(s, compressed));
+            p.Secrets++;
+        }
+
+        void line(const char* s, size_t size, uint32 number, curve& c, const keyring& k, part& p) {
+            while (size > 0 && blank(*s)) {
+                s++;
+                size--;
+            }
+            while (size > 0 && blank(s[size - 1])) size--;
+            if (size == 0 || *s == '#') return;
+
+            keys::secret_bytes x{};
+            keys::pubkey_bytes pubkey{};
+            std::array<byte, 65> full{};
+            bool compressed;
+
+            if (hex(s, size, x.data(), x.size())) {
+                if (!in_range(x)) p.Errors.push_back(error{number, "secret out of range"});
+                else {
+                    keep(k, keys::read_secret(x), true, p);
+                }
+                return;
+            }
+
+            if (hex(s, size, pubkey.data(), pubkey.size())) {
+                if (!c.compressed(pubkey.data())) p.Errors.push_back(error{number, "pubkey not on the curve"});
+                else {
+                    p.Watched.Pubkeys.push_back(pubkey);
+                    p.Watched.Addresses.push_back(keys::write(keys::read_pubkey(pubkey).address()));
+                }
+                return;
+            }
+
+            if (hex(s, size, full.data(), full.size())) {
+                if (!c.uncompressed(full.data(), pubkey)) p.Errors.push_back(error{number, "pubkey not on the curve"});
+                else {
+                    // the address is of the form it was given in.
+                    p.Watched.Pubkeys.push_back(pubkey);
+                    p.Watched.Addresses.push_back(crypto::ripemd160::hash160(full.data(), full.size()));
+                }
+                return;
+            }
+
+            if (base58::read_wif(std::string(s, size), x, compressed)) {
+                if (!in_range(x)) p.Errors.push_back(error{number, "secret out of range"});
+                else {
+                    keep(k, keys::read_secret(x), compressed, p);
+                }
+                return;
+            }
+
+            p.Errors.push_back(error{number, "not a WIF, hex secret or hex pubkey"});
+        }
+
+    }
+
+    bool valid(const keys::pubkey_bytes& p) {
+        curve c{};
+        return c.compressed(p.data());
+    }
+
+    report keys(const std::string& text, const keyring& k, watched& w) {
+        // where each line starts, and one past the end.
+        vector<size_t> starts{0};
+        for (size_t i = 0; i < text.size(); i++) if (text[i] == '\n') starts.push_back(i + 1);
+        if (starts.back() != text.size()) starts.push_back(text.size() + 1);
+        const size_t lines = starts.size() - 1;
+
+        vector<part> parts((lines + task - 1) / task);
+        vector<std::function<uint32()>> jobs{};
+        for (size_t t = 0; t < parts.size(); t++) jobs.push_back([&text, &starts, &parts, &k, lines, t]() -> uint32 {
+            curve c{};
+            part& p = parts[t];
+            p.Secrets = 0;
+            for (size_t i = t * task; i < std::min(lines, (t + 1) * task); i++)
+                line(text.data() + starts[i], starts[i + 1] - starts[i] - 1, uint32(i + 1), c, k, p);
+            return 0;
+        });
+
+        evaluation::parallel::map(evaluation::parallel::workers::global(), jobs);
+
+        report r{0, 0, {}};
+        for (part& p : parts) {
+            r.Secrets += p.Secrets;
+            w.Secrets.insert(w.Secrets.end(), p.Watched.Secrets.begin(), p.Watched.Secrets.end());
+            r.Pubkeys += p.Watched.Pubkeys.size();
+            w.Pubkeys.insert(w.Pubkeys.end(), p.Watched.Pubkeys.begin(), p.Watched.Pubkeys.end());
+            w.Addresses.insert(w.Addresses.end(), p.Watched.Addresses.begin(), p.Watched.Addresses.end());
+            r.Errors.insert(r.Errors.end(), p.Errors.begin(), p.Errors.end());
+        }
+
+        return r;
+    }
+
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/keyring.hpp>
+#include <cosmos/secp256k1.hpp>
+#include <cosmos/crypto/ripemd160.hpp>
+#include <algorithm>
+
+namespace cosmos::bitcoin {
+
+    // Each level branches on four bits of the key. Keys are hashes or
+    // random secrets, so the trie stays balanced and about log16 of
+    // the number of keys deep. A node is a leaf until it holds more
+    // than a few entries, and an insert copies only the nodes on the
+    // path to the key.
+    template <size_t size>
+    struct keyring::node {
+        using key = std::array<byte, size>;
+
+        static constexpr size_t leaf = 8;
+        static constexpr size_t depth = 2 * size;
+
+        std::array<ptr<const node>, 16> Children;
+        vector<std::pair<key, ptr<const entry>>> Entries;
+
+        bool branches() const {
+            return std::any_of(Children.begin(), Children.end(), [](const ptr<const node>& n) -> bool { return n != nullptr; });
+        }
+
+        static uint32 nibble(const key& k, size_t d) {
+            return d % 2 == 0 ? k[d / 2] >> 4 : k[d / 2] & 15;
+        }
+
+        static ptr<const entry> find(ptr<const node> n, const key& k) {
+            for (size_t d = 0; n != nullptr; d++) {
+                if (!n->branches()) {
+                    for (const auto& e : n->Entries) if (e.first == k) return e.second;
+                    return nullptr;
+                }
+
+                n = n->Children[nibble(k, d)];
+            }
+
+            return nullptr;
+        }
+
+        // nullptr if the key is already here.
+        static ptr<const node> insert(ptr<const node> n, const key& k, ptr<const entry> e, size_t d) {
+            if (n == nullptr) {
+                ptr<node> x = std::make_shared<node>();
+                x->Entries.emplace_back(k, e);
+                return x;
+            }
+
+            if (n->branches()) {
+                ptr<const node> c = insert(n->Children[nibble(k, d)], k, e, d + 1);
+                if (c == nullptr) return nullptr;
+                ptr<node> x = std::make_shared<node>(*n);
+                x->Children[nibble(k, d)] = c;
+                return x;
+            }
+
+            for (const auto& y : n->Entries) if (y.first == k) return nullptr;
+
+            ptr<node> x = std::make_shared<node>(*n);
+            x->Entries.emplace_back(k, e);
+            if (x->Entries.size() <= leaf || d == depth) return x;
+
+            // too many for a leaf, so it becomes a branch.
+            ptr<node> b = std::make_shared<node>();
+            for (const auto& y : x->Entries) b->Children[nibble(y.first, d)] = insert(b->Children[nibble(y.first, d)], y.first, y.second, d + 1);
+            return b;
+        }
+
+        static size_t memory(const ptr<const node>& n) {
+            if (n == nullptr) return 0;
+
+            // the node shares a block with its control block.
+            size_t m = sizeof(node) + 2 * sizeof(long) + n->Entries.capacity() * sizeof(std::pair<key, ptr<const entry>>);
+            for (const ptr<const node>& c : n->Children) m += memory(c);
+            return m;
+        }
+    };
+
+    namespace {
+
+        using secret_key = std::array<byte, 33>;
+
+        secret_key backwards(const secret& s, bool compressed) {
+            keys::secret_bytes b = keys::write(s);
+            secret_key k{};
+            std::reverse_copy(b.begin(), b.end(), k.begin());
+            k[32] = compressed;
+            return k;
+        }
+
+        // The address of the uncompressed form of a point. y is the
+        // square root of x^3 + 7 with the parity in the first byte,
+        // which is (x^3 + 7)^((p + 1) / 4) since p = 3 mod 4.
+        keys::hash160 uncompressed(const keys::pubkey_bytes& c) {
+            secp256k1::integer p{secp256k1::prime};
+            secp256k1::integer y{c.data() + 1, 32};
+            secp256k1::integer e{};
+
+            mpz_powm_ui(y.Value, y.Value, 3, p.Value);
+            mpz_add_ui(y.Value, y.Value, 7);
+            mpz_add_ui(e.Value, p.Value, 1);
+            mpz_fdiv_q_2exp(e.Value, e.Value, 2);
+            mpz_powm(y.Value, y.Value, e.Value, p.Value);
+            if (mpz_odd_p(y.Value) != (c[0] & 1)) mpz_sub(y.Value, p.Value, y.Value);
+
+            std::array<byte, 65> full{};
+            full[0] = 0x04;
+            std::copy(c.begin() + 1, c.end(), full.begin() + 1);
+            keys::secret_bytes b = y.fixed<32>();
+            std::copy(b.begin(), b.end(), full.begin() + 33);
+
+            return crypto::ripemd160::hash160(full.data(), full.size());
+        }
+
+    }
+
+    ptr<const keyring::entry> keyring::make(const secret& s, bool compressed) {
+        // constant time, since s is a private key.
+        const pubkey p = s.to_public();
+        const keys::pubkey_bytes b = keys::write(p);
+        return std::make_shared<entry>(entry{s, b, compressed ? keys::write(p.address()) : uncompressed(b), compressed});
+    }
+
+    keyring keyring::add(const secret& s, bool compressed) const {
+        return find(s, compressed) != nullptr ? *this : add(make(s, compressed));
+    }
+
+    keyring keyring::add(ptr<const entry> e) const {
+        if (e == nullptr) return *this;
+        ptr<const node<33>> s = node<33>::insert(BySecret, backwards(e->Secret, e->Compressed), e, 0);
+        if (s == nullptr) return *this;
+
+        keyring k{*this};
+        k.BySecret = s;
+        k.Size++;
+
+        // a key which redeems an address we already have a key for
+        // is the same key, so it is not indexed again.
+        ptr<const node<20>> a = node<20>::insert(ByAddress, e->Address, e, 0);
+        if (a != nullptr) k.ByAddress = a;
+        return k;
+    }
+
+    ptr<const keyring::entry> keyring::find(const secret& s, bool compressed) const {
+        return node<33>::find(BySecret, backwards(s, compressed));
+    }
+
+    ptr<const keyring::entry> keyring::find(const keys::hash160& a) const {
+        return node<20>::find(ByAddress, a);
+    }
+
+    size_t keyring::memory() const {
+        return node<20>::memory(ByAddress) + node<33>::memory(BySecret) + Size * (sizeof(entry) + 2 * sizeof(long));
+    }
+
+}
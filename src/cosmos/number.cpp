@@ -0,0 +1,90 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/number.hpp>
+
+namespace cosmos {
+
+    static_assert(sizeof(long) == sizeof(int64_t), "small numbers are read and written as long");
+
+    number number::make(mpz_t z) {
+        number n{};
+        if (mpz_fits_slong_p(z)) {
+            n.Small = mpz_get_si(z);
+            mpz_clear(z);
+            return n;
+        }
+
+        n.Big = true;
+        *n.Large = *z;
+        return n;
+    }
+
+    namespace {
+
+        // z = x + s and z = x - s for a signed s. The magnitude
+        // is taken as unsigned so that INT64_MIN has one.
+        void add_si(mpz_ptr z, mpz_srcptr x, int64_t s) {
+            if (s >= 0) mpz_add_ui(z, x, uint64_t(s));
+            else mpz_sub_ui(z, x, uint64_t(0) - uint64_t(s));
+        }
+
+        void sub_si(mpz_ptr z, mpz_srcptr x, int64_t s) {
+            if (s >= 0) mpz_sub_ui(z, x, uint64_t(s));
+            else mpz_add_ui(z, x, uint64_t(0) - uint64_t(s));
+        }
+
+    }
+
+    void number::add(mpz_ptr z, const number& a, const number& b) {
+        if (a.Big && b.Big) mpz_add(z, a.Large, b.Large);
+        else if (a.Big) add_si(z, a.Large, b.Small);
+        else if (b.Big) add_si(z, b.Large, a.Small);
+        else {
+            mpz_set_si(z, a.Small);
+            add_si(z, z, b.Small);
+        }
+    }
+
+    void number::subtract(mpz_ptr z, const number& a, const number& b) {
+        if (a.Big && b.Big) mpz_sub(z, a.Large, b.Large);
+        else if (a.Big) sub_si(z, a.Large, b.Small);
+        else if (b.Big) {
+            mpz_neg(z, b.Large);
+            add_si(z, z, a.Small);
+        } else {
+            mpz_set_si(z, a.Small);
+            sub_si(z, z, b.Small);
+        }
+    }
+
+    void number::multiply(mpz_ptr z, const number& a, const number& b) {
+        if (a.Big && b.Big) mpz_mul(z, a.Large, b.Large);
+        else if (a.Big) mpz_mul_si(z, a.Large, b.Small);
+        else if (b.Big) mpz_mul_si(z, b.Large, a.Small);
+        else {
+            mpz_set_si(z, a.Small);
+            mpz_mul_si(z, z, b.Small);
+        }
+    }
+
+    number::number(const std::string& x) : Big{false}, Small{0} {
+        mpz_t z;
+        if (mpz_init_set_str(z, x.c_str(), 10) != 0) {
+            mpz_clear(z);
+            throw std::invalid_argument{"invalid number"};
+        }
+
+        *this = make(z);
+    }
+
+    std::string number::write() const {
+        if (!Big) return std::to_string(Small);
+        std::string s(mpz_sizeinbase(Large, 10) + 2, '\0');
+        mpz_get_str(&s[0], 10, Large);
+        s.resize(std::char_traits<char>::length(s.c_str()));
+        return s;
+    }
+
+}
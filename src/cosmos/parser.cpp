@@ -0,0 +1,185 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/parser.hpp>
+#include <cctype>
+
+namespace cosmos::parse {
+
+    error::error(std::string s) : Message{s} {}
+
+    const char* error::what() const noexcept {
+        return Message.c_str();
+    }
+
+    namespace {
+
+        // the next character after any whitespace, which is not consumed.
+        int next(stringstream& ss) {
+            ss >> std::ws;
+            int c = ss.peek();
+            if (c == EOF) ss.clear();
+            return c;
+        }
+
+        std::string word(stringstream& ss) {
+            std::string w{};
+            while (std::isalnum(ss.peek()) || ss.peek() == '_') w.push_back(char(ss.get()));
+            if (ss.peek() == EOF) ss.clear();
+            return w;
+        }
+
+        expression::parameters ordered(const vector<ptr<expression>>& v) {
+            expression::parameters p{};
+            for (auto i = v.rbegin(); i != v.rend(); i++) p = p.prepend(*i);
+            return p;
+        }
+
+        // statements separated by commas, up to the closing token.
+        template <typename close>
+        expression::parameters items(stringstream& ss) {
+            vector<ptr<expression>> v{};
+            if (token::read<close>{}(ss)) return {};
+            do v.push_back(statement(ss));
+            while (token::read<token::comma>{}(ss));
+            if (!token::read<close>{}(ss)) throw error{"expected a comma or a closing bracket"};
+            return ordered(v);
+        }
+
+        template <function fn>
+        ptr<expression> apply(expression::parameters p) {
+            return std::make_shared<expression::application<fn>>(p);
+        }
+
+        ptr<expression> application(function f, expression::parameters p) {
+            switch (f) {
+                case identity: return apply<identity>(p);
+                case SHA256: return apply<SHA256>(p);
+                case SHA512: return apply<SHA512>(p);
+                case address: return apply<address>(p);
+                case public_key: return apply<public_key>(p);
+                case update: return apply<update>(p);
+                case spend: return apply<spend>(p);
+                case next_address: return apply<next_address>(p);
+                case evaluate_script: return apply<evaluate_script>(p);
+                case stats: return apply<stats>(p);
+                default: throw error{"unknown function"};
+            }
+        }
+
+        template <constructor c>
+        ptr<expression> make(expression::parameters p) {
+            return std::make_shared<expression::construction<c>>(p);
+        }
+
+        ptr<expression> construction(constructor c, expression::parameters p) {
+            switch (c) {
+                case outpoint: return make<outpoint>(p);
+                case input: return make<input>(p);
+                case output: return make<output>(p);
+                case transaction: return make<transaction>(p);
+                case wallet: return make<wallet>(p);
+                default: throw error{"unknown constructor"};
+            }
+        }
+
+        ptr<expression> primary(stringstream& ss) {
+            int c = next(ss);
+            if (c == EOF) throw error{"unexpected end of input"};
+
+            if (std::isdigit(c)) {
+                std::string digits{};
+                while (std::isdigit(ss.peek())) digits.push_back(char(ss.get()));
+                if (ss.peek() == EOF) ss.clear();
+                return std::make_shared<expression::atomic<number>>(number{digits});
+            }
+
+            if (c == '"') {
+                ss.get();
+                std::string x{};
+                while (true) {
+                    int d = ss.get();
+                    if (d == EOF) throw error{"unterminated string"};
+                    if (d == '"') break;
+                    if (d == '\\') d = ss.get();
+                    if (d == EOF) throw error{"unterminated string"};
+                    x.push_back(char(d));
+                }
+                return std::make_shared<expression::atomic<std::string>>(x);
+            }
+
+            if (c == '$') {
+                ss.get();
+                std::string n = word(ss);
+                if (n.empty()) throw error{"expected a name after $"};
+                return std::make_shared<expression::atomic<name>>(name{n});
+            }
+
+            if (token::read<token::open_brace>{}(ss))
+                return std::make_shared<expression::list>(items<token::close_brace>(ss));
+
+            if (token::read<token::open_paren>{}(ss)) {
+                ptr<expression> e = statement(ss);
+                if (!token::read<token::close_paren>{}(ss)) throw error{"expected a closing parenthesis"};
+                return std::make_shared<expression::parenthesis>(e);
+            }
+
+            std::string w = word(ss);
+            if (w.empty()) throw error{std::string{"unexpected character "} + char(c)};
+
+            function f;
+            constructor k;
+            bool fn = token::lookup(w, f);
+            if (!fn && !token::lookup(w, k)) throw error{"unknown word " + w};
+            if (!token::read<token::open_paren>{}(ss)) throw error{"expected arguments to " + w};
+
+            expression::parameters p = items<token::close_paren>(ss);
+            return fn ? application(f, p) : construction(k, p);
+        }
+
+        // operands of one operator, each read by the next tighter one.
+        template <op o, typename t, ptr<expression> (*read)(stringstream&)>
+        ptr<expression> chain(stringstream& ss) {
+            vector<ptr<expression>> v{read(ss)};
+            while (token::read<t>{}(ss)) v.push_back(read(ss));
+            if (v.size() == 1) return v[0];
+            return std::make_shared<expression::operation<o>>(ordered(v));
+        }
+
+        ptr<expression> product(stringstream& ss) {
+            return chain<cosmos::times, token::times, primary>(ss);
+        }
+
+        ptr<expression> sum(stringstream& ss) {
+            return chain<cosmos::plus, token::plus, product>(ss);
+        }
+
+        ptr<expression> concatenation(stringstream& ss) {
+            return chain<cosmos::concat, token::concat, sum>(ss);
+        }
+
+    }
+
+    ptr<expression> statement(stringstream& ss) {
+        ptr<expression> left = concatenation(ss);
+        if (!token::read<token::set>{}(ss)) return left;
+
+        if (dynamic_cast<const expression::atomic<name>*>(left.get()) == nullptr)
+            throw error{"only a name can be set"};
+
+        vector<ptr<expression>> v{left, statement(ss)};
+        return std::make_shared<expression::operation<cosmos::set>>(ordered(v));
+    }
+
+    expression::parameters program(stringstream& ss) {
+        vector<ptr<expression>> v{};
+        while (next(ss) != EOF) {
+            v.push_back(statement(ss));
+            if (!token::read<token::separator>{}(ss) && next(ss) != EOF)
+                throw error{"expected a separator"};
+        }
+        return ordered(v);
+    }
+
+}
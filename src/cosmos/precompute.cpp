@@ -0,0 +1,290 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/precompute.hpp>
+#include <cosmos/crypto/sha256.hpp>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cosmos::bitcoin::precompute {
+
+    namespace {
+
+        file::path& cache_path() {
+            static file::path p{};
+            return p;
+        }
+
+        // the copy of the table this thread uses, if any.
+        const generator*& local_table() {
+            thread_local const generator* g = nullptr;
+            return g;
+        }
+
+        void build(byte* table) {
+            pubkey base = keys::generator();
+            for (uint32 i = 0; i < generator::windows; i++) {
+                byte* row = table + size_t{i} * generator::width * 33;
+                pubkey next = base;
+                for (uint32 j = 0; j < generator::width; j++) {
+                    keys::pubkey_bytes b = keys::write(next);
+                    std::copy(b.begin(), b.end(), row + size_t{j} * 33);
+                    next = next + base;
+                }
+
+                // next is now 256 * base.
+                base = next;
+            }
+        }
+
+        // changed whenever the layout of the table changes.
+        constexpr char magic[8] = {'c', 'o', 's', 'm', 'o', 's', 'G', '1'};
+
+        constexpr size_t file_size = generator::header + generator::size;
+
+        void* map(const file::path& p) {
+            int fd = ::open(p.c_str(), O_RDONLY);
+            if (fd < 0) return nullptr;
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || size_t(st.st_size) != file_size) {
+                ::close(fd);
+                return nullptr;
+            }
+
+            void* m = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (m == MAP_FAILED) return nullptr;
+            if (!generator::check(static_cast<const byte*>(m), file_size)) {
+                ::munmap(m, file_size);
+                return nullptr;
+            }
+
+            return m;
+        }
+
+        // non-adjacent form of a big-endian scalar, least significant digit first.
+        std::vector<int8_t> wnaf(const keys::secret_bytes& s, uint32 w) {
+            // one extra limb because subtracting a negative digit can carry.
+            std::array<uint64_t, 5> k{};
+            for (int i = 0; i < 32; i++) k[(31 - i) / 8] |= uint64_t(s[i]) << (8 * ((31 - i) % 8));
+
+            auto zero = [&k]() -> bool {
+                for (uint64_t l : k) if (l != 0) return false;
+                return true;
+            };
+
+            std::vector<int8_t> digits{};
+            digits.reserve(257);
+            const int64_t modulus = int64_t{1} << w;
+            while (!zero()) {
+                int64_t d = 0;
+                if (k[0] & 1) {
+                    d = int64_t(k[0] & (modulus - 1));
+                    if (d >= modulus / 2) d -= modulus;
+
+                    if (d > 0) k[0] -= uint64_t(d);
+                    else {
+                        uint64_t carry = uint64_t(-d);
+                        for (uint64_t& l : k) {
+                            l += carry;
+                            carry = l < carry ? 1 : 0;
+                            if (carry == 0) break;
+                        }
+                    }
+                }
+
+                digits.push_back(int8_t(d));
+
+                for (int i = 0; i < 4; i++) k[i] = (k[i] >> 1) | (k[i + 1] << 63);
+                k[4] >>= 1;
+            }
+
+            return digits;
+        }
+
+    }
+
+    void generator::cache(file::path p) {
+        cache_path() = p;
+    }
+
+    // write to a temporary file and rename so that another
+    // process never maps a partially written table.
+    void generator::save(const file::path& p, const byte* table) {
+        const crypto::sha256::digest d = crypto::sha256::hash(table, size);
+        file::path tmp = p;
+        tmp += ".tmp";
+        {
+            std::ofstream out{tmp.string(), std::ios::binary | std::ios::trunc};
+            if (!out) return;
+            out.write(magic, sizeof(magic));
+            out.write(reinterpret_cast<const char*>(d.data()), d.size());
+            out.write(reinterpret_cast<const char*>(table), size);
+            if (!out) return;
+        }
+
+        boost::system::error_code e;
+        boost::filesystem::rename(tmp, p, e);
+    }
+
+    // The hash catches a file that was damaged or written by
+    // another version. The first entry must also be G, so that
+    // a table which was built wrong is not used either.
+    bool generator::check(const byte* file, size_t n) {
+        if (n != file_size || std::memcmp(file, magic, sizeof(magic)) != 0) return false;
+
+        const byte* table = file + header;
+        const crypto::sha256::digest d = crypto::sha256::hash(table, size);
+        if (!std::equal(d.begin(), d.end(), file + sizeof(magic))) return false;
+
+        keys::pubkey_bytes g = keys::write(keys::generator());
+        return std::equal(g.begin(), g.end(), table);
+    }
+
+    const generator& generator::get() {
+        static const generator g{};
+        return g;
+    }
+
+    const generator& generator::place(uint32 node) {
+        static std::map<uint32, std::unique_ptr<const generator>> Copies{};
+        static std::mutex Mutex{};
+
+        const generator* g;
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            auto i = Copies.find(node);
+            if (i == Copies.end()) i = Copies.emplace(node, std::unique_ptr<const generator>{new generator{get(), true}}).first;
+            g = i->second.get();
+        }
+
+        local_table() = g;
+        return *g;
+    }
+
+    const generator& generator::local() {
+        const generator* g = local_table();
+        return g == nullptr ? get() : *g;
+    }
+
+    generator::generator(const generator& g, bool huge) :
+        Table{nullptr}, Owned{}, Mapped{nullptr}, MappedSize{0}, Copy{size, huge} {
+        std::copy(g.Table, g.Table + size, Copy.data());
+        Table = Copy.data();
+    }
+
+    generator::generator() : Table{nullptr}, Owned{}, Mapped{nullptr}, MappedSize{0}, Copy{} {
+        const file::path& p = cache_path();
+        if (!p.empty()) {
+            Mapped = map(p);
+            if (Mapped != nullptr) {
+                MappedSize = file_size;
+                Table = static_cast<const byte*>(Mapped) + header;
+                return;
+            }
+        }
+
+        Owned.resize(size);
+        build(Owned.data());
+        Table = Owned.data();
+
+        if (!p.empty()) save(p, Owned.data());
+    }
+
+    generator::~generator() {
+        if (Mapped != nullptr) ::munmap(Mapped, MappedSize);
+    }
+
+    keys::pubkey_bytes generator::entry(uint32 window, byte j) const {
+        keys::pubkey_bytes b{};
+        const byte* e = Table + (size_t{window} * width + (j - 1)) * 33;
+        std::copy(e, e + 33, b.begin());
+        return b;
+    }
+
+    pubkey generator::to_public(const secret& s) const {
+        keys::secret_bytes b = keys::write(s);
+        pubkey p{};
+        bool started = false;
+        for (uint32 i = 0; i < windows; i++) {
+            byte j = b[31 - i];
+            if (j == 0) continue;
+            pubkey e = keys::read_pubkey(entry(i, j));
+            if (started) p = p + e;
+            else {
+                p = e;
+                started = true;
+            }
+        }
+
+        return p;
+    }
+
+    table::table(const pubkey& p) : Odd{} {
+        pubkey twice = p + p;
+        pubkey next = p;
+        for (uint32 i = 0; i < size; i++) {
+            Odd[i] = keys::write(next);
+            if (i + 1 < size) next = next + twice;
+        }
+    }
+
+    pubkey table::times(const secret& s) const {
+        std::vector<int8_t> digits = wnaf(keys::write(s), window);
+        pubkey p{};
+        bool started = false;
+        for (auto d = digits.rbegin(); d != digits.rend(); d++) {
+            if (started) p = p + p;
+            if (*d == 0) continue;
+
+            keys::pubkey_bytes e = *d > 0 ? Odd[(*d - 1) / 2] : keys::negate(Odd[(-*d - 1) / 2]);
+            if (started) p = p + keys::read_pubkey(e);
+            else {
+                p = keys::read_pubkey(e);
+                started = true;
+            }
+        }
+
+        return p;
+    }
+
+    ptr<const table> bases::get(const pubkey& p) {
+        keys::pubkey_bytes k = keys::write(p);
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            auto i = Index.find(k);
+            if (i != Index.end()) {
+                Recent.splice(Recent.begin(), Recent, i->second);
+                return i->second->second;
+            }
+        }
+
+        // build outside the lock; if another thread raced us
+        // the extra table is simply discarded.
+        ptr<const table> t = std::make_shared<const table>(p);
+
+        std::lock_guard<std::mutex> lock{Mutex};
+        auto i = Index.find(k);
+        if (i != Index.end()) return i->second->second;
+        Recent.emplace_front(k, t);
+        Index[k] = Recent.begin();
+        if (Recent.size() > Capacity) {
+            Index.erase(Recent.back().first);
+            Recent.pop_back();
+        }
+
+        return t;
+    }
+
+    bases& bases::global() {
+        static bases b{1024};
+        return b;
+    }
+
+}
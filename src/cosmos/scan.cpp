@@ -0,0 +1,391 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/scan.hpp>
+#include <cosmos/calibrate.hpp>
+#include <cosmos/crypto/sha256.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cosmos::bitcoin::scan {
+
+    filter::filter(const vector<keys::hash160>& addresses) : Bits{}, Mask{} {
+        // about 16 bits per address, rounded up to a power of two.
+        uint64_t size = 1 << 12;
+        while (size < addresses.size() * 16) size <<= 1;
+        Bits.resize(size / 64);
+        Mask = size - 1;
+
+        for (const keys::hash160& a : addresses)
+            for (uint32 i = 0; i < probes; i++) {
+                uint64_t b = word(a, i) & Mask;
+                Bits[b >> 6] |= uint64_t{1} << (b & 63);
+            }
+    }
+
+    statistics& statistics::operator+=(const statistics& s) {
+        Bytes += s.Bytes;
+        Files += s.Files;
+        Blocks += s.Blocks;
+        Transactions += s.Transactions;
+        Outputs += s.Outputs;
+        Candidates += s.Candidates;
+        Matches += s.Matches;
+        Spent += s.Spent;
+        Invalid += s.Invalid;
+        Stale += s.Stale;
+        return *this;
+    }
+
+    namespace {
+
+        constexpr size_t header_size = 80;
+
+        struct match {
+            index Index;
+            uint64_t Value;
+            keys::hash160 Address;
+            wire::slice Script;
+        };
+
+        // what one pass over the files looks for: outputs paying to
+        // our addresses or, once those are known, inputs spending them.
+        struct search {
+            const filter* Filter;
+            const std::unordered_set<keys::hash160, utxo::hash>* Addresses;
+            const std::unordered_set<utxo::outpoint, utxo::hash>* Outpoints;
+        };
+
+        // parse one transaction, returning false if it is malformed.
+        bool transaction(wire::reader& r, const search& s, result& x) {
+            const byte* begin = r.position();
+            r.skip(4);
+
+            // segwit marker and flag.
+            bool witness = false;
+            if (r.peek() == 0) {
+                r.skip(1);
+                if (r.read<byte>() != 1) return false;
+                witness = true;
+            }
+
+            const byte* body = r.position();
+
+            uint64_t inputs = r.varint();
+            for (uint64_t i = 0; i < inputs && r.valid(); i++) {
+                if (s.Outpoints == nullptr) r.skip(36);
+                else {
+                    wire::slice txid = r.take(32);
+                    utxo::outpoint o{{}, r.read<uint32>()};
+                    if (r.valid()) {
+                        std::copy(txid.Begin, txid.End, o.Txid.begin());
+                        if (s.Outpoints->count(o) != 0) {
+                            x.Spent.push_back(o);
+                            x.Statistics.Spent++;
+                        }
+                    }
+                }
+
+                r.var_bytes();
+                r.skip(4);
+            }
+
+            static thread_local std::vector<match> matches{};
+            matches.clear();
+
+            uint64_t outputs = r.varint();
+            for (uint64_t i = 0; i < outputs && r.valid(); i++) {
+                uint64_t value = r.read<uint64_t>();
+                wire::slice script = r.var_bytes();
+                keys::hash160 a;
+                if (s.Filter == nullptr || !pay_to_address(script, a) || !s.Filter->maybe(a)) continue;
+                x.Statistics.Candidates++;
+                if (s.Addresses->count(a) != 0) matches.push_back(match{index(i), value, a, script});
+            }
+
+            x.Statistics.Outputs += outputs;
+            const byte* end = r.position();
+
+            if (witness)
+                for (uint64_t i = 0; i < inputs && r.valid(); i++) {
+                    uint64_t items = r.varint();
+                    for (uint64_t j = 0; j < items && r.valid(); j++) r.var_bytes();
+                }
+
+            const byte* locktime = r.position();
+            r.skip(4);
+            if (!r.valid()) return false;
+
+            x.Statistics.Transactions++;
+            if (matches.empty()) return true;
+
+            // the txid is only computed for transactions that pay us and
+            // leaves out the witness, which is why it is done in pieces.
+            crypto::sha256 h{};
+            h.update(begin, 4);
+            h.update(body, end - body);
+            h.update(locktime, 4);
+            crypto::sha256::digest d = h.finish();
+            utxo::outpoint o{crypto::sha256::hash(d.data(), d.size()), 0};
+
+            for (const match& m : matches) {
+                o.Index = m.Index;
+                x.Outputs.push_back(utxo::entry{o, m.Value, m.Address, bytes(m.Script.Begin, m.Script.End)});
+                x.Statistics.Matches++;
+            }
+
+            return true;
+        }
+
+        struct mapped {
+            void* Data;
+            size_t Size;
+
+            mapped(const file::path& p) : Data{nullptr}, Size{0} {
+                int fd = ::open(p.c_str(), O_RDONLY);
+                if (fd < 0) return;
+                struct stat st;
+                if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                    void* m = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (m != MAP_FAILED) {
+                        ::madvise(m, st.st_size, MADV_SEQUENTIAL);
+                        Data = m;
+                        Size = st.st_size;
+                    }
+                }
+
+                ::close(fd);
+            }
+
+            ~mapped() {
+                if (Data != nullptr) ::munmap(Data, Size);
+            }
+
+            wire::slice bytes() const {
+                const byte* b = static_cast<const byte*>(Data);
+                return wire::slice{b, b + Size};
+            }
+        };
+
+    }
+
+    namespace {
+
+        // each block in a file with where it begins.
+        template <typename f>
+        void each_block(wire::slice file, f block) {
+            wire::reader r{file};
+            while (r.remaining() >= 8) {
+                // nodes preallocate files with zeros.
+                uint32 magic = r.read<uint32>();
+                if (magic == 0) break;
+
+                uint32 size = r.read<uint32>();
+                if (size > r.remaining()) break;
+                const uint64_t offset = r.position() - file.Begin;
+                block(offset, r.take(size));
+            }
+        }
+
+        result block_file(wire::slice file, const search& s, const vector<uint64_t>* blocks) {
+            result x{};
+            x.Statistics.Bytes = file.size();
+            x.Statistics.Files = 1;
+
+            // the offsets are in order, as the blocks are.
+            size_t next = 0;
+            each_block(file, [&](uint64_t offset, wire::slice block) {
+                if (blocks != nullptr) {
+                    while (next < blocks->size() && (*blocks)[next] < offset) next++;
+                    if (next == blocks->size() || (*blocks)[next] != offset) return;
+                }
+
+                wire::reader b{block};
+                b.skip(header_size);
+                uint64_t count = b.varint();
+                bool ok = b.valid();
+                for (uint64_t i = 0; i < count && ok; i++) ok = transaction(b, s, x);
+
+                if (ok) x.Statistics.Blocks++;
+                else x.Statistics.Invalid++;
+            });
+
+            return x;
+        }
+
+        struct digest_hash {
+            size_t operator()(const digest& d) const {
+                size_t h = 0;
+                for (int i = 0; i < 8; i++) h = (h << 8) ^ d[i];
+                return h;
+            }
+        };
+
+        // hashes expected to meet the target, which is
+        // nothing if the target cannot be read.
+        double work(uint32 bits) {
+            calibrate::compact t{byte(bits >> 24), bits & 0x7fffff};
+            return t.valid() ? calibrate::expected(t) : 0;
+        }
+
+    }
+
+    vector<header> headers(wire::slice file) {
+        vector<header> x{};
+        each_block(file, [&x](uint64_t offset, wire::slice block) {
+            if (block.size() < header_size) return;
+            header h{crypto::sha256::hash256(block.Begin, header_size), {}, 0, offset};
+            std::copy(block.Begin + 4, block.Begin + 36, h.Previous.begin());
+            wire::reader r{wire::slice{block.Begin + 72, block.Begin + 76}};
+            h.Bits = r.read<uint32>();
+            x.push_back(h);
+        });
+
+        return x;
+    }
+
+    vector<vector<uint64_t>> best_chain(const vector<vector<header>>& files) {
+        struct block {
+            const header* Header;
+            size_t File;
+
+            // the block before this one, if it was found.
+            block* Parent;
+
+            // total work of the chain ending here, which is
+            // negative until it has been worked out.
+            double Work;
+        };
+
+        // a block written more than once is taken where it is first.
+        vector<block> blocks{};
+        std::unordered_map<digest, size_t, digest_hash> where{};
+        for (size_t f = 0; f < files.size(); f++) for (const header& h : files[f])
+            if (where.emplace(h.Hash, blocks.size()).second) blocks.push_back(block{&h, f, nullptr, -1});
+
+        for (block& b : blocks) {
+            auto p = where.find(b.Header->Previous);
+            if (p != where.end()) b.Parent = &blocks[p->second];
+        }
+
+        // blocks are not stored in order, so each chain is followed back
+        // as far as it needs to be. Since a block is linked by the hash of
+        // its parent, there are no cycles.
+        vector<block*> path{};
+        block* best = nullptr;
+        for (block& b : blocks) {
+            for (block* x = &b; x != nullptr && x->Work < 0; x = x->Parent) path.push_back(x);
+            while (!path.empty()) {
+                block* x = path.back();
+                path.pop_back();
+                x->Work = work(x->Header->Bits) + (x->Parent == nullptr ? 0 : x->Parent->Work);
+            }
+
+            // the first block seen wins a tie, as it would for a node.
+            if (best == nullptr || b.Work > best->Work) best = &b;
+        }
+
+        vector<vector<uint64_t>> x(files.size());
+        for (block* b = best; b != nullptr; b = b->Parent) x[b->File].push_back(b->Header->Offset);
+        for (vector<uint64_t>& offsets : x) std::sort(offsets.begin(), offsets.end());
+        return x;
+    }
+
+    result block_file(
+        wire::slice file,
+        const filter& f,
+        const std::unordered_set<keys::hash160, utxo::hash>& addresses,
+        const vector<uint64_t>* blocks) {
+        return block_file(file, search{&f, &addresses, nullptr}, blocks);
+    }
+
+    result block_file(
+        wire::slice file,
+        const std::unordered_set<utxo::outpoint, utxo::hash>& spent,
+        const vector<uint64_t>* blocks) {
+        return block_file(file, search{nullptr, nullptr, &spent}, blocks);
+    }
+
+    vector<file::path> block_files(const file::path& blocks) {
+        vector<file::path> files{};
+        for (const auto& e : boost::filesystem::directory_iterator{blocks}) {
+            std::string n = e.path().filename().string();
+            if (n.size() == 12 && n.compare(0, 3, "blk") == 0 && n.compare(8, 4, ".dat") == 0)
+                files.push_back(e.path());
+        }
+
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    result run(const vector<file::path>& files, const vector<keys::hash160>& addresses, uint32 threads) {
+        auto start = std::chrono::steady_clock::now();
+
+        const filter f{addresses};
+        const std::unordered_set<keys::hash160, utxo::hash> set(addresses.begin(), addresses.end());
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<uint32>(threads, std::max<size_t>(files.size(), 1));
+
+        // results are kept by file so that the output
+        // does not depend on how threads are scheduled.
+        auto each = [&](auto scan) {
+            vector<decltype(scan(size_t{}, std::declval<wire::slice>()))> found(files.size());
+            std::atomic<size_t> next{0};
+
+            auto work = [&]() {
+                for (size_t i = next++; i < files.size(); i = next++) {
+                    mapped m{files[i]};
+                    if (m.Data == nullptr) continue;
+                    found[i] = scan(i, m.bytes());
+                }
+            };
+
+            vector<std::thread> pool{};
+            for (uint32 i = 1; i < threads; i++) pool.emplace_back(work);
+            work();
+            for (std::thread& t : pool) t.join();
+            return found;
+        };
+
+        const vector<vector<header>> found = each([](size_t, wire::slice b) { return headers(b); });
+        const vector<vector<uint64_t>> chain = best_chain(found);
+
+        result x{};
+        for (result& r : each([&](size_t i, wire::slice b) { return block_file(b, f, set, &chain[i]); })) {
+            x.Statistics += r.Statistics;
+            x.Outputs.insert(x.Outputs.end(), r.Outputs.begin(), r.Outputs.end());
+        }
+
+        for (size_t i = 0; i < files.size(); i++) x.Statistics.Stale += found[i].size() - chain[i].size();
+        for (const utxo::entry& e : x.Outputs) x.Used.insert(e.Address);
+
+        // an output may be spent in a file before the one it is in.
+        if (!x.Outputs.empty()) {
+            std::unordered_set<utxo::outpoint, utxo::hash> mine{};
+            for (const utxo::entry& e : x.Outputs) mine.insert(e.Outpoint);
+
+            std::unordered_set<utxo::outpoint, utxo::hash> spent{};
+            for (result& r : each([&](size_t i, wire::slice b) { return block_file(b, mine, &chain[i]); }))
+                for (const utxo::outpoint& o : r.Spent) if (spent.insert(o).second) x.Spent.push_back(o);
+
+            x.Statistics.Spent = x.Spent.size();
+            x.Outputs.erase(std::remove_if(x.Outputs.begin(), x.Outputs.end(),
+                [&](const utxo::entry& e) { return spent.count(e.Outpoint) != 0; }), x.Outputs.end());
+        }
+
+        x.Statistics.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return x;
+    }
+
+}
@@ -0,0 +1,200 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/sign.hpp>
+#include <cosmos/secp256k1.hpp>
+#include <cosmos/crypto/hmac.hpp>
+#include <cosmos/evaluation/parallel.hpp>
+
+namespace cosmos::bitcoin::sign {
+
+    namespace {
+
+        using secp256k1::order;
+        using secp256k1::integer;
+
+        crypto::sha256::digest hash256(const bytes& b) {
+            return crypto::sha256::hash256(b.data(), b.size());
+        }
+
+        void der_integer(bytes& der, bytes x) {
+            if (x.empty() || x[0] & 0x80) x.insert(x.begin(), 0);
+            der.push_back(0x02);
+            der.push_back(byte(x.size()));
+            der.insert(der.end(), x.begin(), x.end());
+        }
+
+    }
+
+    bytes transaction::write(const vector<bytes>& scripts) const {
+        bytes b{};
+        wire::writer w{b};
+        w.write<uint32>(Version).varint(Inputs.size());
+        for (size_t i = 0; i < Inputs.size(); i++)
+            w.append(Inputs[i].Outpoint.Txid).write<uint32>(Inputs[i].Outpoint.Index)
+                .var_bytes(scripts[i]).write<uint32>(Inputs[i].Sequence);
+
+        w.varint(Outputs.size());
+        for (const output& o : Outputs) w.write<uint64_t>(o.Value).var_bytes(o.Script);
+        w.write<uint32>(Locktime);
+        return b;
+    }
+
+    preimage::preimage(const transaction& t) : Prevouts{}, Sequences{}, Outputs{}, Midstate{}, Transaction{t} {
+        bytes prevouts{};
+        bytes sequences{};
+        bytes outputs{};
+        wire::writer p{prevouts};
+        wire::writer s{sequences};
+        wire::writer o{outputs};
+
+        for (const input& i : t.Inputs) {
+            p.append(i.Outpoint.Txid).write<uint32>(i.Outpoint.Index);
+            s.write<uint32>(i.Sequence);
+        }
+
+        for (const output& x : t.Outputs) o.write<uint64_t>(x.Value).var_bytes(x.Script);
+
+        Prevouts = hash256(prevouts);
+        Sequences = hash256(sequences);
+        Outputs = hash256(outputs);
+
+        bytes first{};
+        wire::writer{first}.write<uint32>(t.Version).append(Prevouts).append(Sequences.data(), 28);
+        Midstate.update(first.data(), first.size());
+    }
+
+    crypto::sha256::digest preimage::digest(uint32 n) const {
+        const input& i = Transaction.Inputs[n];
+
+        bytes rest{};
+        wire::writer{rest}
+            .append(Sequences.data() + 28, 4)
+            .append(i.Outpoint.Txid).write<uint32>(i.Outpoint.Index)
+            .var_bytes(i.Script)
+            .write<uint64_t>(i.Value)
+            .write<uint32>(i.Sequence)
+            .append(Outputs)
+            .write<uint32>(Transaction.Locktime)
+            .write<uint32>(sighash_all);
+
+        crypto::sha256 h = Midstate;
+        crypto::sha256::digest d = h.update(rest.data(), rest.size()).finish();
+        return crypto::sha256::hash(d.data(), d.size());
+    }
+
+    keys::secret_bytes nonce(const keys::secret_bytes& key, const crypto::sha256::digest& message, uint32 attempt) {
+        using hmac = crypto::hmac<crypto::sha256>;
+
+        // bits2octets: the message reduced mod the order.
+        keys::secret_bytes h{};
+        {
+            integer m{message};
+            integer n{order};
+            mpz_mod(m.Value, m.Value, n.Value);
+            bytes b = m.write();
+            std::copy(b.begin(), b.end(), h.end() - b.size());
+        }
+
+        crypto::sha256::digest v{};
+        crypto::sha256::digest k{};
+        v.fill(0x01);
+        k.fill(0x00);
+
+        const byte zero = 0, one = 1;
+        k = hmac{k}.update(v).update(&zero, 1).update(key).update(h).finish();
+        v = hmac{k}.update(v).finish();
+        k = hmac{k}.update(v).update(&one, 1).update(key).update(h).finish();
+        v = hmac{k}.update(v).finish();
+
+        while (true) {
+            v = hmac{k}.update(v).finish();
+
+            // the candidate must be in [1, n - 1].
+            bool nonzero = std::any_of(v.begin(), v.end(), [](byte b) -> bool { return b != 0; });
+            if (nonzero && v < order) {
+                if (attempt == 0) return v;
+                attempt--;
+            }
+
+            k = hmac{k}.update(v).update(&zero, 1).finish();
+            v = hmac{k}.update(v).finish();
+        }
+    }
+
+    bytes signature(const keys::secret_bytes& key, const crypto::sha256::digest& message) {
+        integer n{order};
+        integer d{key};
+        integer z{message};
+        integer r{};
+        integer s{};
+        integer two_less{};
+        mpz_sub_ui(two_less.Value, n.Value, 2);
+
+        for (uint32 attempt = 0;; attempt++) {
+            keys::secret_bytes k = nonce(key, message, attempt);
+
+            // r is the x coordinate of k * G, which is the compressed
+            // point without its first byte. k is secret, so this goes
+            // through the library and not the comb table.
+            keys::pubkey_bytes R = keys::write(keys::read_secret(k).to_public());
+            keys::secret_bytes x{};
+            std::copy(R.begin() + 1, R.end(), x.begin());
+
+            integer rx{x};
+            mpz_mod(r.Value, rx.Value, n.Value);
+            if (mpz_sgn(r.Value) == 0) continue;
+
+            // s = k^-1 (z + r d), with k^-1 = k^(n - 2) computed
+            // in time that does not depend on k.
+            integer kk{k};
+            mpz_mul(s.Value, r.Value, d.Value);
+            mpz_add(s.Value, s.Value, z.Value);
+            mpz_powm_sec(kk.Value, kk.Value, two_less.Value, n.Value);
+            mpz_mul(s.Value, s.Value, kk.Value);
+            mpz_mod(s.Value, s.Value, n.Value);
+            if (mpz_sgn(s.Value) == 0) continue;
+
+            // low S
+            integer half{};
+            mpz_fdiv_q_2exp(half.Value, n.Value, 1);
+            if (mpz_cmp(s.Value, half.Value) > 0) mpz_sub(s.Value, n.Value, s.Value);
+            break;
+        }
+
+        bytes body{};
+        der_integer(body, r.write());
+        der_integer(body, s.write());
+
+        bytes der{0x30, byte(body.size())};
+        der.insert(der.end(), body.begin(), body.end());
+        return der;
+    }
+
+    bytes pay_to_address_script(const bytes& signature, const keys::pubkey_bytes& p) {
+        bytes script{};
+        script.push_back(byte(signature.size() + 1));
+        script.insert(script.end(), signature.begin(), signature.end());
+        script.push_back(byte(sighash_all));
+        script.push_back(byte(p.size()));
+        script.insert(script.end(), p.begin(), p.end());
+        return script;
+    }
+
+    vector<bytes> batch(const transaction& t) {
+        const preimage shared{t};
+
+        vector<std::function<bytes()>> jobs{};
+        for (uint32 i = 0; i < t.Inputs.size(); i++) jobs.push_back([&shared, &t, i]() -> bytes {
+            const input& x = t.Inputs[i];
+            keys::secret_bytes key = keys::write(x.Key);
+            return pay_to_address_script(
+                signature(key, shared.digest(i)),
+                x.Pubkey[0] != 0 ? x.Pubkey : keys::write(x.Key.to_public()));
+        });
+
+        return evaluation::parallel::map(evaluation::parallel::workers::global(), jobs);
+    }
+
+}
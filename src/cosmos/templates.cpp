@@ -0,0 +1,29 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/templates.hpp>
+
+namespace cosmos::bitcoin::templates {
+
+    skeleton skeleton::learn(const bytes& a, const byte* x, const bytes& b, const byte* y, size_t width) {
+        if (width == 0 || a.size() != b.size() || a.size() < width) return skeleton{};
+
+        size_t first = 0;
+        while (first < a.size() && a[first] == b[first]) first++;
+        if (first + width > a.size()) return skeleton{};
+
+        size_t last = a.size();
+        while (last > first && a[last - 1] == b[last - 1]) last--;
+        if (last - first != width) return skeleton{};
+
+        if (!std::equal(x, x + width, a.begin() + first) || !std::equal(y, y + width, b.begin() + first)) return skeleton{};
+
+        skeleton s{};
+        s.Script = a;
+        s.Offset = first;
+        s.Width = width;
+        return s;
+    }
+
+}
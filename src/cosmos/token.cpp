@@ -0,0 +1,139 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/token.hpp>
+#include <iterator>
+
+namespace cosmos::token {
+
+    namespace {
+
+        // Consume t after any whitespace. If it is not
+        // there, the stream is left where it was.
+        bool expect(stringstream& ss, const char* t) {
+            ss >> std::ws;
+            const std::streampos start = ss.tellg();
+            for (const char* c = t; *c != 0; c++) if (ss.get() != *c) {
+                ss.clear();
+                ss.seekg(start);
+                return false;
+            }
+            return true;
+        }
+
+        constexpr const char* functions[] = {
+            "identity", "sha256", "sha512", "address", "public_key",
+            "update", "spend", "next_address", "evaluate_script", "stats"};
+
+        constexpr const char* constructors[] = {
+            "", "outpoint", "input", "output", "transaction", "", "wallet"};
+
+    }
+
+    const char* word(function f) {
+        return uint32(f) < std::size(functions) ? functions[f] : "";
+    }
+
+    const char* word(constructor c) {
+        return uint32(c) < std::size(constructors) ? constructors[c] : "";
+    }
+
+    bool lookup(const std::string& w, function& f) {
+        for (uint32 i = 0; i < std::size(functions); i++) if (w == functions[i]) {
+            f = function(i);
+            return true;
+        }
+        return false;
+    }
+
+    bool lookup(const std::string& w, constructor& c) {
+        if (w.empty()) return false;
+        for (uint32 i = 0; i < std::size(constructors); i++) if (w == constructors[i]) {
+            c = constructor(i);
+            return true;
+        }
+        return false;
+    }
+
+    void write<separator>::operator()(stringstream& ss) const {
+        ss << "; ";
+    }
+
+    bool read<separator>::operator()(stringstream& ss) const {
+        return expect(ss, ";");
+    }
+
+    void write<comma>::operator()(stringstream& ss) const {
+        ss << ", ";
+    }
+
+    bool read<comma>::operator()(stringstream& ss) const {
+        return expect(ss, ",");
+    }
+
+    void write<open_brace>::operator()(stringstream& ss) const {
+        ss << "{";
+    }
+
+    bool read<open_brace>::operator()(stringstream& ss) const {
+        return expect(ss, "{");
+    }
+
+    void write<close_brace>::operator()(stringstream& ss) const {
+        ss << "}";
+    }
+
+    bool read<close_brace>::operator()(stringstream& ss) const {
+        return expect(ss, "}");
+    }
+
+    void write<open_paren>::operator()(stringstream& ss) const {
+        ss << "(";
+    }
+
+    bool read<open_paren>::operator()(stringstream& ss) const {
+        return expect(ss, "(");
+    }
+
+    void write<close_paren>::operator()(stringstream& ss) const {
+        ss << ")";
+    }
+
+    bool read<close_paren>::operator()(stringstream& ss) const {
+        return expect(ss, ")");
+    }
+
+    void write<set>::operator()(stringstream& ss) const {
+        ss << " = ";
+    }
+
+    bool read<set>::operator()(stringstream& ss) const {
+        return expect(ss, "=");
+    }
+
+    void write<plus>::operator()(stringstream& ss) const {
+        ss << " + ";
+    }
+
+    bool read<plus>::operator()(stringstream& ss) const {
+        return expect(ss, "+");
+    }
+
+    void write<times>::operator()(stringstream& ss) const {
+        ss << " * ";
+    }
+
+    bool read<times>::operator()(stringstream& ss) const {
+        return expect(ss, "*");
+    }
+
+    void write<concat>::operator()(stringstream& ss) const {
+        ss << " <> ";
+    }
+
+    bool read<concat>::operator()(stringstream& ss) const {
+        return expect(ss, "<>");
+    }
+
+}
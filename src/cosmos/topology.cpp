@@ -0,0 +1,197 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/topology.hpp>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace cosmos::topology {
+
+    namespace {
+
+        constexpr size_t huge_page = size_t{2} << 20;
+
+        // the first line of a file in sysfs or proc, or "" if there is none.
+        std::string line(const std::string& path) {
+            std::ifstream in{path};
+            std::string l{};
+            std::getline(in, l);
+            return l;
+        }
+
+        // a list such as 0-3,8-11.
+        vector<uint32> cpulist(const std::string& s) {
+            vector<uint32> cpus{};
+            std::stringstream in{s};
+            std::string range{};
+            while (std::getline(in, range, ',')) {
+                if (range.empty()) continue;
+                size_t dash = range.find('-');
+                uint32 first = std::stoul(range.substr(0, dash));
+                uint32 last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                for (uint32 c = first; c <= last; c++) cpus.push_back(c);
+            }
+            return cpus;
+        }
+
+        cpu_set_t allowed() {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) != 0)
+                for (uint32 c = 0; c < std::thread::hardware_concurrency(); c++) CPU_SET(c, &set);
+            return set;
+        }
+
+        // a value in kB from a meminfo file, in which lines may
+        // begin with "Node n " before the name.
+        uint64_t meminfo(const std::string& path, const std::string& name) {
+            std::ifstream in{path};
+            std::string l{};
+            while (std::getline(in, l)) {
+                size_t i = l.find(name + ":");
+                if (i == std::string::npos) continue;
+                return std::stoull(l.substr(i + name.size() + 1));
+            }
+            return 0;
+        }
+
+        // the choice in brackets, as in "always [madvise] never".
+        std::string chosen(const std::string& s) {
+            size_t a = s.find('[');
+            size_t b = s.find(']');
+            if (a == std::string::npos || b == std::string::npos || b < a) return "unavailable";
+            return s.substr(a + 1, b - a - 1);
+        }
+
+    }
+
+    vector<node> nodes() {
+        const cpu_set_t set = allowed();
+        vector<node> n{};
+        for (uint32 i = 0; i < CPU_SETSIZE; i++) {
+            const std::string path = "/sys/devices/system/node/node" + std::to_string(i) + "/cpulist";
+            if (::access(path.c_str(), R_OK) != 0) continue;
+            node x{i, {}};
+            for (uint32 c : cpulist(line(path))) if (c < CPU_SETSIZE && CPU_ISSET(c, &set)) x.Cpus.push_back(c);
+            if (!x.Cpus.empty()) n.push_back(x);
+        }
+
+        if (n.empty()) {
+            node x{0, {}};
+            for (uint32 c = 0; c < CPU_SETSIZE; c++) if (CPU_ISSET(c, &set)) x.Cpus.push_back(c);
+            n.push_back(x);
+        }
+
+        return n;
+    }
+
+    uint32 node_of(uint32 cpu) {
+        for (const node& n : nodes()) for (uint32 c : n.Cpus) if (c == cpu) return n.Index;
+        return 0;
+    }
+
+    bool pin(uint32 cpu) {
+        if (cpu >= CPU_SETSIZE) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    uint32 cpu() {
+        int c = sched_getcpu();
+        return c < 0 ? 0 : uint32(c);
+    }
+
+    region::region(size_t size, bool huge) : Data{nullptr}, Size{size}, Mapped{0}, Backing{none} {
+        if (size == 0) return;
+        void* m = MAP_FAILED;
+
+        if (huge) {
+            Mapped = (size + huge_page - 1) / huge_page * huge_page;
+            m = ::mmap(nullptr, Mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (m != MAP_FAILED) Backing = hugetlb;
+            else {
+                // a huge page boundary inside a larger mapping, so
+                // that the kernel can back it with huge pages.
+                void* n = ::mmap(nullptr, Mapped + huge_page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (n != MAP_FAILED) {
+                    uintptr_t begin = reinterpret_cast<uintptr_t>(n);
+                    uintptr_t aligned = (begin + huge_page - 1) / huge_page * huge_page;
+                    if (aligned > begin) ::munmap(n, aligned - begin);
+                    if (aligned + Mapped < begin + Mapped + huge_page)
+                        ::munmap(reinterpret_cast<void*>(aligned + Mapped), begin + huge_page - aligned);
+                    m = reinterpret_cast<void*>(aligned);
+                    Backing = ::madvise(m, Mapped, MADV_HUGEPAGE) == 0 ? transparent : normal;
+                }
+            }
+        }
+
+        if (m == MAP_FAILED) {
+            Mapped = size;
+            m = ::mmap(nullptr, Mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (m == MAP_FAILED) throw std::bad_alloc{};
+            Backing = normal;
+        }
+
+        Data = static_cast<byte*>(m);
+
+        // first touch, which places the pages.
+        std::memset(Data, 0, Mapped);
+    }
+
+    region::~region() {
+        if (Data != nullptr) ::munmap(Data, Mapped);
+    }
+
+    region::region(region&& r) : Data{r.Data}, Size{r.Size}, Mapped{r.Mapped}, Backing{r.Backing} {
+        r.Data = nullptr;
+        r.Size = r.Mapped = 0;
+        r.Backing = none;
+    }
+
+    region& region::operator=(region&& r) {
+        if (this == &r) return *this;
+        if (Data != nullptr) ::munmap(Data, Mapped);
+        Data = r.Data;
+        Size = r.Size;
+        Mapped = r.Mapped;
+        Backing = r.Backing;
+        r.Data = nullptr;
+        r.Size = r.Mapped = 0;
+        r.Backing = none;
+        return *this;
+    }
+
+    const char* name(region::backing b) {
+        switch (b) {
+            case region::normal: return "4 kB pages";
+            case region::transparent: return "transparent huge pages";
+            case region::hugetlb: return "hugetlbfs 2 MB pages";
+            default: return "none";
+        }
+    }
+
+    void write(ostream& o) {
+        for (const node& n : nodes()) {
+            std::string info = "/sys/devices/system/node/node" + std::to_string(n.Index) + "/meminfo";
+            if (::access(info.c_str(), R_OK) != 0) info = "/proc/meminfo";
+            o << "node " << n.Index << ": " << n.Cpus.size() << " cpus (";
+            for (size_t i = 0; i < n.Cpus.size(); i++) o << (i == 0 ? "" : ",") << n.Cpus[i];
+            o << "), " << meminfo(info, "MemFree") / 1024 << " of " << meminfo(info, "MemTotal") / 1024 << " MB free\n";
+        }
+
+        const std::string pages = "/sys/kernel/mm/hugepages/hugepages-2048kB/";
+        o << "2 MB huge pages: " << line(pages + "free_hugepages") << " free of " << line(pages + "nr_hugepages") << "\n";
+        o << "transparent huge pages: " << chosen(line("/sys/kernel/mm/transparent_hugepage/enabled")) << "\n";
+    }
+
+}
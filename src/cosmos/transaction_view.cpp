@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/transaction_view.hpp>
+#include <cosmos/crypto/sha256.hpp>
+
+namespace cosmos::bitcoin {
+
+    transaction_view transaction_view::read(bytes b) {
+        ptr<index> x = std::make_shared<index>();
+        x->Data = std::move(b);
+
+        const byte* begin = x->Data.data();
+        wire::reader r{begin, begin + x->Data.size()};
+        auto offset = [&r, begin]() -> uint32 {
+            return uint32(r.position() - begin);
+        };
+
+        x->Version = r.read<uint32>();
+        x->Witness = false;
+        if (r.peek() == 0) {
+            r.skip(1);
+            if (r.read<byte>() != 1) return {};
+            x->Witness = true;
+        }
+
+        x->Body = offset();
+
+        uint64_t inputs = r.varint();
+        if (!r.valid() || inputs > r.remaining() / 41) return {};
+        x->Inputs.reserve(inputs);
+        for (uint64_t i = 0; i < inputs; i++) {
+            entry e{offset(), 0, 0};
+            r.skip(36);
+            wire::slice script = r.var_bytes();
+            r.skip(4);
+            if (!r.valid()) return {};
+            e.Script = uint32(script.Begin - begin);
+            e.ScriptSize = uint32(script.size());
+            x->Inputs.push_back(e);
+        }
+
+        uint64_t outputs = r.varint();
+        if (!r.valid() || outputs > r.remaining() / 9) return {};
+        x->Outputs.reserve(outputs);
+        for (uint64_t i = 0; i < outputs; i++) {
+            entry e{offset(), 0, 0};
+            r.skip(8);
+            wire::slice script = r.var_bytes();
+            if (!r.valid()) return {};
+            e.Script = uint32(script.Begin - begin);
+            e.ScriptSize = uint32(script.size());
+            x->Outputs.push_back(e);
+        }
+
+        x->BodyEnd = offset();
+
+        if (x->Witness)
+            for (uint64_t i = 0; i < inputs && r.valid(); i++) {
+                uint64_t items = r.varint();
+                for (uint64_t j = 0; j < items && r.valid(); j++) r.var_bytes();
+            }
+
+        x->Locktime = r.read<uint32>();
+        if (!r.valid() || r.remaining() != 0) return {};
+
+        return transaction_view{x};
+    }
+
+    transaction_view::input transaction_view::get_input(size_t i) const {
+        const entry& e = Index->Inputs[i];
+        const byte* b = Index->Data.data();
+
+        wire::reader r{b + e.Begin, b + Index->Data.size()};
+        input in{};
+        wire::slice txid = r.take(32);
+        std::copy(txid.Begin, txid.End, in.Outpoint.Txid.begin());
+        in.Outpoint.Index = r.read<uint32>();
+        in.Script = wire::slice{b + e.Script, b + e.Script + e.ScriptSize};
+
+        wire::reader s{in.Script.End, b + Index->Data.size()};
+        in.Sequence = s.read<uint32>();
+        return in;
+    }
+
+    transaction_view::output transaction_view::get_output(size_t j) const {
+        const entry& e = Index->Outputs[j];
+        const byte* b = Index->Data.data();
+        wire::reader r{b + e.Begin, b + Index->Data.size()};
+        uint64_t value = r.read<uint64_t>();
+        return output{value, wire::slice{b + e.Script, b + e.Script + e.ScriptSize}};
+    }
+
+    const std::array<byte, 32>& transaction_view::id() const {
+        index& x = *Index;
+        std::call_once(x.Hashed, [&x]() {
+            const byte* b = x.Data.data();
+            if (!x.Witness) {
+                x.Id = crypto::sha256::hash256(b, x.Data.size());
+                return;
+            }
+
+            crypto::sha256 h{};
+            h.update(b, 4);
+            h.update(b + x.Body, x.BodyEnd - x.Body);
+            h.update(b + x.Data.size() - 4, 4);
+            crypto::sha256::digest d = h.finish();
+            x.Id = crypto::sha256::hash(d.data(), d.size());
+        });
+
+        return x.Id;
+    }
+
+}
@@ -0,0 +1,320 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/utxo.hpp>
+#include <limits>
+
+namespace cosmos::bitcoin::utxo {
+
+    namespace {
+
+        // The priority of a node in the treaps, which is the same for
+        // every key of an output. The hash is mixed so that outputs of
+        // one transaction, or keys made in order, don't make a list.
+        uint64_t priority(const outpoint& o) {
+            uint64_t x = hash{}(o) ^ (uint64_t(o.Index) * 0x9e3779b97f4a7c15);
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+            return x ^ (x >> 31);
+        }
+
+        const outpoint least{{}, 0};
+
+    }
+
+    template <typename key>
+    struct index::node {
+        key Key;
+        ptr<const entry> Entry;
+        uint64_t Priority;
+        ptr<const node> Left;
+        ptr<const node> Right;
+
+        static ptr<const node> make(const node& n, ptr<const node> l, ptr<const node> r) {
+            return std::make_shared<const node>(node{n.Key, n.Entry, n.Priority, l, r});
+        }
+
+        static const node* find(const node* n, const key& k) {
+            while (n != nullptr) {
+                if (k < n->Key) n = n->Left.get();
+                else if (n->Key < k) n = n->Right.get();
+                else return n;
+            }
+
+            return nullptr;
+        }
+
+        // l gets the keys less than k and r the rest.
+        static void split(const ptr<const node>& n, const key& k, ptr<const node>& l, ptr<const node>& r) {
+            if (n == nullptr) {
+                l = r = nullptr;
+                return;
+            }
+
+            ptr<const node> x{};
+            if (n->Key < k) {
+                split(n->Right, k, x, r);
+                l = make(*n, n->Left, x);
+            } else {
+                split(n->Left, k, l, x);
+                r = make(*n, x, n->Right);
+            }
+        }
+
+        // every key of l is less than every key of r.
+        static ptr<const node> merge(const ptr<const node>& l, const ptr<const node>& r) {
+            if (l == nullptr) return r;
+            if (r == nullptr) return l;
+            if (l->Priority > r->Priority) return make(*l, l->Left, merge(l->Right, r));
+            return make(*r, merge(l, r->Left), r->Right);
+        }
+
+        // k must not be here already.
+        static ptr<const node> insert(const ptr<const node>& n, const node& x) {
+            if (n == nullptr || x.Priority > n->Priority) {
+                ptr<const node> l{};
+                ptr<const node> r{};
+                split(n, x.Key, l, r);
+                return make(x, l, r);
+            }
+
+            if (x.Key < n->Key) return make(*n, insert(n->Left, x), n->Right);
+            return make(*n, n->Left, insert(n->Right, x));
+        }
+
+        // k must be here.
+        static ptr<const node> remove(const ptr<const node>& n, const key& k) {
+            if (k < n->Key) return make(*n, remove(n->Left, k), n->Right);
+            if (n->Key < k) return make(*n, n->Left, remove(n->Right, k));
+            return merge(n->Left, n->Right);
+        }
+
+        // in order from the least key not less than k, until f returns false.
+        template <typename function>
+        static bool ascending(const node* n, const key& k, function f) {
+            if (n == nullptr) return true;
+            if (!(n->Key < k) && (!ascending(n->Left.get(), k, f) || !f(*n->Entry))) return false;
+            return ascending(n->Right.get(), k, f);
+        }
+
+        // in reverse order from the greatest key less than k.
+        template <typename function>
+        static bool descending(const node* n, const key* k, function f) {
+            if (n == nullptr) return true;
+            if ((k == nullptr || n->Key < *k) && (!descending(n->Right.get(), k, f) || !f(*n->Entry))) return false;
+            return descending(n->Left.get(), k, f);
+        }
+    };
+
+    const entry* index::find(const outpoint& o) const {
+        const node<outpoint>* n = node<outpoint>::find(Outputs.get(), o);
+        if (n == nullptr) return nullptr;
+        return n->Entry.get();
+    }
+
+    vector<outpoint> index::find(const keys::hash160& a) const {
+        vector<outpoint> x{};
+        node<std::pair<keys::hash160, outpoint>>::ascending(ByAddress.get(), {a, least}, [&x, &a](const entry& e) -> bool {
+            if (e.Address != a) return false;
+            x.push_back(e.Outpoint);
+            return true;
+        });
+
+        return x;
+    }
+
+    void index::ascending(uint64_t v, std::function<bool(const entry&)> f) const {
+        node<std::pair<uint64_t, outpoint>>::ascending(ByValue.get(), {v, least}, f);
+    }
+
+    void index::descending(uint64_t v, std::function<bool(const entry&)> f) const {
+        const std::pair<uint64_t, outpoint> k{v, least};
+        node<std::pair<uint64_t, outpoint>>::descending(ByValue.get(), &k, f);
+    }
+
+    void index::descending(std::function<bool(const entry&)> f) const {
+        node<std::pair<uint64_t, outpoint>>::descending(ByValue.get(), nullptr, f);
+    }
+
+    bool index::insert(entry e) {
+        if (find(e.Outpoint) != nullptr) return false;
+        const uint64_t p = priority(e.Outpoint);
+        ptr<const entry> x = std::make_shared<const entry>(std::move(e));
+
+        Outputs = node<outpoint>::insert(Outputs, {x->Outpoint, x, p, nullptr, nullptr});
+        ByValue = node<std::pair<uint64_t, outpoint>>::insert(ByValue, {{x->Value, x->Outpoint}, x, p, nullptr, nullptr});
+        ByAddress = node<std::pair<keys::hash160, outpoint>>::insert(ByAddress, {{x->Address, x->Outpoint}, x, p, nullptr, nullptr});
+        Size++;
+        Total += x->Value;
+        return true;
+    }
+
+    bool index::remove(const outpoint& o) {
+        const node<outpoint>* n = node<outpoint>::find(Outputs.get(), o);
+        if (n == nullptr) return false;
+
+        // the entry lives in the nodes that are about to go.
+        const ptr<const entry> x = n->Entry;
+        Outputs = node<outpoint>::remove(Outputs, o);
+        ByValue = node<std::pair<uint64_t, outpoint>>::remove(ByValue, {x->Value, o});
+        ByAddress = node<std::pair<keys::hash160, outpoint>>::remove(ByAddress, {x->Address, o});
+        Size--;
+        Total -= x->Value;
+        return true;
+    }
+
+    void index::update(const vector<outpoint>& spent, const vector<entry>& created) {
+        for (const outpoint& o : spent) remove(o);
+        for (const entry& e : created) insert(e);
+    }
+
+    size_t index::memory() const {
+        // each allocation by make_shared also holds two counts.
+        constexpr size_t shared = 2 * sizeof(long);
+        size_t m = sizeof(index) + Size * (4 * shared + sizeof(entry) + sizeof(node<outpoint>) +
+            sizeof(node<std::pair<uint64_t, outpoint>>) + sizeof(node<std::pair<keys::hash160, outpoint>>));
+
+        ascending(0, [&m](const entry& e) -> bool {
+            m += e.Script.capacity();
+            return true;
+        });
+
+        return m;
+    }
+
+    namespace {
+
+        constexpr uint32 tries = 100000;
+
+        struct coin {
+            outpoint Outpoint;
+            uint64_t Value;
+
+            // value minus the cost of spending it.
+            uint64_t Effective;
+        };
+
+        selection make(const vector<coin>& coins, uint64_t cost, bool change) {
+            selection s{{}, 0, 0, change};
+            for (const coin& c : coins) {
+                s.Inputs.push_back(c.Outpoint);
+                s.Value += c.Value;
+                s.Fee += cost;
+            }
+
+            return s;
+        }
+
+        // coins must be sorted by decreasing value. Returns
+        // the selection wasting the least, or empty.
+        vector<coin> branch_and_bound(const vector<coin>& pool, uint64_t target, uint64_t tolerance) {
+            uint64_t available = 0;
+            for (const coin& c : pool) available += c.Effective;
+            if (available < target) return {};
+
+            vector<size_t> current{};
+            vector<size_t> best{};
+            uint64_t value = 0;
+            uint64_t waste = std::numeric_limits<uint64_t>::max();
+
+            size_t i = 0;
+            for (uint32 t = 0; t < tries; t++, i++) {
+                bool backtrack = false;
+                if (value + available < target || value > target + tolerance) backtrack = true;
+                else if (value >= target) {
+                    if (value - target < waste) {
+                        best = current;
+                        waste = value - target;
+                        if (waste == 0) break;
+                    }
+
+                    backtrack = true;
+                }
+
+                if (backtrack) {
+                    if (current.empty()) break;
+
+                    // put back the coins skipped since the last one
+                    // included and then try leaving that one out.
+                    for (i--; i > current.back(); i--) available += pool[i].Effective;
+                    value -= pool[i].Effective;
+                    current.pop_back();
+                    continue;
+                }
+
+                available -= pool[i].Effective;
+
+                // excluding a coin and including an identical
+                // one next gives the same result, so don't.
+                if (current.empty() || i - 1 == current.back() || pool[i].Effective != pool[i - 1].Effective) {
+                    current.push_back(i);
+                    value += pool[i].Effective;
+                }
+            }
+
+            vector<coin> x{};
+            for (size_t j : best) x.push_back(pool[j]);
+            return x;
+        }
+
+    }
+
+    selection select(const index& x, const request& r) {
+        const uint64_t cost = r.InputCost;
+
+        auto make_coin = [cost](const entry& e) -> coin {
+            return coin{e.Outpoint, e.Value, e.Value - cost};
+        };
+
+        // the least output worth at least v.
+        auto least_from = [&x](uint64_t v) -> const entry* {
+            const entry* e = nullptr;
+            x.ascending(v, [&e](const entry& y) -> bool {
+                e = &y;
+                return false;
+            });
+
+            return e;
+        };
+
+        // a single output which needs no change.
+        const entry* single = least_from(r.Target + cost);
+        if (single != nullptr && single->Value <= r.Target + cost + r.ChangeCost)
+            return make({make_coin(*single)}, cost, false);
+
+        // branch and bound over the outputs that could be part of
+        // a selection without change, which are those no larger
+        // than the target plus the tolerance.
+        {
+            vector<coin> pool{};
+            x.descending(r.Target + cost + r.ChangeCost + 1, [&pool, &make_coin, cost](const entry& e) -> bool {
+                if (e.Value <= cost) return false;
+                pool.push_back(make_coin(e));
+                return true;
+            });
+
+            vector<coin> found = branch_and_bound(pool, r.Target, r.ChangeCost);
+            if (!found.empty()) return make(found, cost, false);
+        }
+
+        // with change.
+        const uint64_t need = r.Target + r.ChangeCost + r.MinChange;
+        const entry* enough = least_from(need + cost);
+        if (enough != nullptr) return make({make_coin(*enough)}, cost, true);
+
+        vector<coin> largest{};
+        uint64_t total = 0;
+        x.descending([&](const entry& e) -> bool {
+            if (total >= need || e.Value <= cost) return false;
+            largest.push_back(make_coin(e));
+            total += largest.back().Effective;
+            return true;
+        });
+
+        if (total >= need) return make(largest, cost, true);
+        if (total >= r.Target) return make(largest, cost, false);
+        return selection{{}, 0, 0, false};
+    }
+
+}
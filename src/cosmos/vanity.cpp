@@ -0,0 +1,187 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/vanity.hpp>
+#include <cosmos/secp256k1.hpp>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+namespace cosmos::bitcoin::vanity {
+
+    namespace {
+
+        using secp256k1::integer;
+
+        const char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+        // more than this many variants of a
+        // case-insensitive pattern is an error.
+        constexpr uint32 max_variants = 1 << 12;
+
+        int digit(char c) {
+            const char* p = std::strchr(alphabet, c);
+            if (c == 0 || p == nullptr) return -1;
+            return int(p - alphabet);
+        }
+
+        // number of digests in an interval, as a fraction of all of them.
+        double width(const interval& i) {
+            integer a{i.First};
+            integer b{i.Last};
+            mpz_sub(b.Value, b.Value, a.Value);
+            mpz_add_ui(b.Value, b.Value, 1);
+            return std::ldexp(mpz_get_d(b.Value), -160);
+        }
+
+        void merge(vector<interval>& x) {
+            std::sort(x.begin(), x.end(), [](const interval& a, const interval& b) -> bool {
+                return a.First < b.First;
+            });
+
+            vector<interval> merged{};
+            for (const interval& i : x) {
+                if (!merged.empty() && i.First <= merged.back().Last) {
+                    if (merged.back().Last < i.Last) merged.back().Last = i.Last;
+                } else merged.push_back(i);
+            }
+
+            x = merged;
+        }
+
+        // The address is '1' for the version byte, a '1' for each leading
+        // zero byte of the digest and then the rest of the digest and the
+        // checksum as a base 58 number. For each length that number could
+        // have, the digits we want give a range of numbers and therefore
+        // a range of digests.
+        void intervals(const std::string& p, vector<interval>& out) {
+            size_t ones = 0;
+            while (ones < p.size() && p[ones] == '1') ones++;
+            if (ones == 0) throw error{"pay-to-address addresses begin with 1"};
+
+            size_t zeros = ones - 1;
+            std::string rest = p.substr(ones);
+
+            if (zeros > 20 || (zeros == 20 && !rest.empty()))
+                throw error{"too many leading 1s in " + p};
+
+            integer first{};
+            integer last{};
+
+            // the digest need only begin with this many zero bytes.
+            if (rest.empty()) {
+                mpz_setbit(last.Value, 8 * (20 - zeros));
+                mpz_sub_ui(last.Value, last.Value, 1);
+                out.push_back(interval{first.fixed<20>(), last.fixed<20>()});
+                return;
+            }
+
+            // the number we encode has the remaining digest bytes and
+            // the checksum, and its first byte is not zero.
+            const size_t size = 24 - zeros;
+            integer least{};
+            integer most{};
+            mpz_setbit(least.Value, 8 * (size - 1));
+            mpz_setbit(most.Value, 8 * size);
+            mpz_sub_ui(most.Value, most.Value, 1);
+
+            integer value{};
+            for (char c : rest) {
+                mpz_mul_ui(value.Value, value.Value, 58);
+                mpz_add_ui(value.Value, value.Value, digit(c));
+            }
+
+            integer scale{};
+            mpz_set_ui(scale.Value, 1);
+            while (true) {
+                mpz_mul(first.Value, value.Value, scale.Value);
+                if (mpz_cmp(first.Value, most.Value) > 0) return;
+
+                mpz_add_ui(last.Value, value.Value, 1);
+                mpz_mul(last.Value, last.Value, scale.Value);
+                mpz_sub_ui(last.Value, last.Value, 1);
+
+                if (mpz_cmp(first.Value, least.Value) < 0) mpz_set(first.Value, least.Value);
+                if (mpz_cmp(last.Value, most.Value) > 0) mpz_set(last.Value, most.Value);
+
+                if (mpz_cmp(first.Value, last.Value) <= 0) {
+                    mpz_fdiv_q_2exp(first.Value, first.Value, 32);
+                    mpz_fdiv_q_2exp(last.Value, last.Value, 32);
+                    out.push_back(interval{first.fixed<20>(), last.fixed<20>()});
+                }
+
+                mpz_mul_ui(scale.Value, scale.Value, 58);
+            }
+        }
+
+        // every way of writing the pattern with letters in either case.
+        vector<std::string> variants(const std::string& p, bool case_sensitive) {
+            vector<std::string> v{""};
+            for (char c : p) {
+                vector<char> options{};
+                if (digit(c) >= 0) options.push_back(c);
+                if (!case_sensitive && std::isalpha(c)) {
+                    char d = std::islower(c) ? std::toupper(c) : std::tolower(c);
+                    if (digit(d) >= 0) options.push_back(d);
+                }
+
+                if (options.empty()) throw error{std::string{"'"} + c + "' is not a base 58 character"};
+                if (v.size() * options.size() > max_variants) throw error{"too many variants of " + p};
+
+                vector<std::string> next{};
+                for (const std::string& x : v) for (char o : options) next.push_back(x + o);
+                v = next;
+            }
+
+            return v;
+        }
+
+        bool equal(char a, char b, bool case_sensitive) {
+            return case_sensitive ? a == b : std::tolower(a) == std::tolower(b);
+        }
+
+    }
+
+    bool prefix::matches(const std::string& address) const {
+        if (address.size() < Pattern.size()) return false;
+        for (size_t i = 0; i < Pattern.size(); i++)
+            if (!equal(address[i], Pattern[i], CaseSensitive)) return false;
+        return true;
+    }
+
+    prefix compile(const std::string& pattern, bool case_sensitive) {
+        prefix p{pattern, case_sensitive, {}, 0};
+        for (const std::string& v : variants(pattern, case_sensitive)) intervals(v, p.Intervals);
+        merge(p.Intervals);
+        for (const interval& i : p.Intervals) p.Probability += width(i);
+        return p;
+    }
+
+    pattern::pattern(vector<prefix> p) : Prefixes{p}, First{}, Last{}, Probability{0} {
+        vector<interval> all{};
+        for (const prefix& x : Prefixes) all.insert(all.end(), x.Intervals.begin(), x.Intervals.end());
+        merge(all);
+
+        for (const interval& i : all) {
+            First.push_back(i.First);
+            Last.push_back(i.Last);
+            Probability += width(i);
+        }
+    }
+
+    vector<uint32> pattern::match(const std::string& address) const {
+        vector<uint32> m{};
+        for (uint32 i = 0; i < Prefixes.size(); i++) if (Prefixes[i].matches(address)) m.push_back(i);
+        return m;
+    }
+
+    void pattern::write(ostream& o) const {
+        for (const prefix& p : Prefixes)
+            o << p.Pattern << (p.CaseSensitive ? "" : " (any case)") << ": " << p.Intervals.size()
+                << " ranges, 1 in " << std::setprecision(3) << p.difficulty() << "\n";
+        o << "any: 1 in " << std::setprecision(3) << 1 / Probability << "\n";
+    }
+
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/verify.hpp>
+#include <cosmos/secp256k1.hpp>
+#include <cosmos/precompute.hpp>
+#include <cosmos/scan.hpp>
+
+namespace cosmos::bitcoin::verify {
+
+    namespace {
+
+        using secp256k1::order;
+        using secp256k1::integer;
+
+        // BIP 66, without the sighash byte.
+        bool strict(wire::slice d) {
+            const size_t size = d.size();
+            if (size < 8 || size > 72) return false;
+            if (d[0] != 0x30 || d[1] != size - 2) return false;
+
+            const size_t r = d[3];
+            if (d[2] != 0x02 || r == 0 || 5 + r >= size) return false;
+
+            const size_t s = d[5 + r];
+            if (d[4 + r] != 0x02 || s == 0 || r + s + 6 != size) return false;
+
+            // positive and minimally encoded.
+            if (d[4] & 0x80) return false;
+            if (r > 1 && d[4] == 0 && !(d[5] & 0x80)) return false;
+            if (d[6 + r] & 0x80) return false;
+            if (s > 1 && d[6 + r] == 0 && !(d[7 + r] & 0x80)) return false;
+
+            return true;
+        }
+
+        // a direct push of between 1 and 75 bytes.
+        bool push(wire::reader& r, wire::slice& x) {
+            int n = r.peek();
+            if (n < 1 || n > 75) return false;
+            r.skip(1);
+            x = r.take(n);
+            return r.valid();
+        }
+
+    }
+
+    result signature(const keys::pubkey_bytes& p, wire::slice der, const crypto::sha256::digest& message) {
+        if (!strict(der)) return unknown;
+
+        integer n{order};
+        integer r{der.Begin + 4, der[3]};
+        integer s{der.Begin + 6 + der[3], der[5 + der[3]]};
+
+        // high S is malleable and refused under some flags.
+        integer half{};
+        mpz_fdiv_q_2exp(half.Value, n.Value, 1);
+        if (mpz_cmp(s.Value, half.Value) > 0) return unknown;
+
+        if (mpz_sgn(r.Value) == 0 || mpz_sgn(s.Value) == 0 || mpz_cmp(r.Value, n.Value) >= 0) return reject;
+
+        // u1 = z / s and u2 = r / s
+        integer w{};
+        integer u1{message};
+        integer u2{};
+        mpz_invert(w.Value, s.Value, n.Value);
+        mpz_mul(u1.Value, u1.Value, w.Value);
+        mpz_mod(u1.Value, u1.Value, n.Value);
+        mpz_mul(u2.Value, r.Value, w.Value);
+        mpz_mod(u2.Value, u2.Value, n.Value);
+
+        keys::secret_bytes a{};
+        keys::secret_bytes b{};
+        if (mpz_sgn(u1.Value) == 0 || !u1.write(a) || !u2.write(b)) return unknown;
+
+        // u1 G + u2 P, using the tables we already keep for signing.
+        keys::pubkey_bytes x = keys::write(precompute::to_public(keys::read_secret(a)));
+        keys::pubkey_bytes y = keys::write(precompute::times(keys::read_pubkey(p), keys::read_secret(b)));
+
+        // doubling or the point at infinity; not worth a special case.
+        if (std::equal(x.begin() + 1, x.end(), y.begin() + 1)) return unknown;
+
+        keys::pubkey_bytes R = keys::write(keys::read_pubkey(x) + keys::read_pubkey(y));
+        integer rx{R.data() + 1, 32};
+        mpz_mod(rx.Value, rx.Value, n.Value);
+        return mpz_cmp(rx.Value, r.Value) == 0 ? accept : reject;
+    }
+
+    namespace {
+
+        sign::transaction unsigned_transaction(const transaction_view& v, const vector<previous>& p) {
+            sign::transaction t{v.version(), {}, {}, v.locktime()};
+            for (size_t i = 0; i < v.inputs(); i++) {
+                transaction_view::input x = v.get_input(i);
+                t.Inputs.push_back(sign::input{x.Outpoint, p[i].Value, p[i].Script, x.Sequence, secret{}, {}});
+            }
+
+            for (size_t j = 0; j < v.outputs(); j++) {
+                transaction_view::output x = v.get_output(j);
+                t.Outputs.push_back(sign::output{x.Value, bytes(x.Script.Begin, x.Script.End)});
+            }
+
+            return t;
+        }
+
+    }
+
+    transaction::transaction(transaction_view v, const vector<previous>& p) :
+        View{v}, Unsigned{unsigned_transaction(v, p)}, Preimage{Unsigned} {}
+
+    result transaction::input(uint32 i) const {
+        const sign::input& in = Unsigned.Inputs[i];
+
+        keys::hash160 address{};
+        if (!scan::pay_to_address(wire::slice{in.Script.data(), in.Script.data() + in.Script.size()}, address)) return unknown;
+
+        wire::slice sig{};
+        wire::slice key{};
+        wire::reader r{View.get_input(i).Script};
+        if (!push(r, sig) || !push(r, key) || r.remaining() != 0) return unknown;
+
+        if (key.size() != 33 || (key[0] != 0x02 && key[0] != 0x03)) return unknown;
+        if (sig[sig.size() - 1] != sign::sighash_all) return unknown;
+
+        keys::pubkey_bytes p{};
+        std::copy(key.Begin, key.End, p.begin());
+        pubkey k = keys::read_pubkey(p);
+
+        // the machine would fail OP_CHECKSIG, but let
+        // it decide what an invalid point means.
+        if (!k.valid()) return unknown;
+
+        if (keys::write(k.address()) != address) return reject;
+
+        return signature(p, wire::slice{sig.Begin, sig.End - 1}, Preimage.digest(i));
+    }
+
+}
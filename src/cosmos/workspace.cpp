@@ -0,0 +1,117 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/workspace.hpp>
+
+namespace cosmos::work {
+
+    namespace {
+
+        template <typename it>
+        std::string hex(it begin, it end) {
+            constexpr char digits[] = "0123456789abcdef";
+            std::string x{};
+            for (it i = begin; i != end; i++) {
+                x.push_back(digits[*i >> 4]);
+                x.push_back(digits[*i & 15]);
+            }
+            return x;
+        }
+
+        ptr<expression> text(const std::string& x) {
+            return std::make_shared<expression::atomic<std::string>>(x);
+        }
+
+        expression::parameters ordered(const vector<ptr<expression>>& v) {
+            expression::parameters p{};
+            for (auto i = v.rbegin(); i != v.rend(); i++) p = p.prepend(*i);
+            return p;
+        }
+
+    }
+
+    // every name as it would be set.
+    ptr<expression> space::express() const {
+        vector<ptr<expression>> x{};
+        for (const auto& e : Contents) if (e.Value != nullptr)
+            x.push_back(std::make_shared<expression::operation<cosmos::set>>(ordered({
+                std::make_shared<expression::atomic<name>>(e.Key), e.Value->express()})));
+        return std::make_shared<expression::list>(ordered(x));
+    }
+
+    // spent outpoints are written with a minus and created
+    // outputs with a plus, in the order they are applied.
+    ptr<expression> changes::express() const {
+        vector<ptr<expression>> x{};
+        for (const bitcoin::utxo::outpoint& o : Spent)
+            x.push_back(text("-" + hex(o.Txid.begin(), o.Txid.end()) + ":" + std::to_string(o.Index)));
+        for (const bitcoin::utxo::entry& e : Created) {
+            const bitcoin::utxo::outpoint& o = e.Outpoint;
+            x.push_back(text("+" + hex(o.Txid.begin(), o.Txid.end()) + ":" + std::to_string(o.Index) + ":" + std::to_string(e.Value)));
+        }
+        return std::make_shared<expression::list>(ordered(x));
+    }
+
+    // outputs are written by value and then outpoint, which is
+    // the order they are kept in, so equal wallets write the same.
+    ptr<expression> wallet::express() const {
+        vector<ptr<expression>> x{};
+        Outputs->ascending(0, [&x](const bitcoin::utxo::entry& e) -> bool {
+            const bitcoin::utxo::outpoint& o = e.Outpoint;
+            x.push_back(text(hex(o.Txid.begin(), o.Txid.end()) + ":" + std::to_string(o.Index) + ":" + std::to_string(e.Value)));
+            return true;
+        });
+        return std::make_shared<expression::construction<cosmos::wallet>>(ordered(x));
+    }
+
+    ptr<expression> keysource::express() const {
+        if (Chain == nullptr) return text("keysource");
+        const bitcoin::bip32::extended& k = Chain->key();
+        return text("keysource " + hex(k.Pubkey.begin(), k.Pubkey.end()) + " " +
+            hex(k.ChainCode.begin(), k.ChainCode.end()) + " " + std::to_string(Next));
+    }
+
+    ptr<expression> watch::express() const {
+        vector<ptr<expression>> x{};
+        for (const bitcoin::keys::pubkey_bytes& p : Watched->Pubkeys)
+            x.push_back(std::make_shared<expression::atomic<bitcoin::pubkey>>(bitcoin::keys::read_pubkey(p)));
+
+        // secrets as WIF, which says whether they are compressed.
+        for (const ptr<const bitcoin::keyring::entry>& e : Watched->Secrets)
+            x.push_back(text(bitcoin::base58::write_wif(bitcoin::keys::write(e->Secret), e->Compressed)));
+        return std::make_shared<expression::list>(ordered(x));
+    }
+
+    ptr<expression> transaction::express() const {
+        wire::slice b = View.write();
+        return text(hex(b.Begin, b.End));
+    }
+
+    space space::set(name n, ptr<item> i) const {
+        // keys are indexed as they are set, so they never have to be
+        // searched for. The old space keeps the ring it had.
+        space s = index(i);
+        s.Contents = Contents.insert(n, i);
+        return s;
+    }
+
+    space space::index(ptr<item> i) const {
+        space s{*this};
+        if (i != nullptr) s.Keys = i->index(Keys);
+        return s;
+    }
+
+    ptr<item> space::get(name n) const {
+        return Contents.contains(n) ? Contents[n] : nullptr;
+    }
+
+    space space::import(name n, const std::string& text, bitcoin::import::report& r) const {
+        // the pubkeys are collected in place and never copied again.
+        ptr<bitcoin::import::watched> w = std::make_shared<bitcoin::import::watched>();
+        r = bitcoin::import::keys(text, Keys, *w);
+        if (w->Secrets.empty() && w->Pubkeys.empty()) return *this;
+        return set(n, std::make_shared<watch>(w));
+    }
+
+}
@@ -0,0 +1,155 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/base58.hpp>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        bytes hex(const std::string& x) {
+            bytes b{};
+            for (size_t i = 0; i + 1 < x.size(); i += 2) b.push_back(byte(std::stoi(x.substr(i, 2), nullptr, 16)));
+            return b;
+        }
+
+    }
+
+    // vectors from Bitcoin Core's base58_encode_decode.json.
+    TEST(Base58Test, TestVectors) {
+        const vector<std::pair<std::string, std::string>> vectors{
+            {"61", "2g"}, {"626262", "a3gV"}, {"636363", "aPEr"},
+            {"73696d706c792061206c6f6e6720737472696e67", "2cFupjhnEsSn59qHXstmK2ffpLv2"},
+            {"00eb15231dfceb60925886b67d065299925915aeb172c06647", "1NS17iag9jJgTHD1VXjvLCEnZuQ3rJDE9L"},
+            {"516b6fcd0f", "ABnLTmg"}, {"bf4f89001e670274dd", "3SEo3LWLoPntC"}, {"572e4794", "3EFU7m"},
+            {"ecac89cad93923c02321", "EJDM8drfXA6uyA"}, {"10c8511e", "Rt5zm"}, {"00000000000000000000", "1111111111"}};
+
+        for (const auto& v : vectors) {
+            bytes b = hex(v.first);
+            EXPECT_EQ(base58::encode(b.data(), b.size()), v.second);
+
+            bytes d(b.size());
+            EXPECT_TRUE(base58::decode(v.second, d.data(), d.size())) << v.second;
+            EXPECT_EQ(d, b);
+        }
+    }
+
+    // random lengths up to the largest we take, with leading zeros.
+    TEST(Base58Test, TestRoundTrip) {
+        std::mt19937_64 random{40};
+        for (int i = 0; i < 2000; i++) {
+            bytes b(1 + random() % 64);
+            for (byte& x : b) x = byte(random());
+            for (size_t z = random() % 4; z > 0 && z <= b.size(); z--) b[z - 1] = 0;
+
+            std::string s = base58::encode(b.data(), b.size());
+            bytes d(b.size());
+            ASSERT_TRUE(base58::decode(s, d.data(), d.size())) << s;
+            EXPECT_EQ(d, b);
+        }
+    }
+
+    TEST(Base58Test, TestCheck) {
+        keys::hash160 genesis{};
+        bytes g = hex("62e907b15cbf27d5425399ebf6f0fb50ebb88f18");
+        std::copy(g.begin(), g.end(), genesis.begin());
+
+        EXPECT_EQ(base58::write_address(keys::hash160{}), "1111111111111111111114oLvT2");
+        EXPECT_EQ(base58::write_address(genesis), "1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNa");
+
+        keys::hash160 a{};
+        EXPECT_TRUE(base58::read_address("1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNa", a));
+        EXPECT_EQ(a, genesis);
+
+        keys::secret_bytes one{};
+        one[31] = 1;
+        EXPECT_EQ(base58::write_wif(one), "KwDiBf89QgGbjEhKnhXJuH7LrciVrZi3qYjgd9M7rFU73sVHnoWn");
+        EXPECT_EQ(base58::write_wif(one, false), "5HpHagT65TZzG1PH3CSu63k8DbpvD8s5ip4nEB3kEsreAnchuDf");
+
+        keys::secret_bytes k{};
+        bool compressed = false;
+        EXPECT_TRUE(base58::read_wif("KwDiBf89QgGbjEhKnhXJuH7LrciVrZi3qYjgd9M7rFU73sVHnoWn", k, compressed));
+        EXPECT_EQ(k, one);
+        EXPECT_TRUE(compressed);
+        EXPECT_TRUE(base58::read_wif("5HpHagT65TZzG1PH3CSu63k8DbpvD8s5ip4nEB3kEsreAnchuDf", k, compressed));
+        EXPECT_EQ(k, one);
+        EXPECT_FALSE(compressed);
+
+        // many at once, in order.
+        std::mt19937_64 random{140};
+        vector<keys::hash160> addresses(100);
+        for (keys::hash160& x : addresses) for (byte& b : x) b = byte(random());
+        vector<std::string> written = base58::write_addresses(addresses);
+        ASSERT_EQ(written.size(), addresses.size());
+        for (size_t i = 0; i < addresses.size(); i++) {
+            EXPECT_TRUE(base58::read_address(written[i], a));
+            EXPECT_EQ(a, addresses[i]);
+        }
+    }
+
+    TEST(Base58Test, TestInvalid) {
+        keys::hash160 a{};
+        keys::secret_bytes k{};
+        bool compressed = false;
+        const std::string genesis = "1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNa";
+
+        // characters that are not base58.
+        for (char c : {'0', 'O', 'I', 'l', '+', ' '}) {
+            std::string x = genesis;
+            x[5] = c;
+            EXPECT_FALSE(base58::read_address(x, a)) << x;
+        }
+
+        // every change to one character breaks the checksum.
+        for (size_t i = 1; i < genesis.size(); i++) {
+            std::string x = genesis;
+            x[i] = x[i] == 'z' ? 'y' : 'z';
+            EXPECT_FALSE(base58::read_address(x, a)) << x;
+        }
+
+        EXPECT_FALSE(base58::read_address("", a));
+        EXPECT_FALSE(base58::read_address(genesis.substr(1), a));
+        EXPECT_FALSE(base58::read_address(genesis + "1", a));
+        EXPECT_FALSE(base58::read_address("1" + genesis, a));
+
+        // another version.
+        EXPECT_FALSE(base58::read_address(genesis, a, 0x6f));
+        EXPECT_FALSE(base58::read_wif(genesis, k, compressed));
+        EXPECT_FALSE(base58::read_address("KwDiBf89QgGbjEhKnhXJuH7LrciVrZi3qYjgd9M7rFU73sVHnoWn", a));
+        EXPECT_FALSE(base58::read_wif("KwDiBf89QgGbjEhKnhXJuH7LrciVrZi3qYjgd9M7rFU73sVHnoWn", k, compressed, 0xef));
+
+        // the encoding of n bytes only.
+        byte b[4];
+        EXPECT_FALSE(base58::decode("2g", b, 2));
+        EXPECT_FALSE(base58::decode("a3gV", b, 2));
+        EXPECT_TRUE(base58::decode("1a3gV", b, 4));
+        EXPECT_FALSE(base58::decode("zzzzzz", b, 4));
+    }
+
+    // many at once are the same as one at a time, in order,
+    // for batches smaller and larger than a task.
+    TEST(Base58Test, TestMany) {
+        std::mt19937_64 random{40};
+        for (size_t n : {0, 1, 100, 10000}) {
+            vector<keys::hash160> addresses(n);
+            vector<keys::secret_bytes> secrets(n);
+            for (size_t i = 0; i < n; i++) {
+                for (byte& b : addresses[i]) b = byte(random());
+                for (byte& b : secrets[i]) b = byte(random());
+            }
+
+            vector<std::string> a = base58::write_addresses(addresses);
+            vector<std::string> w = base58::write_wifs(secrets);
+            ASSERT_EQ(a.size(), n);
+            ASSERT_EQ(w.size(), n);
+            for (size_t i = 0; i < n; i++) {
+                EXPECT_EQ(a[i], base58::write_address(addresses[i])) << i;
+                EXPECT_EQ(w[i], base58::write_wif(secrets[i])) << i;
+            }
+        }
+    }
+
+}
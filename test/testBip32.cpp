@@ -0,0 +1,92 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/bip32.hpp>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        template <size_t n>
+        std::array<byte, n> fixed(const std::string& x) {
+            std::array<byte, n> a{};
+            for (size_t i = 0; i < n; i++) a[i] = byte(std::stoi(x.substr(2 * i, 2), nullptr, 16));
+            return a;
+        }
+
+        bip32::extended key(const std::string& pubkey, const std::string& chain_code) {
+            return bip32::extended{fixed<33>(pubkey), fixed<32>(chain_code)};
+        }
+
+        // the steps of BIP 32 test vector 1 that are public derivations.
+        const bip32::extended m_0h = key(
+            "035a784662a4a20a65bf6aab9ae98a6c068a81c52e4b032c0fb5400c706cfccc56",
+            "47fdacbd0f1097043b78c63c20c34ef4ed9a111d980047ad16282c7ae6236141");
+        const bip32::extended m_0h_1 = key(
+            "03501e454bf00751f24b1b489aa925215d66af2234e3891c3b21a52bedb3cd711c",
+            "2a7857631386ba23dacac34180dd1983734e444fdbf774041578e9b6adb37c19");
+        const bip32::extended m_0h_1_2h = key(
+            "0357bfe1e341d01c69fe5654309956cbea516822fba8a601743a012a7896ee8dc2",
+            "04466b9cc8e161e966409ca52986c584f07e9dc81f735db683c3ff6ec7b1503f");
+        const bip32::extended m_0h_1_2h_2 = key(
+            "02e8445082a72f29b75ca48748a914df60622a609cacfce8ed0e35804560741d29",
+            "cfb71883f01676f587d023cc53a35bc7f88f724b1f8c2892ac1275ac822a3edd");
+        const bip32::extended m_0h_1_2h_2_1000000000 = key(
+            "022a471424da5e657499d1ff51cb43c47481a03b1e77f951fe64cec9f5a48f7011",
+            "c783e67b921d2beb8f6b389cc646d7263b4145701dadd2161548a8b078e65e9e");
+
+    }
+
+    TEST(Bip32Test, TestVector1) {
+        bip32::extended x{};
+        EXPECT_TRUE(bip32::parent{m_0h}.child(1, x));
+        EXPECT_EQ(x, m_0h_1);
+        EXPECT_TRUE(bip32::parent{m_0h_1_2h}.child(2, x));
+        EXPECT_EQ(x, m_0h_1_2h_2);
+        EXPECT_TRUE(bip32::parent{m_0h_1_2h_2}.child(1000000000, x));
+        EXPECT_EQ(x, m_0h_1_2h_2_1000000000);
+
+        // hardened children have no public derivation.
+        EXPECT_FALSE(bip32::parent{m_0h_1}.child(2 | bip32::hardened, x));
+    }
+
+    // children derived in parallel are the ones derived one at a time.
+    TEST(Bip32Test, TestChain) {
+        bip32::parent p{m_0h_1};
+        vector<keys::pubkey_bytes> children = p.children(5, 40);
+        ASSERT_EQ(children.size(), 40u);
+
+        bip32::chain c{m_0h_1, 16};
+        for (uint32 i = 0; i < 45; i++) {
+            bip32::extended x{};
+            ASSERT_TRUE(p.child(i, x));
+            if (i >= 5) {
+                EXPECT_EQ(children[i - 5], x.Pubkey) << i;
+            }
+            EXPECT_TRUE(c.exists(i));
+            EXPECT_EQ(c.pubkey(i), x.Pubkey) << i;
+            EXPECT_EQ(c.address(i), keys::write(keys::read_pubkey(x.Pubkey).address())) << i;
+        }
+    }
+
+    // restore stops after gap unused children in a row.
+    TEST(Bip32Test, TestScan) {
+        bip32::chain c{m_0h_1, 16};
+        std::unordered_set<keys::hash160, utxo::hash> used{};
+        for (uint32 i : {0, 3, 10, 29}) used.insert(c.address(i));
+
+        EXPECT_EQ(c.scan(used, 20), 30u);
+        EXPECT_GE(c.derived(), 50u);
+
+        // nothing after 10 counts with a shorter gap.
+        bip32::chain d{m_0h_1, 16};
+        EXPECT_EQ(d.scan(used, 10), 11u);
+
+        // with nothing used, new addresses start at the first child.
+        bip32::chain e{m_0h_1, 16};
+        EXPECT_EQ(e.scan(std::unordered_set<keys::hash160, utxo::hash>{}, 20), 0u);
+    }
+
+}
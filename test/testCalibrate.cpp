@@ -0,0 +1,102 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/calibrate.hpp>
+#include <cosmos/evaluation/parallel.hpp>
+#include <cmath>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin::calibrate {
+
+    namespace {
+
+        // the next easier target, if there is one.
+        bool easier(compact t, compact& x) {
+            if (t.Value + 1 < 0x800000) x = compact{t.Exponent, t.Value + 1};
+            else if (t.Exponent < 32) x = compact{byte(t.Exponent + 1), 0x8000};
+            else return false;
+            return true;
+        }
+
+        // the easiest target that needs h hashes.
+        void check(double h) {
+            compact t = for_hashes(h);
+            ASSERT_TRUE(t.valid()) << h;
+            EXPECT_TRUE(t.Exponent == 3 || t.Value >= 0x8000) << h;
+            EXPECT_GE(expected(t), h);
+
+            compact x;
+            if (easier(t, x)) {
+                EXPECT_LT(expected(x), h) << int(t.Exponent) << " " << t.Value;
+            }
+        }
+
+    }
+
+    TEST(CalibrateTest, TestExpected) {
+        // 2^256 / (0xffff * 2^208 + 1)
+        EXPECT_NEAR(expected(minimum), std::ldexp(1, 48) / 0xffff, 1e-3);
+        EXPECT_DOUBLE_EQ(difficulty(minimum), 1);
+        EXPECT_DOUBLE_EQ(difficulty(compact{0x1c, 0x00ffff}), 256);
+        EXPECT_DOUBLE_EQ(difficulty(compact{0x1d, 0x007fff}), double(0xffff) / 0x7fff);
+
+        // the hardest and the easiest.
+        EXPECT_DOUBLE_EQ(expected(compact{3, 1}), std::ldexp(1, 255));
+        EXPECT_DOUBLE_EQ(expected(compact{3, 0x7fffff}), std::ldexp(1, 256) / 0x800000);
+        EXPECT_NEAR(expected(compact{32, 0x7fffff}), 2, 1e-6);
+        EXPECT_GT(expected(compact{32, 0x7fffff}), 2);
+    }
+
+    // a target is the easiest one that needs as many hashes as it does.
+    TEST(CalibrateTest, TestRoundTrip) {
+        std::mt19937_64 random{39};
+        vector<uint32> values{1, 2, 0xff, 0x100, 0x7fff, 0x8000, 0x8001, 0xffff, 0x123456, 0x7ffffe, 0x7fffff};
+        for (int i = 0; i < 20; i++) values.push_back(1 + random() % 0x7fffff);
+
+        for (int e = 3; e <= 32; e++) for (uint32 v : values) {
+            compact t{byte(e), v};
+            ASSERT_TRUE(t.valid());
+            compact x = for_hashes(expected(t));
+
+            // the same target, in its one form.
+            EXPECT_DOUBLE_EQ(expected(x), expected(t)) << e << " " << v;
+            if (e == 3 || v >= 0x8000) {
+                EXPECT_EQ(x, t) << e << " " << v;
+            }
+
+            check(expected(t));
+        }
+    }
+
+    TEST(CalibrateTest, TestForHashes) {
+        std::mt19937_64 random{139};
+        for (int i = 0; i < 1000; i++) check(std::ldexp(1 + double(random() % 1000000) / 1000000, 1 + random() % 254));
+
+        // no target needs fewer than 2 hashes or more than 2^255.
+        for (double h : {-1., 0., 1., 2.}) {
+            EXPECT_EQ(for_hashes(h), (compact{32, 0x7fffff})) << h;
+        }
+        EXPECT_EQ(for_hashes(NAN), (compact{32, 0x7fffff}));
+        for (double h : {std::ldexp(1, 255), std::ldexp(1, 256), std::ldexp(1, 300)}) {
+            EXPECT_EQ(for_hashes(h), (compact{3, 1})) << h;
+        }
+
+        EXPECT_EQ(for_difficulty(1), minimum);
+        EXPECT_EQ(for_difficulty(256), (compact{0x1c, 0x00ffff}));
+    }
+
+    // the hashing is done on the global workers and stops on time.
+    TEST(CalibrateTest, TestMeasure) {
+        const uint32 size = evaluation::parallel::workers::global().size();
+        for (uint32 threads : {0u, 1u, size + 3}) {
+            measurement m = measure(std::chrono::milliseconds{50}, threads);
+            EXPECT_EQ(m.Threads, threads == 1 ? 1u : size);
+            EXPECT_GT(m.Hashes, 0u);
+            EXPECT_GE(m.Seconds, 0.05);
+            EXPECT_LT(m.Seconds, 5);
+        }
+    }
+
+}
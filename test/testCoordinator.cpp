@@ -0,0 +1,201 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "../release/address/coordinator.hpp"
+#include <cosmos/secp256k1.hpp>
+#include <set>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin::coordinator {
+
+    namespace {
+
+        keys::secret_bytes number(uint64_t n) {
+            return plus(keys::secret_bytes{}, n);
+        }
+
+        keys::secret_bytes minus(uint64_t n) {
+            keys::secret_bytes b = secp256k1::order;
+            for (int i = 31; i >= 0 && n != 0; i--) {
+                uint64_t d = n & 255;
+                n >>= 8;
+                if (b[i] < d) n++;
+                b[i] = byte(b[i] - d);
+            }
+            return b;
+        }
+
+        // every key of the leases.
+        void keys_of(const lease& l, std::set<keys::secret_bytes>& k, uint32& repeated) {
+            for (uint64_t i = 0; i < l.Count; i++) if (!k.insert(l.key(i)).second) repeated++;
+        }
+
+        const clock::time_point start{};
+        const clock::duration timeout = std::chrono::seconds{60};
+
+    }
+
+    TEST(CoordinatorTest, TestPlus) {
+        EXPECT_EQ(plus(number(5), 7), number(12));
+        EXPECT_EQ(plus(number(255), 1), number(256));
+        EXPECT_EQ(plus(minus(1), 1), keys::secret_bytes{});
+        EXPECT_EQ(plus(minus(5), 10), number(5));
+        EXPECT_EQ(plus(minus(1), (unsigned __int128)(1) << 100), plus(number(0), ((unsigned __int128)(1) << 100) - 1));
+        EXPECT_EQ(lease({1, minus(2), 3, 4}).key(3), number(7));
+    }
+
+    // leases given out one after another cover the keyspace
+    // from the start, each key once.
+    TEST(CoordinatorTest, TestIssue) {
+        ledger l{number(1000), 3, 10, timeout};
+        std::set<keys::secret_bytes> k{};
+        uint32 repeated = 0;
+        std::set<uint64_t> ids{};
+        for (int i = 0; i < 5; i++) {
+            lease x = l.issue(i % 2 ? "a" : "b", start);
+            EXPECT_TRUE(ids.insert(x.Id).second);
+            EXPECT_EQ(x.Count, 10u);
+            EXPECT_EQ(x.Start, number(1000 + 30 * i));
+            keys_of(x, k, repeated);
+        }
+
+        EXPECT_EQ(repeated, 0u);
+        EXPECT_EQ(k.size(), 50u);
+        EXPECT_EQ(*k.rbegin(), number(1000 + 3 * 49));
+        EXPECT_EQ(l.active(), 5u);
+        EXPECT_EQ(l.done(), 0u);
+    }
+
+    TEST(CoordinatorTest, TestRenew) {
+        ledger l{number(1), 1, 100, timeout};
+        lease x = l.issue("a", start);
+
+        EXPECT_FALSE(l.renew(x.Id, "b", 10, start));
+        EXPECT_FALSE(l.renew(x.Id + 1, "a", 10, start));
+        EXPECT_EQ(l.done(), 0u);
+
+        EXPECT_TRUE(l.renew(x.Id, "a", 10, start));
+        EXPECT_EQ(l.done(), 10u);
+
+        // progress does not go backwards or past the end.
+        EXPECT_TRUE(l.renew(x.Id, "a", 5, start));
+        EXPECT_EQ(l.done(), 10u);
+        EXPECT_TRUE(l.renew(x.Id, "a", 1000, start));
+        EXPECT_EQ(l.done(), 100u);
+
+        EXPECT_FALSE(l.complete(x.Id, "b"));
+        EXPECT_TRUE(l.complete(x.Id, "a"));
+        EXPECT_FALSE(l.complete(x.Id, "a"));
+        EXPECT_EQ(l.done(), 100u);
+        EXPECT_EQ(l.active(), 0u);
+    }
+
+    // what is not done of an expired lease is given out
+    // again before anything new.
+    TEST(CoordinatorTest, TestExpire) {
+        ledger l{number(1), 2, 100, timeout};
+        lease x = l.issue("a", start);
+        lease y = l.issue("b", start);
+        EXPECT_TRUE(l.renew(x.Id, "a", 40, start + timeout / 2));
+
+        EXPECT_EQ(l.expire(start + timeout), 0u);
+        EXPECT_EQ(l.expire(start + timeout + std::chrono::seconds{1}), 1u);
+        EXPECT_EQ(l.active(), 1u);
+        EXPECT_FALSE(l.renew(y.Id, "b", 1, start + timeout));
+
+        lease z = l.issue("c", start + timeout);
+        EXPECT_NE(z.Id, y.Id);
+        EXPECT_EQ(z.Start, y.Start);
+        EXPECT_EQ(z.Count, 100u);
+
+        EXPECT_EQ(l.expire(start + 2 * timeout), 1u);
+        lease w = l.issue("c", start + 2 * timeout);
+        EXPECT_EQ(w.Start, x.key(40));
+        EXPECT_EQ(w.Count, 60u);
+        EXPECT_EQ(l.done(), 40u);
+
+        // nothing was left over, so this one is new.
+        EXPECT_EQ(l.issue("c", start + 2 * timeout).Start, x.key(200));
+    }
+
+    TEST(CoordinatorTest, TestDrop) {
+        ledger l{number(1), 1, 10, timeout};
+        lease a1 = l.issue("a", start);
+        lease b1 = l.issue("b", start);
+        lease a2 = l.issue("a", start);
+        EXPECT_TRUE(l.renew(a2.Id, "a", 3, start));
+
+        EXPECT_EQ(l.drop("c"), 0u);
+        EXPECT_EQ(l.drop("a"), 2u);
+        EXPECT_EQ(l.active(), 1u);
+        EXPECT_FALSE(l.renew(a1.Id, "a", 1, start));
+        EXPECT_TRUE(l.renew(b1.Id, "b", 1, start));
+
+        EXPECT_EQ(l.issue("b", start).Start, a1.Start);
+        lease x = l.issue("b", start);
+        EXPECT_EQ(x.Start, a2.key(3));
+        EXPECT_EQ(x.Count, 7u);
+    }
+
+    // outstanding leases are saved as returned, so the keys of a ledger
+    // read back together with those done and those still held are
+    // every key, once each.
+    TEST(CoordinatorTest, TestReadWrite) {
+        ledger l{number(7), 5, 20, timeout};
+        std::set<keys::secret_bytes> k{};
+        uint32 repeated = 0;
+
+        lease x = l.issue("a", start);
+        lease y = l.issue("b", start);
+        lease z = l.issue("c", start);
+        EXPECT_TRUE(l.renew(x.Id, "a", 8, start));
+        EXPECT_TRUE(l.complete(y.Id, "b"));
+        EXPECT_EQ(l.drop("c"), 1u);
+        for (uint64_t i = 0; i < 8; i++) k.insert(x.key(i));
+        keys_of(y, k, repeated);
+
+        ledger m = ledger::read(json::parse(l.write().dump()), timeout);
+        EXPECT_EQ(m.done(), l.done());
+        EXPECT_EQ(m.active(), 0u);
+        EXPECT_EQ(m.write(), l.write());
+
+        lease first = m.issue("d", start);
+        lease second = m.issue("d", start);
+        lease third = m.issue("d", start);
+        EXPECT_EQ(first.Start, z.Start);
+        EXPECT_EQ(second.Start, x.key(8));
+        EXPECT_EQ(second.Count, 12u);
+        EXPECT_EQ(third.Start, z.key(20));
+        for (const lease& a : {first, second, third}) keys_of(a, k, repeated);
+
+        EXPECT_EQ(repeated, 0u);
+        EXPECT_EQ(k.size(), 80u);
+        EXPECT_EQ(*k.rbegin(), number(7 + 5 * 79));
+    }
+
+    // each candidate is better than the last, so each is kept, and
+    // they are written the way the miner writes its keys.
+    TEST(CoordinatorTest, TestBest) {
+        best b{3};
+        for (uint64_t i = 1; i <= 6; i++) {
+            keys::hash160 digest{};
+            digest[0] = byte(10 - i);
+            EXPECT_TRUE(b.add(candidate{digest, number(i)}));
+        }
+        EXPECT_FALSE(b.add(candidate{keys::hash160{{9}}, number(1)}));
+        ASSERT_EQ(b.candidates().size(), 3u);
+        EXPECT_EQ(b.candidates().begin()->Key, number(6));
+
+        json j = b.write();
+        ASSERT_EQ(j.size(), 3u);
+        EXPECT_EQ(j[0]["key"].get<std::string>()[0], 'K');
+        EXPECT_EQ(j[0]["address"].get<std::string>()[0], '1');
+
+        best c{3};
+        c.read(j);
+        EXPECT_EQ(c.write(), j);
+        EXPECT_THROW(c.read(json::parse(R"([{"key": "x", "address": "y"}])")), std::exception);
+    }
+
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/fees.hpp>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        bytes pay_to(const keys::hash160& a) {
+            bytes s{0x76, 0xa9, 0x14};
+            s.insert(s.end(), a.begin(), a.end());
+            s.push_back(0x88);
+            s.push_back(0xac);
+            return s;
+        }
+
+        // inputs redeeming pay-to-address outputs with random keys.
+        sign::transaction spend(std::mt19937_64& random, size_t inputs, const vector<sign::output>& outputs) {
+            sign::transaction t{1, {}, outputs, 0};
+            for (size_t i = 0; i < inputs; i++) {
+                keys::secret_bytes k{};
+                for (byte& b : k) b = byte(random());
+                k[0] &= 0x7f;
+
+                sign::input x{{}, 10000, {}, 0xffffffff, keys::read_secret(k), {}};
+                for (byte& b : x.Outpoint.Txid) b = byte(random());
+                x.Pubkey = keys::write(x.Key.to_public());
+                x.Script = pay_to(keys::write(x.Key.to_public().address()));
+                t.Inputs.push_back(x);
+            }
+
+            return t;
+        }
+
+    }
+
+    // the size predicted before signing is never less than the size
+    // of the signed transaction, and is the same once the lengths of
+    // the signatures are known.
+    TEST(FeesTest, TestSize) {
+        std::mt19937_64 random{45};
+        const vector<sign::output> outputs{{5000, bytes(25, 0)}, {0, {0x6a, 0x04, 1, 2, 3, 4}}, {1000, bytes(300, 0)}};
+
+        for (size_t n : {1, 2, 7, 252, 253}) {
+            sign::transaction t = spend(random, n, outputs);
+            vector<bytes> scripts = sign::batch(t);
+            bytes signed_transaction = t.write(scripts);
+
+            EXPECT_LE(signed_transaction.size(), fees::size(t)) << n;
+
+            vector<size_t> inputs{};
+            for (const bytes& s : scripts) inputs.push_back(s.size());
+            vector<size_t> sizes{};
+            for (const sign::output& o : outputs) sizes.push_back(o.Script.size());
+            EXPECT_EQ(signed_transaction.size(), fees::size(inputs, sizes)) << n;
+        }
+    }
+
+    // change is what is left after the fee, unless it would be dust.
+    TEST(FeesTest, TestBalance) {
+        std::mt19937_64 random{145};
+        sign::transaction t = spend(random, 3, {{12000, bytes(25, 0)}, {0, bytes(25, 0)}});
+        const fees::fee f{100, 1.5};
+
+        uint64_t paid = 0;
+        sign::transaction changed = t;
+        ASSERT_TRUE(fees::balance(changed, f, paid));
+        EXPECT_EQ(paid, f(fees::size(t)));
+        ASSERT_EQ(changed.Outputs.size(), 2u);
+        EXPECT_EQ(changed.Outputs[1].Value, 30000 - 12000 - paid);
+
+        sign::transaction dust = t;
+        dust.Outputs[0].Value = 30000 - f(fees::size(t)) - fees::dust + 1;
+        ASSERT_TRUE(fees::balance(dust, f, paid));
+        EXPECT_EQ(dust.Outputs.size(), 1u);
+        EXPECT_EQ(paid, f(fees::size(t)) + fees::dust - 1);
+
+        sign::transaction short_of = t;
+        short_of.Outputs[0].Value = 30000;
+        EXPECT_FALSE(fees::balance(short_of, f, paid));
+    }
+
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/field.hpp>
+#include <cosmos/precompute.hpp>
+#include <cstdlib>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    // every backend this host can run agrees with GMP and with the
+    // library. The portable backend is always run, so the vector code
+    // is checked on hosts without IFMA as well.
+    TEST(FieldTest, TestCheck) {
+        EXPECT_TRUE(field::supported(field::portable));
+
+        for (field::backend b : {field::portable, field::ifma}) {
+            if (!field::supported(b)) continue;
+            for (uint64_t seed : {1, 2, 3}) EXPECT_EQ(field::check(b, 300, seed), 0u) << field::name(b);
+        }
+    }
+
+    // a walk gives the same pubkeys whichever backend runs it.
+    TEST(FieldTest, TestWalk) {
+        keys::secret_bytes s{};
+        s[31] = 7;
+        const uint32 step = 3;
+
+        field::walk w{keys::read_secret(s), step, 20, field::portable};
+        ASSERT_EQ(w.size(), 24u);
+
+        vector<keys::pubkey_bytes> p(w.size());
+        for (uint32 batch = 0; batch < 2; batch++) {
+            w.next(p.data());
+            for (uint32 i = 0; i < p.size(); i++) {
+                keys::secret_bytes x{};
+                x[31] = byte(7 + step * (batch * w.size() + i));
+                EXPECT_EQ(p[i], keys::write(precompute::to_public(keys::read_secret(x)))) << batch << " " << i;
+            }
+        }
+    }
+
+    // COSMOS_FIELD=portable overrides the choice of backend.
+    TEST(FieldTest, TestBest) {
+        setenv("COSMOS_FIELD", "portable", 1);
+        EXPECT_EQ(field::best(), field::portable);
+        unsetenv("COSMOS_FIELD");
+        EXPECT_EQ(field::best(), field::supported(field::ifma) ? field::ifma : field::portable);
+    }
+
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/crypto/sha256.hpp>
+#include <cosmos/crypto/sha512.hpp>
+#include <cosmos/crypto/ripemd160.hpp>
+#include <cosmos/crypto/hmac.hpp>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace cosmos::crypto {
+
+    namespace {
+
+        template <size_t n>
+        std::string hex(const std::array<uint8_t, n>& d) {
+            const char digits[] = "0123456789abcdef";
+            std::string x{};
+            for (uint8_t b : d) {
+                x.push_back(digits[b >> 4]);
+                x.push_back(digits[b & 15]);
+            }
+            return x;
+        }
+
+        const uint8_t* start(const std::string& s) {
+            return reinterpret_cast<const uint8_t*>(s.data());
+        }
+
+        const std::string million(1000000, 'a');
+
+        // the same as hashing all at once, for pieces of every
+        // size up to a little more than two blocks.
+        template <typename h>
+        void pieces() {
+            std::string m{};
+            for (int i = 0; i < 300; i++) m.push_back(char(i * 7 + 1));
+
+            for (size_t step = 1; step <= 2 * h::block + 3; step++) {
+                h x{};
+                for (size_t i = 0; i < m.size(); i += step) x.update(start(m) + i, std::min(step, m.size() - i));
+                EXPECT_EQ(x.finish(), h::hash(m)) << step;
+            }
+        }
+
+    }
+
+    // FIPS 180-2 examples.
+    TEST(HashTest, TestSHA256) {
+        EXPECT_EQ(hex(sha256::hash("")), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        EXPECT_EQ(hex(sha256::hash("abc")), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        EXPECT_EQ(hex(sha256::hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        EXPECT_EQ(hex(sha256::hash(million)), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+        pieces<sha256>();
+    }
+
+    TEST(HashTest, TestSHA512) {
+        EXPECT_EQ(hex(sha512::hash("")),
+            "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
+            "47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e");
+        EXPECT_EQ(hex(sha512::hash("abc")),
+            "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+            "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+        EXPECT_EQ(hex(sha512::hash("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+            "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu")),
+            "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+            "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909");
+        EXPECT_EQ(hex(sha512::hash(million)),
+            "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+            "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b");
+        pieces<sha512>();
+    }
+
+    // the examples from the RIPEMD-160 paper.
+    TEST(HashTest, TestRIPEMD160) {
+        const std::vector<std::pair<std::string, std::string>> vectors{
+            {"", "9c1185a5c5e9fc54612808977ee8f548b2258d31"},
+            {"a", "0bdc9d2d256b3ee9daae347be6f4dc835a467ffe"},
+            {"abc", "8eb208f7e05d987a9b044a8e98c6b087f15a0bfc"},
+            {"message digest", "5d0689ef49d2fae572b881b123a85ffa21595f36"},
+            {"abcdefghijklmnopqrstuvwxyz", "f71c27109c692c1b56bbdceb5b9d2865b3708dbc"},
+            {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "12a053384a9c0c88e405a06c27dcf49ada62eb2b"},
+            {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", "b0e20b6e3116640286ed3a87a5713079b21f5189"},
+            {"12345678901234567890123456789012345678901234567890123456789012345678901234567890", "9b752e45573d4b39f4dbd3323cab82bf63326bfb"},
+            {million, "52783243c1697bdbe16d37f97f68f08325dc1528"}};
+
+        for (const auto& v : vectors) EXPECT_EQ(hex(ripemd160::hash(start(v.first), v.first.size())), v.second) << v.first.substr(0, 20);
+    }
+
+    // RFC 4231 test case 2.
+    TEST(HashTest, TestHMAC) {
+        const std::string key = "Jefe";
+        const std::string message = "what do ya want for nothing?";
+
+        EXPECT_EQ(hex(hmac<sha256>{start(key), key.size()}.update(start(message), message.size()).finish()),
+            "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+        EXPECT_EQ(hex(hmac<sha512>{start(key), key.size()}.update(start(message), message.size()).finish()),
+            "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+            "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737");
+    }
+
+}
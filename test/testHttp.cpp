@@ -0,0 +1,203 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/http/client.hpp>
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "gtest/gtest.h"
+
+namespace cosmos::http {
+
+    namespace {
+
+        // A server on localhost which answers each GET with its path.
+        // /slow is answered late, /tagged has an ETag and is answered
+        // with 304 when asked with it, and /drop closes the connection
+        // without an answer. With a limit, a connection is closed with
+        // Connection: close after that many answers.
+        class server {
+            int Socket;
+            uint16_t Port;
+            uint32 Limit;
+            std::atomic<bool> Stop;
+            std::thread Listener;
+            vector<std::thread> Connections;
+
+            static void send(int s, const std::string& x) {
+                ::send(s, x.data(), x.size(), MSG_NOSIGNAL);
+            }
+
+            void serve(int s) {
+                std::string buffer{};
+                uint32 answered = 0;
+                char b[4096];
+                while (!Stop) {
+                    size_t end = buffer.find("\r\n\r\n");
+                    if (end == std::string::npos) {
+                        ssize_t n = ::recv(s, b, sizeof(b), 0);
+                        if (n <= 0) break;
+                        buffer.append(b, n);
+                        continue;
+                    }
+
+                    std::string request = buffer.substr(0, end);
+                    buffer.erase(0, end + 4);
+                    std::string path = request.substr(4, request.find(' ', 4) - 4);
+                    Requests++;
+
+                    if (path == "/slow") std::this_thread::sleep_for(std::chrono::milliseconds{500});
+                    if (path == "/drop") break;
+
+                    const bool last = Limit != 0 && ++answered == Limit;
+                    const std::string close = last ? "\r\nConnection: close" : "";
+                    if (path == "/tagged" && request.find("If-None-Match: \"a\"") != std::string::npos)
+                        send(s, "HTTP/1.1 304 Not Modified\r\nETag: \"a\"" + close + "\r\n\r\n");
+                    else send(s, "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(path.size()) +
+                        (path == "/tagged" ? "\r\nETag: \"a\"" : "") + close + "\r\n\r\n" + path);
+                    if (last) break;
+                }
+
+                ::close(s);
+            }
+
+        public:
+            std::atomic<uint32> Accepted;
+            std::atomic<uint32> Requests;
+
+            server(uint32 limit = 0) : Socket{::socket(AF_INET, SOCK_STREAM, 0)}, Port{0}, Limit{limit}, Stop{false}, Listener{}, Connections{}, Accepted{0}, Requests{0} {
+                sockaddr_in a{};
+                a.sin_family = AF_INET;
+                a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                socklen_t len = sizeof(a);
+                ::bind(Socket, reinterpret_cast<sockaddr*>(&a), len);
+                ::listen(Socket, 16);
+                ::getsockname(Socket, reinterpret_cast<sockaddr*>(&a), &len);
+                Port = ntohs(a.sin_port);
+
+                Listener = std::thread{[this]() {
+                    while (true) {
+                        int s = ::accept(Socket, nullptr, nullptr);
+                        if (s < 0 || Stop) {
+                            if (s >= 0) ::close(s);
+                            return;
+                        }
+
+                        Accepted++;
+                        Connections.emplace_back(&server::serve, this, s);
+                    }
+                }};
+            }
+
+            ~server() {
+                Stop = true;
+                ::shutdown(Socket, SHUT_RDWR);
+                ::close(Socket);
+                Listener.join();
+                for (std::thread& t : Connections) t.join();
+            }
+
+            std::string url(const std::string& path) const {
+                return "http://127.0.0.1:" + std::to_string(Port) + path;
+            }
+        };
+
+    }
+
+    // requests are pipelined on the connections that are
+    // kept open and answered in the order they were given.
+    TEST(HttpTest, TestPipeline) {
+        server s{};
+        options o{};
+        o.Connections = 1;
+        o.Pipeline = 4;
+        client c{o};
+
+        vector<std::string> urls{};
+        for (int i = 0; i < 10; i++) urls.push_back(s.url("/" + std::to_string(i)));
+
+        vector<response> r = c.get(urls);
+        ASSERT_EQ(r.size(), 10u);
+        for (int i = 0; i < 10; i++) {
+            EXPECT_TRUE(r[i].valid());
+            EXPECT_EQ(r[i].Body, "/" + std::to_string(i));
+        }
+
+        EXPECT_EQ(c.get(s.url("/again")).Body, "/again");
+        EXPECT_EQ(s.Accepted, 1u);
+    }
+
+    // a server that closes the connection after every few answers
+    // gets the rest of the pipeline again on a new connection.
+    TEST(HttpTest, TestClose) {
+        server s{3};
+        options o{};
+        o.Connections = 1;
+        o.Pipeline = 10;
+        client c{o};
+
+        vector<std::string> urls{};
+        for (int i = 0; i < 10; i++) urls.push_back(s.url("/" + std::to_string(i)));
+
+        vector<response> r = c.get(urls);
+        for (int i = 0; i < 10; i++) {
+            EXPECT_TRUE(r[i].valid()) << i << " " << r[i].Error;
+            EXPECT_EQ(r[i].Body, "/" + std::to_string(i));
+        }
+        EXPECT_EQ(s.Accepted, 4u);
+
+        // without progress, everything left is an error.
+        r = c.get(vector<std::string>{s.url("/a"), s.url("/drop"), s.url("/b")});
+        EXPECT_TRUE(r[0].valid());
+        EXPECT_FALSE(r[1].Error.empty());
+        EXPECT_FALSE(r[2].Error.empty());
+    }
+
+    // a response with an ETag is revalidated and served from the cache.
+    TEST(HttpTest, TestCache) {
+        server s{};
+        options o{};
+        o.Cache = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        o.Immutable = {"/tx/"};
+        client c{o};
+
+        response first = c.get(s.url("/tagged"));
+        EXPECT_TRUE(first.valid());
+        EXPECT_FALSE(first.Cached);
+
+        response second = c.get(s.url("/tagged"));
+        EXPECT_TRUE(second.valid());
+        EXPECT_TRUE(second.Cached);
+        EXPECT_EQ(second.Body, "/tagged");
+
+        // immutable paths are not asked for again.
+        EXPECT_EQ(c.get(s.url("/tx/1")).Body, "/tx/1");
+        uint32 requests = s.Requests;
+        EXPECT_TRUE(c.get(s.url("/tx/1")).Cached);
+        EXPECT_EQ(s.Requests, requests);
+
+        boost::filesystem::remove_all(o.Cache);
+    }
+
+    // a connection that timed out is not reused, since the late
+    // response would be read as the answer to the next request.
+    TEST(HttpTest, TestTimeout) {
+        server s{};
+        options o{};
+        o.Connections = 1;
+        o.Timeout = std::chrono::milliseconds{100};
+        client c{o};
+
+        response slow = c.get(s.url("/slow"));
+        EXPECT_FALSE(slow.Error.empty());
+
+        response fast = c.get(s.url("/fast"));
+        EXPECT_TRUE(fast.valid());
+        EXPECT_EQ(fast.Body, "/fast");
+    }
+
+}
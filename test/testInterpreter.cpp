@@ -0,0 +1,328 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/interpreter.hpp>
+#include <cosmos/evaluation/transaction.hpp>
+#include <cosmos/parser.hpp>
+#include <cosmos/evaluation/frame.hpp>
+#include <cosmos/evaluation/async.hpp>
+#include "gtest/gtest.h"
+
+namespace cosmos {
+
+    namespace {
+
+        std::string evaluate(work::space& w, const std::string& program) {
+            stringstream ss{program};
+            evaluation::response r = cosmos::evaluate(w, ss);
+            if (r.error()) return "error: " + r.Error.Message;
+            w = r.Result;
+            if (r.Return == nullptr) return "";
+            stringstream x{};
+            r.Return->express()->write(x);
+            return x.str();
+        }
+
+        // answers each request for a string with the string and a "!".
+        struct exclaim final : public evaluation::async::backend {
+            evaluation::loop& Loop;
+            vector<std::string> Requests;
+
+            exclaim(evaluation::loop& l) : Loop{l}, Requests{} {}
+
+            void fetch(cosmos::function, const evaluation::async::arguments& args,
+                evaluation::async::callback<ptr<work::item>> done) override {
+                const work::atom<std::string>* x = args.size() == 1 ?
+                    dynamic_cast<const work::atom<std::string>*>(args[0].get()) : nullptr;
+                Requests.push_back(x == nullptr ? "?" : x->Atom);
+                ptr<work::item> y = x == nullptr ? nullptr : std::make_shared<work::atom<std::string>>(x->Atom + "!");
+                Loop.post([done, y]() {
+                    done(y);
+                });
+            }
+        };
+
+        std::string reads(const std::string& statement) {
+            stringstream ss{statement};
+            stringstream x{};
+            parse::statement(ss)->write(x);
+            return x.str();
+        }
+
+    }
+
+    TEST(InterpreterTest, TestParse) {
+        EXPECT_EQ(reads("1+2*3"), "1 + 2 * 3");
+        EXPECT_EQ(reads("(1 + 2) * 3"), "(1 + 2) * 3");
+        EXPECT_EQ(reads("(1 + 2) + 3"), "(1 + 2) + 3");
+        EXPECT_EQ(reads("$x = sha256( \"a\\\"b\" )"), "$x = sha256(\"a\\\"b\")");
+        EXPECT_EQ(reads("{1, $y, wallet()}"), "{1, $y, wallet()}");
+        EXPECT_EQ(reads("(($a))"), "(($a))");
+        EXPECT_EQ(reads("stats( )"), "stats()");
+
+        stringstream bad{"1 = 2"};
+        EXPECT_THROW(parse::statement(bad), parse::error);
+
+        stringstream unknown{"frobnicate(1)"};
+        EXPECT_THROW(parse::statement(unknown), parse::error);
+    }
+
+    TEST(InterpreterTest, TestEvaluate) {
+        work::space w{};
+        EXPECT_EQ(evaluate(w, "$a = 1 + 2 * 3; $a + 1"), "8");
+        EXPECT_EQ(evaluate(w, "$a * $a"), "49");
+        EXPECT_EQ(evaluate(w, "\"ab\" <> \"cd\""), "\"abcd\"");
+        EXPECT_EQ(evaluate(w, "sha256(\"abc\")"), "\"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad\"");
+        EXPECT_EQ(evaluate(w, "identity(99999999999999999999 * 99999999999999999999)"), "9999999999999999999800000000000000000001");
+        EXPECT_EQ(evaluate(w, "$b"), "error: unrecognized name $b");
+        EXPECT_EQ(evaluate(w, "1 +"), "error: unexpected end of input");
+        EXPECT_EQ(evaluate(w, "stats(1)"), "error: invalid arguments to stats");
+    }
+
+    // arguments are evaluated together unless one writes, in which case
+    // the ones after it see what it wrote, as if from left to right.
+    TEST(InterpreterTest, TestArguments) {
+        work::space w{};
+        EXPECT_EQ(evaluate(w, "$a = 2"), "2");
+        EXPECT_EQ(evaluate(w, "identity($a + 1) + identity($a = 5) * identity($a)"), "28");
+
+        stringstream ss{"$a"};
+        evaluation::response r = cosmos::evaluate(w, ss);
+        ASSERT_FALSE(r.error());
+        EXPECT_EQ(static_cast<const work::atom<number>&>(*r.Return).Atom, number{5});
+    }
+
+    // literals and names are evaluated by the thread that asks,
+    // and the responses are in order whoever evaluated them.
+    TEST(InterpreterTest, TestAtomsInline) {
+        work::space w{};
+        EXPECT_EQ(evaluate(w, "$x = 7"), "7");
+
+        stringstream ss{"1; \"a\"; $x; sha256(\"b\"); 2 + 3; $y; (4)"};
+        expression::parameters p = parse::program(ss);
+
+        std::mutex mutex{};
+        vector<std::string> here{};
+        const std::thread::id self = std::this_thread::get_id();
+        evaluation::parallel::results<evaluation::response> r = evaluation::parallel::evaluate(
+            evaluation::parallel::workers::global(), w, p,
+            [&](const work::space s, ptr<expression> e) -> evaluation::response {
+                stringstream x{};
+                e->write(x);
+                if (std::this_thread::get_id() == self) {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    here.push_back(x.str());
+                }
+                return evaluation::evaluate(s, e);
+            });
+
+        ASSERT_EQ(r.Responses.size(), 7u);
+        for (const std::string& atom : {"1", "\"a\"", "$x", "$y"})
+            EXPECT_NE(std::find(here.begin(), here.end(), atom), here.end()) << atom;
+
+        vector<std::string> returned{};
+        for (const evaluation::response& x : r.Responses) {
+            if (x.error()) {
+                returned.push_back("error");
+                continue;
+            }
+            stringstream y{};
+            x.Return->express()->write(y);
+            returned.push_back(y.str());
+        }
+
+        EXPECT_EQ(returned[0], "1");
+        EXPECT_EQ(returned[1], "\"a\"");
+        EXPECT_EQ(returned[2], "7");
+        EXPECT_NE(returned[3], "error");
+        EXPECT_EQ(returned[4], "5");
+        EXPECT_EQ(returned[5], "error");
+        EXPECT_EQ(returned[6], "4");
+    }
+
+    // a parenthesis keeps what it wrote if it succeeds
+    // and otherwise leaves the workspace as it was.
+    TEST(InterpreterTest, TestParenthesis) {
+        work::space w{};
+        EXPECT_EQ(evaluate(w, "$a = 1"), "1");
+        EXPECT_EQ(evaluate(w, "($a = 3) + 1"), "4");
+        EXPECT_EQ(evaluate(w, "$a"), "3");
+
+        stringstream ss{"($a = 5) + sha256(1)"};
+        evaluation::response r = cosmos::evaluate(w, ss);
+        ASSERT_TRUE(r.error());
+        EXPECT_EQ(r.Error.Message, "invalid arguments to sha256");
+        EXPECT_TRUE(r.valid());
+        EXPECT_EQ(static_cast<const work::atom<number>&>(*r.Result.get(name{"a"})).Atom, number{3});
+    }
+
+    // each parenthesis is a savepoint on the stack of the statement's
+    // transaction, and one that is kept is still undone if one
+    // around it fails.
+    TEST(InterpreterTest, TestNestedSavepoints) {
+        auto a = [](work::space w) -> std::string {
+            return evaluate(w, "$a");
+        };
+
+        auto statement = [](const std::string& x) -> ptr<expression> {
+            stringstream ss{x};
+            return parse::statement(ss);
+        };
+
+        work::space w0{};
+        EXPECT_EQ(evaluate(w0, "$a = 0"), "0");
+        work::space w1 = w0;
+        EXPECT_EQ(evaluate(w1, "$a = 1"), "1");
+        work::space w2 = w1;
+        EXPECT_EQ(evaluate(w2, "$a = 2"), "2");
+
+        evaluation::transaction t{w0};
+        t.begin();
+        t.update(w1);
+        t.begin();
+        t.update(w2);
+        EXPECT_EQ(t.depth(), 2u);
+        t.rollback();
+        EXPECT_EQ(a(t.current()), "1");
+        EXPECT_EQ(t.finish(evaluation::response{w2, evaluation::error{"no"}}).Error.Message, "no");
+        EXPECT_EQ(a(t.current()), "0");
+        EXPECT_EQ(t.depth(), 0u);
+        EXPECT_THROW(t.rollback(), evaluation::transaction::error);
+
+        // parentheses open and close savepoints on the current transaction.
+        {
+            evaluation::transaction u{w1};
+            evaluation::transaction::scope s{&u};
+            u.begin();
+            evaluation::response r = evaluation::evaluate(w1, statement("(($a = 5) + 1) + 1"));
+            ASSERT_FALSE(r.error());
+            EXPECT_EQ(u.depth(), 1u);
+            EXPECT_EQ(a(u.current()), "5");
+
+            // the inner savepoints were kept, so only the
+            // outer one takes the workspace back.
+            r = evaluation::evaluate(u.current(), statement("(($a = 6) + 1) + sha256(1)"));
+            ASSERT_TRUE(r.error());
+            EXPECT_EQ(u.depth(), 1u);
+            EXPECT_EQ(a(u.current()), "6");
+            EXPECT_EQ(a(u.finish(r).Result), "1");
+            EXPECT_EQ(u.depth(), 0u);
+        }
+        EXPECT_EQ(evaluation::transaction::active(), nullptr);
+
+        work::space w = w1;
+        EXPECT_EQ(evaluate(w, "(($a = 7) + 1) + sha256(1)"), "error: invalid arguments to sha256");
+        EXPECT_EQ(a(w), "1");
+        EXPECT_EQ(evaluate(w, "(($a = 7) + 1) + 1"), "9");
+        EXPECT_EQ(a(w), "7");
+    }
+
+    TEST(InterpreterTest, TestStats) {
+        work::space w{};
+        EXPECT_EQ(evaluate(w, "$a = 1"), "1");
+
+        stringstream ss{"stats()"};
+        evaluation::response r = cosmos::evaluate(w, ss);
+        ASSERT_FALSE(r.error());
+        const std::string& report = static_cast<const work::atom<std::string>&>(*r.Return).Atom;
+        EXPECT_NE(report.find("total"), std::string::npos);
+        EXPECT_NE(report.find("allocations"), std::string::npos);
+    }
+
+    // whether a statement writes is known from the
+    // expression and not from the text it was read from.
+    TEST(InterpreterTest, TestWrites) {
+        auto writes = [](const std::string& x) -> bool {
+            stringstream ss{x};
+            return parse::statement(ss)->writes();
+        };
+
+        EXPECT_TRUE(writes("$a = 1"));
+        EXPECT_TRUE(writes("identity($a = 1) + 2"));
+        EXPECT_TRUE(writes("update(1)"));
+        EXPECT_FALSE(writes("\"a = b\""));
+        EXPECT_FALSE(writes("sha256(\"update\") <> \"spend\""));
+        EXPECT_FALSE(writes("$a + 1"));
+    }
+
+    // functions that wait read what was fetched for the
+    // statement and fail rather than block without it.
+    TEST(InterpreterTest, TestFrame) {
+        work::space w{};
+        EXPECT_EQ(evaluate(w, "update(1)"), "error: update needs data which is not in the workspace");
+
+        evaluation::async::frame f{};
+        f.put(cosmos::update, {std::make_shared<work::atom<number>>(number{1})},
+            std::make_shared<work::atom<std::string>>("fetched"));
+        f.put(cosmos::spend, {std::make_shared<work::atom<number>>(number{2})}, nullptr);
+
+        evaluation::async::frame::scope s{&f};
+        EXPECT_EQ(evaluate(w, "update(1)"), "\"fetched\"");
+
+        // so do applications nested in the arguments of others.
+        EXPECT_EQ(evaluate(w, "identity(update(1)) <> identity(update(1)) <> identity(update(1))"), "\"fetchedfetchedfetched\"");
+        EXPECT_EQ(evaluate(w, "spend(2)"), "");
+        EXPECT_EQ(evaluate(w, "update(2)"), "error: update needs data which is not in the workspace");
+    }
+
+    // what is fetched for a function is fetched with the arguments
+    // it will see, including what was set earlier in the statement.
+    TEST(InterpreterTest, TestPrefetch) {
+        evaluation::loop l{};
+        exclaim b{l};
+        evaluation::async::executor x{l, b};
+
+        std::string result{};
+        l.post([&]() {
+            stringstream ss{"identity($a = update(\"k\")) <> update($a) <> update(\"k\" <> \"!\")"};
+            x.evaluate(work::space{}, parse::statement(ss), [&](evaluation::response r) {
+                if (r.error()) result = "error: " + r.Error.Message;
+                else {
+                    stringstream y{};
+                    r.Return->express()->write(y);
+                    result = y.str();
+                }
+                l.stop();
+            });
+        });
+        l.run();
+
+        EXPECT_EQ(result, "\"k!k!!k!!\"");
+        EXPECT_EQ(b.Requests.size(), 3u);
+        EXPECT_EQ(std::count(b.Requests.begin(), b.Requests.end(), "?"), 0);
+    }
+
+    // a wallet is updated with what was fetched for it
+    // and the version it was updated from is unchanged.
+    TEST(InterpreterTest, TestUpdate) {
+        work::space w{};
+        EXPECT_EQ(evaluate(w, "$w = wallet()"), "wallet()");
+        work::space before = w;
+
+        bitcoin::utxo::outpoint a{{}, 0};
+        bitcoin::utxo::outpoint b{{}, 1};
+        evaluation::async::frame f{};
+        f.put(cosmos::update, {std::make_shared<work::wallet>()},
+            std::make_shared<work::changes>(vector<bitcoin::utxo::outpoint>{},
+                vector<bitcoin::utxo::entry>{{a, 5000, {}, {}}, {b, 7000, {}, {}}}));
+
+        std::string zeros(64, '0');
+        evaluation::async::frame::scope s{&f};
+        EXPECT_EQ(evaluate(w, "$w = update($w)"),
+            "wallet(\"" + zeros + ":0:5000\", \"" + zeros + ":1:7000\")");
+
+        const work::wallet& x = static_cast<const work::wallet&>(*w.get(name{"w"}));
+        EXPECT_EQ(x.Outputs->value(), 12000u);
+
+        const work::wallet& y = static_cast<const work::wallet&>(*before.get(name{"w"}));
+        EXPECT_EQ(y.Outputs->size(), 0u);
+
+        // spending is applied the same way.
+        f.put(cosmos::update, {w.get(name{"w"})},
+            std::make_shared<work::changes>(vector<bitcoin::utxo::outpoint>{a}, vector<bitcoin::utxo::entry>{}));
+        EXPECT_EQ(evaluate(w, "update($w)"), "wallet(\"" + zeros + ":1:7000\")");
+        EXPECT_EQ(x.Outputs->size(), 2u);
+    }
+
+}
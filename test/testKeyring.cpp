@@ -0,0 +1,146 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/interpreter.hpp>
+#include <cosmos/keyring.hpp>
+#include <cosmos/precompute.hpp>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        secret key(uint32 n) {
+            keys::secret_bytes b{};
+            b[28] = byte(n >> 24);
+            b[29] = byte(n >> 16);
+            b[30] = byte(n >> 8);
+            b[31] = byte(n);
+            return keys::read_secret(b);
+        }
+
+        keys::hash160 digest(const std::string& x) {
+            keys::hash160 b{};
+            for (size_t i = 0; i < b.size(); i++) b[i] = byte(std::stoul(x.substr(2 * i, 2), nullptr, 16));
+            return b;
+        }
+
+        std::string hex(uint32 n) {
+            std::string x(56, '0');
+            constexpr char digits[] = "0123456789abcdef";
+            for (int i = 7; i >= 0; i--) x.push_back(digits[(n >> (4 * i)) & 15]);
+            return x;
+        }
+
+    }
+
+    TEST(KeyringTest, TestFind) {
+        keyring k{};
+        for (uint32 i = 1; i <= 1000; i++) k = k.add(key(i));
+        EXPECT_EQ(k.size(), 1000);
+
+        // adding a key again does nothing.
+        keyring same = k.add(key(7));
+        EXPECT_EQ(same.size(), 1000);
+
+        for (uint32 i = 1; i <= 1000; i++) {
+            ptr<const keyring::entry> e = k.find(precompute::to_public(key(i)).address());
+            ASSERT_NE(e, nullptr);
+            EXPECT_EQ(keys::write(e->Secret), keys::write(key(i)));
+        }
+
+        EXPECT_EQ(k.find(precompute::to_public(key(1001)).address()), nullptr);
+    }
+
+    // versions share what they have in common and
+    // never see keys added to another version.
+    TEST(KeyringTest, TestVersions) {
+        keyring a{};
+        for (uint32 i = 1; i <= 100; i++) a = a.add(key(i));
+
+        keyring b = a.add(key(200));
+        keyring c = a.add(key(300));
+
+        EXPECT_EQ(a.size(), 100);
+        EXPECT_EQ(a.find(key(200)), nullptr);
+        EXPECT_NE(b.find(key(200)), nullptr);
+        EXPECT_EQ(b.find(key(300)), nullptr);
+        EXPECT_NE(c.find(key(300)), nullptr);
+        EXPECT_EQ(c.find(key(200)), nullptr);
+        EXPECT_EQ(b.find(precompute::to_public(key(300)).address()), nullptr);
+    }
+
+    TEST(KeyringTest, TestWorkspace) {
+        const work::space empty{};
+
+        import::report r{};
+        const work::space w = empty.import(name{"keys"}, hex(1) + "\n" + hex(2) + "\n" + hex(1) + "\n", r);
+        EXPECT_EQ(r.Secrets, 3);
+        EXPECT_EQ(w.Keys.size(), 2);
+        EXPECT_NE(w.key(precompute::to_public(key(2)).address()), nullptr);
+
+        // the space it came from is unchanged.
+        EXPECT_EQ(empty.Keys.size(), 0);
+        EXPECT_EQ(empty.key(precompute::to_public(key(2)).address()), nullptr);
+
+        // and so is any other space made from it.
+        const work::space v = empty.import(name{"keys"}, hex(3), r);
+        EXPECT_EQ(v.Keys.size(), 1);
+        EXPECT_EQ(v.key(precompute::to_public(key(2)).address()), nullptr);
+    }
+
+    // keys which update returns are indexed in the workspace it leaves.
+    TEST(KeyringTest, TestUpdate) {
+        evaluation::async::frame f{};
+        f.put(cosmos::update, {std::make_shared<work::atom<number>>(number{1})},
+            std::make_shared<work::atom<secret>>(key(5)));
+        evaluation::async::frame::scope s{&f};
+
+        const work::space w{};
+        stringstream ss{"update(1)"};
+        evaluation::response x = cosmos::evaluate(w, ss);
+        ASSERT_FALSE(x.error());
+        EXPECT_NE(x.Result.key(precompute::to_public(key(5)).address()), nullptr);
+        EXPECT_EQ(w.key(precompute::to_public(key(5)).address()), nullptr);
+    }
+
+    // a key given as an uncompressed WIF redeems the address
+    // of the uncompressed pubkey and is written back the same way.
+    TEST(KeyringTest, TestCompressed) {
+        const keys::hash160 compressed = digest("751e76e8199196d454941c45d1b3a323f1433bd6");
+        const keys::hash160 uncompressed = digest("91b24bf9f5288532960ac687abb035127b1d28a5");
+
+        keyring k = keyring{}.add(key(1), false);
+        ASSERT_NE(k.find(uncompressed), nullptr);
+        EXPECT_FALSE(k.find(uncompressed)->Compressed);
+        EXPECT_EQ(k.find(compressed), nullptr);
+
+        k = k.add(key(1));
+        EXPECT_EQ(k.size(), 2);
+        EXPECT_NE(k.find(compressed), nullptr);
+
+        import::report r{};
+        const work::space w = work::space{}.import(name{"keys"},
+            "5HpHagT65TZzG1PH3CSu63k8DbpvD8s5ip4nEB3kEsreAnchuDf\n"
+            "KwDiBf89QgGbjEhKnhXJuH7LrciVrZi3qYjgd9M7rFU73sVHnoWn\n"
+            "0479be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798"
+            "483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8\n", r);
+        EXPECT_EQ(r.Secrets, 2);
+        EXPECT_EQ(r.Pubkeys, 1);
+        EXPECT_TRUE(r.Errors.empty());
+        EXPECT_NE(w.key(keys::read_address(uncompressed)), nullptr);
+        EXPECT_NE(w.key(keys::read_address(compressed)), nullptr);
+
+        const work::watch* x = dynamic_cast<const work::watch*>(w.get(name{"keys"}).get());
+        ASSERT_NE(x, nullptr);
+        EXPECT_EQ(x->Watched->Addresses[0], uncompressed);
+
+        // the secrets are in the workspace as well as in the ring.
+        stringstream ss{};
+        w.express()->write(ss);
+        EXPECT_NE(ss.str().find("5HpHagT65TZzG1PH3CSu63k8DbpvD8s5ip4nEB3kEsreAnchuDf"), std::string::npos);
+        EXPECT_NE(ss.str().find("KwDiBf89QgGbjEhKnhXJuH7LrciVrZi3qYjgd9M7rFU73sVHnoWn"), std::string::npos);
+    }
+
+}
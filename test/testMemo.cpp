@@ -0,0 +1,86 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/evaluation/interpreter.hpp>
+#include "gtest/gtest.h"
+
+namespace cosmos {
+
+    namespace {
+
+        evaluation::response evaluate(work::space w, evaluation::memo& m, const std::string& program) {
+            stringstream ss{program};
+            return cosmos::evaluate(w, ss, m);
+        }
+
+    }
+
+    TEST(MemoTest, TestPureCallIsCached) {
+        evaluation::memo m{16};
+        work::space w{};
+
+        evaluation::response a = evaluate(w, m, "sha256(\"abc\")");
+        evaluation::response b = evaluate(w, m, "sha256(\"abc\")");
+        ASSERT_FALSE(a.error());
+        ASSERT_FALSE(b.error());
+        EXPECT_EQ(a.Return, b.Return);
+
+        evaluation::memo::statistics s = m.stats();
+        EXPECT_EQ(s.Misses, 1);
+        EXPECT_EQ(s.Hits, 1);
+
+        // different arguments are a different entry.
+        ASSERT_FALSE(evaluate(w, m, "sha256(\"abd\")").error());
+        EXPECT_EQ(m.stats().Misses, 2);
+    }
+
+    TEST(MemoTest, TestErrorsAreNotCached) {
+        evaluation::memo m{16};
+        work::space w{};
+
+        EXPECT_TRUE(evaluate(w, m, "sha256(1)").error());
+        EXPECT_TRUE(evaluate(w, m, "sha256(1)").error());
+        EXPECT_EQ(m.stats().Hits, 0);
+    }
+
+    TEST(MemoTest, TestImpureCallIsNotCached) {
+        EXPECT_FALSE(evaluation::pure(cosmos::next_address));
+        EXPECT_FALSE(evaluation::pure(cosmos::update));
+
+        evaluation::memo m{16};
+        work::space w{};
+        evaluate(w, m, "update(1)");
+        evaluate(w, m, "update(1)");
+        EXPECT_EQ(m.stats().Hits, 0);
+        EXPECT_EQ(m.stats().Bypassed, 2);
+    }
+
+    // a transaction is written as the hex of its bytes,
+    // but it is not the same argument as that string.
+    TEST(MemoTest, TestTypesAreKept) {
+        const std::string hex = "0100000001" + std::string(64, '0') + "0000000000ffffffff01" + std::string(16, '0') + "0000000000";
+        bytes b{};
+        for (size_t i = 0; i < hex.size(); i += 2) b.push_back(byte(std::stoi(hex.substr(i, 2), nullptr, 16)));
+
+        ptr<work::item> tx = std::make_shared<work::transaction>(bitcoin::transaction_view::read(b));
+        ptr<work::item> text = std::make_shared<work::atom<std::string>>(hex);
+        ASSERT_TRUE(std::static_pointer_cast<work::transaction>(tx)->valid());
+
+        evaluation::memo m{16};
+        auto result = [](const std::string& x) {
+            return [x]() -> ptr<work::item> { return std::make_shared<work::atom<std::string>>(x); };
+        };
+
+        ptr<work::item> a = m.apply(cosmos::SHA256, cosmos::list<ptr<work::item>>{}.prepend(text), result("text"));
+        ptr<work::item> c = m.apply(cosmos::SHA256, cosmos::list<ptr<work::item>>{}.prepend(tx), result("transaction"));
+        EXPECT_NE(a, c);
+        EXPECT_EQ(m.stats().Misses, 2);
+        EXPECT_EQ(m.stats().Hits, 0);
+
+        // identity is not cached.
+        m.apply(cosmos::identity, cosmos::list<ptr<work::item>>{}.prepend(text), result("text"));
+        EXPECT_EQ(m.stats().Bypassed, 1);
+    }
+
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/number.hpp>
+#include <limits>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace cosmos {
+
+    namespace {
+
+        // operands near the edges of the inline form and far past them.
+        vector<std::string> operands() {
+            vector<std::string> x{"0", "1", "-1", "4294967296", "-4294967296",
+                "9223372036854775807", "-9223372036854775808", "9223372036854775808", "-9223372036854775809",
+                "18446744073709551616", "-340282366920938463463374607431768211456",
+                "99999999999999999999999999999999999999999999999999"};
+
+            std::mt19937_64 random{1};
+            for (int i = 0; i < 20; i++) {
+                std::string d = std::to_string(random() % 1000000007);
+                for (uint64_t j = random() % 4; j > 0; j--) d += std::to_string(random());
+                x.push_back((random() & 1) ? "-" + d : d);
+            }
+
+            return x;
+        }
+
+        std::string expected(const std::string& a, char o, const std::string& b) {
+            mpz_t x, y;
+            mpz_init_set_str(x, a.c_str(), 10);
+            mpz_init_set_str(y, b.c_str(), 10);
+            if (o == '+') mpz_add(x, x, y);
+            if (o == '-') mpz_sub(x, x, y);
+            if (o == '*') mpz_mul(x, x, y);
+            std::string s(mpz_sizeinbase(x, 10) + 2, '\0');
+            mpz_get_str(&s[0], 10, x);
+            s.resize(std::char_traits<char>::length(s.c_str()));
+            mpz_clear(x);
+            mpz_clear(y);
+            return s;
+        }
+
+    }
+
+    // every combination of small and large operands, with the left
+    // operand both kept and given up, agrees with GMP and is shrunk
+    // back to the inline form whenever it fits.
+    TEST(NumberTest, TestArithmetic) {
+        const number min{std::numeric_limits<int64_t>::min()};
+        const number max{std::numeric_limits<int64_t>::max()};
+
+        for (const std::string& a : operands()) for (const std::string& b : operands()) {
+            const number x{a};
+            const number y{b};
+            ASSERT_EQ(x.write(), a);
+
+            for (char o : {'+', '-', '*'}) {
+                const std::string z = expected(a, o, b);
+                auto apply = [o](auto&& p, const number& q) -> number {
+                    if (o == '+') return std::forward<decltype(p)>(p) + q;
+                    if (o == '-') return std::forward<decltype(p)>(p) - q;
+                    return std::forward<decltype(p)>(p) * q;
+                };
+
+                number kept = apply(x, y);
+                number given = apply(number{x}, y);
+                EXPECT_EQ(kept.write(), z) << a << " " << o << " " << b;
+                EXPECT_EQ(given, kept) << a << " " << o << " " << b;
+                EXPECT_EQ(kept.small(), !(kept < min) && !(max < kept));
+            }
+        }
+
+        // an operand given up as its own right operand.
+        number x{"123456789012345678901234567890"};
+        number y = std::move(x) * x;
+        EXPECT_EQ(y.write(), expected("123456789012345678901234567890", '*', "123456789012345678901234567890"));
+    }
+
+}
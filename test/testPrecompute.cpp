@@ -0,0 +1,56 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/precompute.hpp>
+#include <cosmos/crypto/sha256.hpp>
+#include <fstream>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        bytes read(const file::path& p) {
+            std::ifstream in{p.string(), std::ios::binary};
+            return bytes(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+        }
+
+    }
+
+    // a cache file is only used if its hash matches the table in it.
+    TEST(PrecomputeTest, TestCacheChecksum) {
+        using generator = precompute::generator;
+
+        file::path p = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        generator::save(p, generator::get().table());
+        bytes file = read(p);
+        boost::filesystem::remove(p);
+
+        ASSERT_EQ(file.size(), generator::header + generator::size);
+        EXPECT_TRUE(generator::check(file.data(), file.size()));
+
+        // a damaged entry anywhere in the table.
+        for (size_t i : {generator::header + 33, generator::header + generator::size / 2, file.size() - 1}) {
+            bytes damaged = file;
+            damaged[i] ^= 1;
+            EXPECT_FALSE(generator::check(damaged.data(), damaged.size()));
+        }
+
+        // another version of the file.
+        bytes other = file;
+        other[7] ^= 1;
+        EXPECT_FALSE(generator::check(other.data(), other.size()));
+
+        // a partial file.
+        EXPECT_FALSE(generator::check(file.data(), file.size() - 33));
+
+        // a table with the right hash which was not built from G.
+        bytes wrong = file;
+        wrong[generator::header + 1] ^= 1;
+        crypto::sha256::digest d = crypto::sha256::hash(wrong.data() + generator::header, generator::size);
+        std::copy(d.begin(), d.end(), wrong.begin() + 8);
+        EXPECT_FALSE(generator::check(wrong.data(), wrong.size()));
+    }
+
+}
@@ -0,0 +1,181 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/scan.hpp>
+#include <cosmos/crypto/sha256.hpp>
+#include <fstream>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        keys::hash160 recipient(byte n) {
+            keys::hash160 a{};
+            a.fill(n);
+            return a;
+        }
+
+        bytes pay_to(const keys::hash160& a) {
+            bytes s{0x76, 0xa9, 0x14};
+            s.insert(s.end(), a.begin(), a.end());
+            s.push_back(0x88);
+            s.push_back(0xac);
+            return s;
+        }
+
+        // a transaction without witnesses spending one
+        // outpoint and paying a value to each address.
+        bytes payment(const utxo::outpoint& in, const vector<std::pair<uint64_t, keys::hash160>>& out) {
+            bytes t{};
+            wire::writer w{t};
+            w.write<uint32>(1).varint(1).append(in.Txid).write<uint32>(in.Index).varint(0).write<uint32>(0xffffffff);
+            w.varint(out.size());
+            for (const auto& o : out) w.write<uint64_t>(o.first).var_bytes(pay_to(o.second));
+            w.write<uint32>(0);
+            return t;
+        }
+
+        utxo::outpoint created(const bytes& t, index i) {
+            return utxo::outpoint{crypto::sha256::hash256(t.data(), t.size()), i};
+        }
+
+        const uint32 easy = 0x207fffff;
+
+        // a block after the given one holding the transactions, with its hash.
+        std::pair<bytes, scan::digest> block(const scan::digest& previous, const vector<bytes>& txs, uint32 bits = easy) {
+            bytes b{};
+            wire::writer w{b};
+            w.write<uint32>(1).append(previous).append(scan::digest{}).write<uint32>(0).write<uint32>(bits).write<uint32>(0);
+            scan::digest hash = crypto::sha256::hash256(b.data(), b.size());
+            w.varint(txs.size());
+            for (const bytes& t : txs) w.append(t);
+            return {b, hash};
+        }
+
+        // blocks as a node writes them, followed by the zeros it preallocates.
+        void block_file(const file::path& p, const vector<bytes>& blocks) {
+            bytes f{};
+            wire::writer w{f};
+            for (const bytes& b : blocks) w.write<uint32>(0xd9b4bef9).write<uint32>(b.size()).append(b);
+            f.resize(f.size() + 64);
+            std::ofstream o{p.string(), std::ios::binary};
+            o.write(reinterpret_cast<const char*>(f.data()), f.size());
+        }
+
+        struct directory {
+            file::path Path;
+
+            directory() : Path{boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()} {
+                boost::filesystem::create_directories(Path);
+            }
+
+            ~directory() {
+                boost::filesystem::remove_all(Path);
+            }
+        };
+
+    }
+
+    // outputs that are spent are removed, even if the spending
+    // transaction is in a file before the one that created them.
+    TEST(ScanTest, TestSpent) {
+        directory dir{};
+
+        keys::hash160 mine = recipient(1);
+        keys::hash160 other = recipient(2);
+
+        bytes paid = payment(utxo::outpoint{{}, 0}, {{5000, mine}, {7000, mine}, {9000, other}});
+        bytes spent = payment(created(paid, 0), {{4000, other}});
+        bytes change = payment(created(paid, 2), {{3000, mine}});
+
+        auto first = block({}, {paid, change});
+        auto second = block(first.second, {spent});
+        block_file(dir.Path / "blk00000.dat", {second.first});
+        block_file(dir.Path / "blk00001.dat", {first.first});
+
+        vector<file::path> files = scan::block_files(dir.Path);
+        ASSERT_EQ(files.size(), 2u);
+
+        scan::result r = scan::run(files, {mine}, 2);
+
+        EXPECT_EQ(r.Statistics.Blocks, 2u);
+        EXPECT_EQ(r.Statistics.Stale, 0u);
+        EXPECT_EQ(r.Statistics.Transactions, 3u);
+        EXPECT_EQ(r.Statistics.Matches, 3u);
+        EXPECT_EQ(r.Statistics.Spent, 1u);
+        ASSERT_EQ(r.Spent.size(), 1u);
+        EXPECT_EQ(r.Spent[0], created(paid, 0));
+
+        utxo::index x{};
+        r.add_to(x);
+        EXPECT_EQ(x.size(), 2u);
+        EXPECT_EQ(x.value(), 10000u);
+        EXPECT_NE(x.find(created(paid, 1)), nullptr);
+        EXPECT_NE(x.find(created(change, 0)), nullptr);
+        EXPECT_EQ(x.find(created(paid, 0)), nullptr);
+    }
+
+    // outputs in blocks that are not on the best chain are not found,
+    // nor are they spent by them, and a block written twice counts once.
+    TEST(ScanTest, TestStale) {
+        directory dir{};
+
+        keys::hash160 mine = recipient(1);
+        keys::hash160 other = recipient(2);
+
+        bytes paid = payment(utxo::outpoint{{}, 1}, {{5000, mine}, {6000, mine}});
+        bytes lost = payment(utxo::outpoint{{}, 2}, {{7000, mine}});
+        bytes orphaned = payment(utxo::outpoint{{}, 3}, {{8000, mine}});
+        bytes spent = payment(created(paid, 0), {{4000, other}});
+        bytes later = payment(utxo::outpoint{{}, 4}, {{9000, mine}});
+
+        // the branch with more blocks has less work.
+        auto genesis = block({}, {paid});
+        auto a = block(genesis.second, {lost});
+        auto b = block(a.second, {spent});
+        auto c = block(genesis.second, {later}, 0x1f00ffff);
+        scan::digest unknown{};
+        unknown.fill(7);
+        auto orphan = block(unknown, {orphaned});
+
+        block_file(dir.Path / "blk00000.dat", {genesis.first, a.first, orphan.first});
+        block_file(dir.Path / "blk00001.dat", {b.first, genesis.first, c.first});
+
+        vector<file::path> files = scan::block_files(dir.Path);
+        vector<vector<scan::header>> headers{};
+        for (const file::path& p : files) {
+            std::ifstream in{p.string(), std::ios::binary};
+            bytes f((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            headers.push_back(scan::headers(wire::slice{f.data(), f.data() + f.size()}));
+        }
+
+        ASSERT_EQ(headers[0].size(), 3u);
+        ASSERT_EQ(headers[1].size(), 3u);
+        EXPECT_EQ(headers[0][1].Hash, a.second);
+        EXPECT_EQ(headers[0][1].Previous, genesis.second);
+        EXPECT_EQ(headers[1][2].Bits, 0x1f00ffffu);
+
+        vector<vector<uint64_t>> chain = scan::best_chain(headers);
+        ASSERT_EQ(chain.size(), 2u);
+        EXPECT_EQ(chain[0], vector<uint64_t>{headers[0][0].Offset});
+        EXPECT_EQ(chain[1], vector<uint64_t>{headers[1][2].Offset});
+
+        scan::result r = scan::run(files, {mine}, 2);
+        EXPECT_EQ(r.Statistics.Blocks, 2u);
+        EXPECT_EQ(r.Statistics.Stale, 4u);
+        EXPECT_EQ(r.Statistics.Matches, 3u);
+        EXPECT_EQ(r.Statistics.Spent, 0u);
+
+        utxo::index x{};
+        r.add_to(x);
+        EXPECT_EQ(x.size(), 3u);
+        EXPECT_EQ(x.value(), 20000u);
+        EXPECT_NE(x.find(created(paid, 0)), nullptr);
+        EXPECT_NE(x.find(created(later, 0)), nullptr);
+        EXPECT_EQ(x.find(created(lost, 0)), nullptr);
+        EXPECT_EQ(x.find(created(orphaned, 0)), nullptr);
+    }
+
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/sign.hpp>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        bytes hex(const std::string& x) {
+            bytes b{};
+            for (size_t i = 0; i + 1 < x.size(); i += 2) b.push_back(byte(std::stoi(x.substr(i, 2), nullptr, 16)));
+            return b;
+        }
+
+        template <size_t n>
+        std::array<byte, n> fixed(const std::string& x) {
+            bytes b = hex(x);
+            std::array<byte, n> a{};
+            std::copy(b.begin(), b.end(), a.begin());
+            return a;
+        }
+
+        // DER of r and s given as 32 bytes each.
+        bytes der(const std::string& r, const std::string& s) {
+            bytes body{};
+            for (bytes x : {hex(r), hex(s)}) {
+                while (x.size() > 1 && x[0] == 0 && !(x[1] & 0x80)) x.erase(x.begin());
+                if (x[0] & 0x80) x.insert(x.begin(), 0);
+                body.push_back(0x02);
+                body.push_back(byte(x.size()));
+                body.insert(body.end(), x.begin(), x.end());
+            }
+
+            bytes d{0x30, byte(body.size())};
+            d.insert(d.end(), body.begin(), body.end());
+            return d;
+        }
+
+        // secp256k1 with SHA-256 of the message, as published with
+        // RFC 6979 implementations. Signatures are low S.
+        struct vector_6979 {
+            std::string Key;
+            std::string Message;
+            std::string Nonce;
+            std::string R;
+            std::string S;
+        };
+
+        const vector<vector_6979> vectors_6979{
+            {"0000000000000000000000000000000000000000000000000000000000000001", "Satoshi Nakamoto",
+                "8f8a276c19f4149656b280621e358cce24f5f52542772691ee69063b74f15d15",
+                "934b1ea10a4b3c1757e2b0c017d0b6143ce3c9a7e6a4a49860d7a6ab210ee3d8",
+                "2442ce9d2b916064108014783e923ec36b49743e2ffa1c4496f01a512aafd9e5"},
+            {"0000000000000000000000000000000000000000000000000000000000000001",
+                "All those moments will be lost in time, like tears in rain. Time to die...",
+                "38aa22d72376b4dbc472e06c3ba403ee0a394da63fc58d88686c611aba98d6b3",
+                "8600dbd41e348fe5c9465ab92d23e3db8b98b873beecd930736488696438cb6b",
+                "547fe64427496db33bf66019dacbf0039c04199abb0122918601db38a72cfc21"},
+            {"fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140", "Satoshi Nakamoto",
+                "33a19b60e25fb6f4435af53a3d42d493644827367e6453928554f43e49aa6f90",
+                "fd567d121db66e382991534ada77a6bd3106f0a1098c231e47993447cd6af2d0",
+                "6b39cd0eb1bc8603e159ef5c20a5c8ad685a45b06ce9bebed3f153d10d93bed5"},
+            {"f8b8af8ce3c7cca5e300d33939540c10d45ce001b8f252bfbc57ba0342904181", "Alan Turing",
+                "525a82b70e67874398067543fd84c83d30c175fdc45fdeee082fe13b1d7cfdf1",
+                "7063ae83e7f62bbb171798131b4a0564b956930092b33b07b395615d9ec7e15c",
+                "58dfcc1e00a35e1572f366ffe34ba0fc47db1e7189759b9fb233c5b05ab388ea"}};
+
+    }
+
+    TEST(SignTest, TestNonce) {
+        for (const vector_6979& v : vectors_6979)
+            EXPECT_EQ(sign::nonce(fixed<32>(v.Key), crypto::sha256::hash(v.Message)), fixed<32>(v.Nonce)) << v.Message;
+    }
+
+    TEST(SignTest, TestSignature) {
+        for (const vector_6979& v : vectors_6979)
+            EXPECT_EQ(sign::signature(fixed<32>(v.Key), crypto::sha256::hash(v.Message)), der(v.R, v.S)) << v.Message;
+    }
+
+    // the native P2WPKH example of BIP 143. Its intermediate hashes do
+    // not depend on the sighash type. The digest is for the second
+    // input with SIGHASH_ALL | SIGHASH_FORKID instead of SIGHASH_ALL.
+    TEST(SignTest, TestPreimage) {
+        sign::transaction t{1, {
+            sign::input{{fixed<32>("fff7f7881a8099afa6940d42d1e7f6362bec38171ea3edf433541db4e4ad969f"), 0}, 625000000,
+                hex("2103c9f4836b9a4f77fc0d81f7bcb01b7f1b35916864b9476c241ce9fc198bd25432ac"), 0xffffffee, secret{}, {}},
+            sign::input{{fixed<32>("ef51e1b804cc89d182d279655c3aa89e815b1b309fe287d9b2b55d57b90ec68a"), 1}, 600000000,
+                hex("76a9141d0f172a0ecb48aee1be1f2687d2963ae33f71a188ac"), 0xffffffff, secret{}, {}}}, {
+            sign::output{112340000, hex("76a9148280b37df378db99f66f85c95a783a76ac7a6d5988ac")},
+            sign::output{223450000, hex("76a9143bde42dbee7e4dbe6a21b2d50ce2f0167faa815988ac")}}, 17};
+
+        sign::preimage p{t};
+        EXPECT_EQ(p.Prevouts, fixed<32>("96b827c8483d4e9b96712b6713a7b68d6e8003a781feba36c31143470b4efd37"));
+        EXPECT_EQ(p.Sequences, fixed<32>("52b0a642eea2fb7ae638c36f6252b6750293dbe574a806984b8e4d8548339a3b"));
+        EXPECT_EQ(p.Outputs, fixed<32>("863ef3e1a92afbfdb97f31ad0fc7683ee943e9abcf2501590ff8f6551f47e5e5"));
+        EXPECT_EQ(p.digest(1), fixed<32>("467f411d178762db122a6aced76370a1c8324355bf0796502bf82eeaeda86a35"));
+    }
+
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/templates.hpp>
+#include <cosmos/keys.hpp>
+#include <abstractions/script/pay_to_address.hpp>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        template <size_t n>
+        std::array<byte, n> random_field(std::mt19937_64& random) {
+            std::array<byte, n> a{};
+            for (byte& b : a) b = byte(random());
+            return a;
+        }
+
+        // a push of the field with its leading zeros taken off,
+        // so the shape of the script depends on the field.
+        bytes minimal_push(const byte& op, const std::array<byte, 8>& f) {
+            size_t zeros = 0;
+            while (zeros < f.size() && f[zeros] == 0) zeros++;
+            bytes s{byte(f.size() - zeros)};
+            s.insert(s.end(), f.begin() + zeros, f.end());
+            s.push_back(op);
+            return s;
+        }
+
+        // the field twice, so the compiles differ in two places.
+        bytes twice(const byte& op, const std::array<byte, 8>& f) {
+            bytes s{8};
+            s.insert(s.end(), f.begin(), f.end());
+            s.push_back(op);
+            s.push_back(8);
+            s.insert(s.end(), f.begin(), f.end());
+            return s;
+        }
+
+    }
+
+    // a pay-to-address script from its skeleton is
+    // the script compiled from its tree.
+    TEST(TemplatesTest, TestPayToAddress) {
+        auto compile = [](const byte&, const keys::hash160& h) -> bytes {
+            return abstractions::script::pay_to(keys::read_address(h))->compile();
+        };
+
+        templates::cache<byte, 20> patch{compile, 1};
+        ASSERT_TRUE(patch.patched(0));
+
+        std::mt19937_64 random{44};
+        for (int i = 0; i < 1000; i++) {
+            keys::hash160 h = random_field<20>(random);
+            bytes s = patch(0, h);
+            EXPECT_EQ(s, compile(0, h));
+
+            ASSERT_EQ(s.size(), 25u);
+            EXPECT_TRUE(std::equal(h.begin(), h.end(), s.begin() + 3));
+        }
+    }
+
+    // shapes that cannot be patched are compiled every time.
+    TEST(TemplatesTest, TestCompiled) {
+        std::mt19937_64 random{144};
+
+        for (auto compile : {minimal_push, twice}) {
+            templates::cache<byte, 8> c{compile, 2};
+            EXPECT_FALSE(c.patched(0xac));
+
+            for (int i = 0; i < 100; i++) {
+                std::array<byte, 8> f = random_field<8>(random);
+                for (size_t z = random() % 4; z > 0; z--) f[z - 1] = 0;
+                EXPECT_EQ(c(0xac, f), compile(0xac, f));
+            }
+        }
+    }
+
+    // a skeleton is learned only from one run of bytes holding the field.
+    TEST(TemplatesTest, TestLearn) {
+        const byte x[2] = {0x00, 0x00};
+        const byte y[2] = {0xff, 0xff};
+
+        templates::skeleton s = templates::skeleton::learn({1, 0x00, 0x00, 2}, x, {1, 0xff, 0xff, 2}, y, 2);
+        ASSERT_TRUE(s.valid());
+        EXPECT_EQ(s.offset(), 1u);
+        const byte z[2] = {5, 6};
+        EXPECT_EQ(s.fill(z), (bytes{1, 5, 6, 2}));
+
+        EXPECT_FALSE(templates::skeleton::learn({1, 0x00, 0x00, 2}, x, {1, 0xff, 0xff, 2, 3}, y, 2).valid());
+        EXPECT_FALSE(templates::skeleton::learn({0x00, 1, 0x00}, x, {0xff, 1, 0xff}, y, 2).valid());
+        EXPECT_FALSE(templates::skeleton::learn({1, 0x00, 0x00, 2}, x, {1, 0xff, 0xfe, 2}, y, 2).valid());
+    }
+
+}
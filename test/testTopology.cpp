@@ -0,0 +1,97 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/topology.hpp>
+#include <cosmos/precompute.hpp>
+#include <set>
+#include <sstream>
+#include <thread>
+#include "gtest/gtest.h"
+
+namespace cosmos {
+
+    TEST(TopologyTest, TestNodes) {
+        vector<topology::node> nodes = topology::nodes();
+        ASSERT_FALSE(nodes.empty());
+
+        std::set<uint32> cpus{};
+        for (const topology::node& n : nodes) {
+            EXPECT_FALSE(n.Cpus.empty());
+            for (uint32 c : n.Cpus) {
+                EXPECT_TRUE(cpus.insert(c).second) << c;
+                EXPECT_EQ(topology::node_of(c), n.Index) << c;
+            }
+        }
+
+        std::stringstream report{};
+        topology::write(report);
+        EXPECT_FALSE(report.str().empty());
+    }
+
+    // pinning affects only the thread that asks for it.
+    TEST(TopologyTest, TestPin) {
+        const uint32 cpu = topology::nodes()[0].Cpus.back();
+        bool pinned = false;
+        uint32 ran = 0;
+        std::thread{[&]() {
+            pinned = topology::pin(cpu);
+            ran = topology::cpu();
+        }}.join();
+
+        EXPECT_TRUE(pinned);
+        EXPECT_EQ(ran, cpu);
+        EXPECT_FALSE(topology::pin(1u << 20));
+    }
+
+    TEST(TopologyTest, TestRegion) {
+        for (bool huge : {false, true}) {
+            topology::region r{3 << 20, huge};
+            ASSERT_NE(r.data(), nullptr);
+            EXPECT_EQ(r.size(), size_t(3 << 20));
+            if (huge) {
+                EXPECT_NE(r.backed(), topology::region::none);
+            } else {
+                EXPECT_EQ(r.backed(), topology::region::normal);
+            }
+
+            // zeroed, and ours to the end.
+            EXPECT_EQ(r.data()[0], 0);
+            r.data()[r.size() - 1] = 1;
+
+            topology::region moved{std::move(r)};
+            EXPECT_EQ(r.backed(), topology::region::none);
+            EXPECT_EQ(r.data(), nullptr);
+            EXPECT_EQ(moved.data()[moved.size() - 1], 1);
+        }
+    }
+
+    // a thread with a copy of the table on its node gets
+    // the same pubkeys as threads using the shared table.
+    TEST(TopologyTest, TestPlace) {
+        using generator = bitcoin::precompute::generator;
+        const topology::node n = topology::nodes()[0];
+
+        vector<bitcoin::keys::secret_bytes> keys(20);
+        for (uint32 i = 0; i < keys.size(); i++) for (uint32 j = 0; j < 32; j++) keys[i][j] = byte(i * 32 + j + 1);
+
+        vector<bitcoin::keys::pubkey_bytes> placed(keys.size());
+        bool local = false;
+        bool copied = false;
+        std::thread{[&]() {
+            topology::pin(n.Cpus[0]);
+            const generator& g = generator::place(n.Index);
+            local = &generator::local() == &g;
+            copied = &g != &generator::get() && g.backed() != topology::region::none;
+            for (uint32 i = 0; i < keys.size(); i++)
+                placed[i] = bitcoin::keys::write(bitcoin::precompute::to_public(bitcoin::keys::read_secret(keys[i])));
+        }}.join();
+
+        EXPECT_TRUE(local);
+        EXPECT_TRUE(copied);
+        EXPECT_EQ(&generator::local(), &generator::get());
+        for (uint32 i = 0; i < keys.size(); i++)
+            EXPECT_EQ(placed[i], bitcoin::keys::write(generator::get().to_public(bitcoin::keys::read_secret(keys[i])))) << i;
+    }
+
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/transaction_view.hpp>
+#include <cosmos/sign.hpp>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        bytes random_bytes(std::mt19937_64& random, size_t n) {
+            bytes b(n);
+            for (byte& x : b) x = byte(random());
+            return b;
+        }
+
+        // some scripts are long enough to need a three-byte size.
+        bytes random_script(std::mt19937_64& random) {
+            return random_bytes(random, random() % 8 == 0 ? 253 + random() % 300 : random() % 120);
+        }
+
+        // a transaction with the input scripts it is to be written with.
+        struct example {
+            sign::transaction Transaction;
+            vector<bytes> Scripts;
+
+            bytes write() const {
+                return Transaction.write(Scripts);
+            }
+        };
+
+        example random_transaction(std::mt19937_64& random, size_t inputs, size_t outputs) {
+            example x{sign::transaction{uint32(random()), {}, {}, uint32(random())}, {}};
+            for (size_t i = 0; i < inputs; i++) {
+                utxo::outpoint o{};
+                for (byte& b : o.Txid) b = byte(random());
+                o.Index = uint32(random());
+                x.Transaction.Inputs.push_back(sign::input{o, 0, {}, uint32(random()), secret{}, {}});
+                x.Scripts.push_back(random_script(random));
+            }
+
+            for (size_t j = 0; j < outputs; j++)
+                x.Transaction.Outputs.push_back(sign::output{random(), random_script(random)});
+
+            return x;
+        }
+
+        // the same transaction with a marker, flag and a witness for each input.
+        bytes segwit(std::mt19937_64& random, const bytes& legacy, size_t inputs) {
+            bytes b(legacy.begin(), legacy.begin() + 4);
+            b.push_back(0);
+            b.push_back(1);
+            b.insert(b.end(), legacy.begin() + 4, legacy.end() - 4);
+            wire::writer w{b};
+            for (size_t i = 0; i < inputs; i++) {
+                size_t items = random() % 4;
+                w.varint(items);
+                for (size_t j = 0; j < items; j++) w.var_bytes(random_bytes(random, random() % 80));
+            }
+            b.insert(b.end(), legacy.end() - 4, legacy.end());
+            return b;
+        }
+
+        size_t varint_size(uint64_t n) {
+            return n < 0xfd ? 1 : n <= 0xffff ? 3 : n <= 0xffffffff ? 5 : 9;
+        }
+
+        // each field is read from where the serialization puts it,
+        // which is after the marker and flag if there are any.
+        void check(const transaction_view& v, const example& x, const bytes& b, size_t marker) {
+            const sign::transaction& t = x.Transaction;
+            ASSERT_TRUE(v.valid());
+            EXPECT_EQ(v.version(), t.Version);
+            EXPECT_EQ(v.locktime(), t.Locktime);
+            ASSERT_EQ(v.inputs(), t.Inputs.size());
+            ASSERT_EQ(v.outputs(), t.Outputs.size());
+
+            const byte* begin = v.write().Begin;
+            ASSERT_EQ(v.write().size(), b.size());
+            EXPECT_TRUE(std::equal(b.begin(), b.end(), begin));
+
+            size_t offset = 4 + marker + varint_size(t.Inputs.size());
+            for (size_t i = 0; i < t.Inputs.size(); i++) {
+                transaction_view::input in = v.get_input(i);
+                EXPECT_EQ(in.Outpoint, t.Inputs[i].Outpoint) << i;
+                EXPECT_EQ(in.Sequence, t.Inputs[i].Sequence) << i;
+                EXPECT_EQ(size_t(in.Script.Begin - begin), offset + 36 + varint_size(x.Scripts[i].size())) << i;
+                EXPECT_EQ(bytes(in.Script.Begin, in.Script.End), x.Scripts[i]) << i;
+                offset += 36 + varint_size(x.Scripts[i].size()) + x.Scripts[i].size() + 4;
+            }
+
+            offset += varint_size(t.Outputs.size());
+            for (size_t j = 0; j < t.Outputs.size(); j++) {
+                transaction_view::output out = v.get_output(j);
+                EXPECT_EQ(out.Value, t.Outputs[j].Value) << j;
+                EXPECT_EQ(size_t(out.Script.Begin - begin), offset + 8 + varint_size(t.Outputs[j].Script.size())) << j;
+                EXPECT_EQ(bytes(out.Script.Begin, out.Script.End), t.Outputs[j].Script) << j;
+                offset += 8 + varint_size(t.Outputs[j].Script.size()) + t.Outputs[j].Script.size();
+            }
+
+            if (marker == 0) {
+                EXPECT_EQ(offset + 4, b.size());
+            }
+        }
+
+    }
+
+    // a view of a transaction has the fields it was written with,
+    // and its id is the double hash of the bytes.
+    TEST(TransactionViewTest, TestRead) {
+        std::mt19937_64 random{35};
+        for (int n = 0; n < 200; n++) {
+            example x = random_transaction(random, 1 + random() % 5, random() % 5);
+            bytes b = x.write();
+            transaction_view v = transaction_view::read(b);
+            check(v, x, b, 0);
+            EXPECT_EQ(v.id(), crypto::sha256::hash256(b.data(), b.size()));
+
+            // copies share the index.
+            transaction_view copy = v;
+            EXPECT_EQ(&copy.id(), &v.id());
+        }
+
+        // enough inputs and outputs for three-byte counts.
+        example x = random_transaction(random, 300, 260);
+        bytes b = x.write();
+        check(transaction_view::read(b), x, b, 0);
+    }
+
+    // the id of a segwit transaction is that of the transaction without
+    // the marker, flag and witnesses, which is the body and locktime.
+    TEST(TransactionViewTest, TestSegwit) {
+        std::mt19937_64 random{135};
+        for (int n = 0; n < 200; n++) {
+            const size_t inputs = 1 + random() % 5;
+            example x = random_transaction(random, inputs, random() % 5);
+            bytes legacy = x.write();
+            bytes b = segwit(random, legacy, inputs);
+
+            transaction_view v = transaction_view::read(b);
+            check(v, x, b, 2);
+            EXPECT_EQ(v.id(), crypto::sha256::hash256(legacy.data(), legacy.size()));
+            EXPECT_EQ(v.id(), transaction_view::read(legacy).id());
+        }
+
+        // the flag must be 1.
+        example x = random_transaction(random, 2, 2);
+        bytes b = segwit(random, x.write(), 2);
+        b[5] = 2;
+        EXPECT_FALSE(transaction_view::read(b).valid());
+    }
+
+    TEST(TransactionViewTest, TestInvalid) {
+        std::mt19937_64 random{235};
+        EXPECT_FALSE(transaction_view::read({}).valid());
+
+        for (int n = 0; n < 20; n++) {
+            const size_t inputs = 1 + random() % 3;
+            example x = random_transaction(random, inputs, random() % 3);
+            for (const bytes& b : {x.write(), segwit(random, x.write(), inputs)}) {
+                ASSERT_TRUE(transaction_view::read(b).valid());
+
+                // every truncation.
+                for (size_t size = 0; size < b.size(); size++)
+                    EXPECT_FALSE(transaction_view::read(bytes(b.begin(), b.begin() + size)).valid()) << size;
+
+                // trailing bytes.
+                bytes longer = b;
+                longer.push_back(0);
+                EXPECT_FALSE(transaction_view::read(longer).valid());
+            }
+        }
+
+        // counts that could never fit in what is left are rejected
+        // before anything is reserved for them.
+        for (uint64_t count : {uint64_t(1) << 32, uint64_t(0xffffffffffffffff), uint64_t(1000)}) {
+            bytes b{};
+            wire::writer w{b};
+            w.write<uint32>(1).varint(count);
+            b.resize(b.size() + 100);
+            EXPECT_FALSE(transaction_view::read(b).valid()) << count;
+
+            example x = random_transaction(random, 1, 0);
+            bytes c = x.write();
+            c.resize(c.size() - 5);
+            wire::writer{c}.varint(count);
+            c.resize(c.size() + 100);
+            EXPECT_FALSE(transaction_view::read(c).valid()) << count;
+        }
+    }
+
+}
@@ -0,0 +1,211 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/utxo.hpp>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        utxo::index wallet(const vector<uint64_t>& values) {
+            utxo::index x{};
+            for (uint32 i = 0; i < values.size(); i++) {
+                utxo::outpoint o{{}, i};
+                o.Txid[0] = byte(i);
+                o.Txid[1] = byte(i >> 8);
+                x.insert(utxo::entry{o, values[i], {}, {}});
+            }
+
+            return x;
+        }
+
+        // the total value minus the cost of each input.
+        uint64_t effective(const utxo::selection& s, const utxo::request& r) {
+            return s.Value - r.InputCost * s.Inputs.size();
+        }
+
+        // the least that any selection without change overshoots
+        // the target, found by trying every subset.
+        std::optional<uint64_t> least_waste(const vector<uint64_t>& values, const utxo::request& r) {
+            std::optional<uint64_t> least{};
+            for (uint32 subset = 1; subset < (1u << values.size()); subset++) {
+                uint64_t total = 0;
+                bool spendable = true;
+                for (uint32 i = 0; i < values.size(); i++) if (subset & (1u << i)) {
+                    if (values[i] <= r.InputCost) spendable = false;
+                    total += values[i] - r.InputCost;
+                }
+
+                if (!spendable || total < r.Target || total > r.Target + r.ChangeCost) continue;
+                if (!least || total - r.Target < *least) least = total - r.Target;
+            }
+
+            return least;
+        }
+
+    }
+
+    TEST(UtxoTest, TestSingle) {
+        const utxo::request r{6000, 10, 50, 546};
+
+        // one output that needs no change.
+        utxo::selection s = utxo::select(wallet({100, 6030, 9000}), r);
+        ASSERT_EQ(s.Inputs.size(), 1u);
+        EXPECT_EQ(s.Value, 6030u);
+        EXPECT_FALSE(s.Change);
+
+        // otherwise the smallest that covers the target with change.
+        s = utxo::select(wallet({100, 7000, 9000}), r);
+        ASSERT_EQ(s.Inputs.size(), 1u);
+        EXPECT_EQ(s.Value, 7000u);
+        EXPECT_TRUE(s.Change);
+
+        // not enough.
+        EXPECT_FALSE(utxo::select(wallet({100, 2000, 3000}), r).valid());
+    }
+
+    // branch and bound finds a selection without change when one
+    // exists and no single output will do, and wastes no more
+    // than the best of every subset.
+    TEST(UtxoTest, TestBranchAndBound) {
+        const utxo::request exact{6000, 10, 50, 546};
+        utxo::selection s = utxo::select(wallet({1010, 2010, 3010, 5010, 8010}), exact);
+        EXPECT_FALSE(s.Change);
+        EXPECT_EQ(effective(s, exact), 6000u);
+
+        std::mt19937_64 random{29};
+        uint32 changeless = 0;
+        for (int n = 0; n < 300; n++) {
+            vector<uint64_t> values(2 + random() % 11);
+            for (uint64_t& v : values) v = 100 + random() % 20000;
+            const utxo::request r{1000 + random() % 40000, 20 + random() % 50, 30 + random() % 300, 546};
+
+            utxo::selection s = utxo::select(wallet(values), r);
+            std::optional<uint64_t> best = least_waste(values, r);
+            if (!best) continue;
+            changeless++;
+
+            ASSERT_TRUE(s.valid());
+            EXPECT_FALSE(s.Change);
+            EXPECT_EQ(s.Fee, r.InputCost * s.Inputs.size());
+            EXPECT_GE(effective(s, r), r.Target);
+            EXPECT_LE(effective(s, r), r.Target + r.ChangeCost);
+
+            // a single output in range is taken as soon as it is found.
+            if (s.Inputs.size() > 1) {
+                EXPECT_EQ(effective(s, r) - r.Target, *best);
+            }
+        }
+
+        EXPECT_GT(changeless, 20u);
+    }
+
+    // with many outputs and no selection without change,
+    // the largest are taken until there is enough.
+    TEST(UtxoTest, TestLargest) {
+        const utxo::request r{50000, 10, 50, 546};
+        vector<uint64_t> values(30, 2000);
+        values[0] = 1;
+
+        utxo::selection s = utxo::select(wallet(values), r);
+        ASSERT_TRUE(s.valid());
+        EXPECT_TRUE(s.Change);
+        EXPECT_GE(effective(s, r), r.Target + r.ChangeCost + r.MinChange);
+        EXPECT_EQ(s.Inputs.size(), 26u);
+    }
+
+    // an index agrees with a map and a set in every order, and a
+    // copy taken before changes keeps what it had.
+    TEST(UtxoTest, TestIndex) {
+        std::mt19937_64 random{129};
+        utxo::index x{};
+        std::map<utxo::outpoint, utxo::entry> outputs{};
+        std::set<std::pair<uint64_t, utxo::outpoint>> values{};
+
+        vector<keys::hash160> addresses(5);
+        for (uint32 i = 0; i < addresses.size(); i++) addresses[i][0] = byte(i + 1);
+
+        for (int round = 0; round < 2000; round++) {
+            utxo::index before = x;
+            const size_t size = outputs.size();
+
+            utxo::outpoint o{{}, uint32(random() % 40)};
+            o.Txid[0] = byte(random() % 30);
+            const bool had = outputs.count(o) != 0;
+            if (had) {
+                EXPECT_TRUE(x.remove(o));
+                EXPECT_FALSE(x.remove(o));
+                values.erase({outputs[o].Value, o});
+                outputs.erase(o);
+            } else {
+                utxo::entry e{o, 1 + random() % 1000, addresses[random() % addresses.size()], {}};
+                EXPECT_TRUE(x.insert(e));
+                EXPECT_FALSE(x.insert(e));
+                values.insert({e.Value, o});
+                outputs[o] = e;
+            }
+
+            EXPECT_EQ(before.size(), size);
+            EXPECT_EQ(before.find(o) != nullptr, had);
+            EXPECT_EQ(x.find(o) != nullptr, !had);
+            EXPECT_EQ(x.size(), outputs.size());
+        }
+
+        uint64_t total = 0;
+        for (const auto& o : outputs) {
+            const utxo::entry* e = x.find(o.first);
+            ASSERT_NE(e, nullptr);
+            EXPECT_EQ(e->Value, o.second.Value);
+            total += e->Value;
+        }
+        EXPECT_EQ(x.value(), total);
+
+        for (const keys::hash160& a : addresses) {
+            std::set<utxo::outpoint> expected{};
+            for (const auto& o : outputs) if (o.second.Address == a) expected.insert(o.first);
+            vector<utxo::outpoint> found = x.find(a);
+            EXPECT_EQ(std::set<utxo::outpoint>(found.begin(), found.end()), expected);
+            EXPECT_EQ(found.size(), expected.size());
+        }
+
+        for (uint64_t v : {0, 1, 500, 1000, 2000}) {
+            vector<std::pair<uint64_t, utxo::outpoint>> up{};
+            x.ascending(v, [&up](const utxo::entry& e) -> bool {
+                up.emplace_back(e.Value, e.Outpoint);
+                return true;
+            });
+            EXPECT_TRUE(std::equal(up.begin(), up.end(), values.lower_bound({v, {}}), values.end()));
+            EXPECT_EQ(up.size(), size_t(std::distance(values.lower_bound({v, {}}), values.end())));
+
+            vector<std::pair<uint64_t, utxo::outpoint>> down{};
+            x.descending(v, [&down](const utxo::entry& e) -> bool {
+                down.emplace_back(e.Value, e.Outpoint);
+                return true;
+            });
+            EXPECT_TRUE(std::equal(down.rbegin(), down.rend(), values.begin(), values.lower_bound({v, {}})));
+            EXPECT_EQ(down.size(), size_t(std::distance(values.begin(), values.lower_bound({v, {}}))));
+        }
+    }
+
+    // many outputs of one transaction, which a treap ordered by
+    // outpoint would make into a list without mixed priorities.
+    TEST(UtxoTest, TestOneTransaction) {
+        utxo::index x{};
+        for (uint32 i = 0; i < 100000; i++) x.insert(utxo::entry{{{}, i}, 1000 + i, {}, {}});
+
+        utxo::index y = x;
+        y.update({{{}, 7}}, {});
+        EXPECT_EQ(x.size(), 100000u);
+        EXPECT_EQ(y.size(), 99999u);
+        EXPECT_NE(x.find(utxo::outpoint{{}, 7}), nullptr);
+        EXPECT_EQ(y.find(utxo::outpoint{{}, 7}), nullptr);
+        EXPECT_EQ(x.find(keys::hash160{}).size(), 100000u);
+    }
+
+}
@@ -0,0 +1,175 @@
+// Copyright (c) 2019 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cosmos/verify.hpp>
+#include <cosmos/precompute.hpp>
+#include <gmp.h>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace cosmos::bitcoin {
+
+    namespace {
+
+        keys::secret_bytes key(std::mt19937_64& random) {
+            keys::secret_bytes k{};
+            for (byte& b : k) b = byte(random());
+            k[0] &= 0x7f;
+            k[31] |= 1;
+            return k;
+        }
+
+        keys::pubkey_bytes public_key(const keys::secret_bytes& k) {
+            return keys::write(precompute::to_public(keys::read_secret(k)));
+        }
+
+        bytes pay_to(const keys::pubkey_bytes& p) {
+            keys::hash160 a = keys::write(keys::read_pubkey(p).address());
+            bytes s{0x76, 0xa9, 0x14};
+            s.insert(s.end(), a.begin(), a.end());
+            s.push_back(0x88);
+            s.push_back(0xac);
+            return s;
+        }
+
+        // a transaction with one input redeeming the given
+        // script and one output whose value may be chosen.
+        sign::transaction unsigned_spend(std::mt19937_64& random, const bytes& script, uint64_t value) {
+            utxo::outpoint o{};
+            for (byte& b : o.Txid) b = byte(random());
+            o.Index = random() % 4;
+            return sign::transaction{1, {sign::input{o, value, script, 0xffffffff, secret{}, {}}},
+                {sign::output{value - 1000, {0x6a}}}, 0};
+        }
+
+        bytes push(const bytes& x) {
+            bytes s{byte(x.size())};
+            s.insert(s.end(), x.begin(), x.end());
+            return s;
+        }
+
+        bytes redeem(bytes der, byte type, const keys::pubkey_bytes& p) {
+            der.push_back(type);
+            bytes s = push(der);
+            bytes k = push(bytes(p.begin(), p.end()));
+            s.insert(s.end(), k.begin(), k.end());
+            return s;
+        }
+
+        // r and s of a DER signature.
+        std::pair<bytes, bytes> integers(const bytes& der) {
+            size_t r = der[3];
+            size_t s = der[5 + r];
+            return {bytes(der.begin() + 4, der.begin() + 4 + r), bytes(der.begin() + 6 + r, der.begin() + 6 + r + s)};
+        }
+
+        bytes der(const bytes& r, const bytes& s) {
+            bytes d{0x30, byte(r.size() + s.size() + 4), 0x02, byte(r.size())};
+            d.insert(d.end(), r.begin(), r.end());
+            d.push_back(0x02);
+            d.push_back(byte(s.size()));
+            d.insert(d.end(), s.begin(), s.end());
+            return d;
+        }
+
+        // n - s, which is the high S form of a low S signature.
+        bytes high(const bytes& s) {
+            mpz_t n, x;
+            mpz_init_set_str(n, "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141", 16);
+            mpz_init(x);
+            mpz_import(x, s.size(), 1, 1, 1, 0, s.data());
+            mpz_sub(x, n, x);
+            bytes b(33, 0);
+            size_t size = 0;
+            mpz_export(b.data() + 1, &size, 1, 1, 1, 0, x);
+            b.resize(size + 1);
+            mpz_clear(n);
+            mpz_clear(x);
+            if (!(b[1] & 0x80)) b.erase(b.begin());
+            return b;
+        }
+
+        verify::result check(const sign::transaction& t, const bytes& script) {
+            transaction_view v = transaction_view::read(t.write({script}));
+            EXPECT_TRUE(v.valid());
+            vector<verify::previous> p{};
+            for (const sign::input& i : t.Inputs) p.push_back(verify::previous{i.Value, i.Script});
+            return verify::transaction{v, p}.input(0);
+        }
+
+    }
+
+    // every redemption is either decided the way the script machine
+    // would decide it or left to the machine. Each case is a valid
+    // redemption with one thing changed, so what the machine would
+    // do is known without running it.
+    TEST(VerifyTest, TestDifferential) {
+        std::mt19937_64 random{43};
+
+        for (int i = 0; i < 8; i++) {
+            keys::secret_bytes k = key(random);
+            keys::secret_bytes other = key(random);
+            keys::pubkey_bytes p = public_key(k);
+            keys::pubkey_bytes q = public_key(other);
+
+            sign::transaction t = unsigned_spend(random, pay_to(p), 100000 + random() % 100000);
+            crypto::sha256::digest m = sign::preimage{t}.digest(0);
+            bytes sig = sign::signature(k, m);
+            auto [r, s] = integers(sig);
+
+            EXPECT_EQ(check(t, redeem(sig, sign::sighash_all, p)), verify::accept);
+
+            // decided without the machine.
+            bytes corrupted = r;
+            corrupted.back() ^= 1;
+            EXPECT_EQ(check(t, redeem(der(corrupted, s), sign::sighash_all, p)), verify::reject);
+            EXPECT_EQ(check(t, redeem(sig, sign::sighash_all, q)), verify::reject);
+            EXPECT_EQ(check(t, redeem(sign::signature(other, m), sign::sighash_all, p)), verify::reject);
+
+            sign::transaction changed = t;
+            changed.Outputs[0].Value--;
+            EXPECT_EQ(check(changed, redeem(sig, sign::sighash_all, p)), verify::reject);
+
+            // left to the machine.
+            EXPECT_EQ(check(t, redeem(der(r, high(s)), sign::sighash_all, p)), verify::unknown);
+            bytes padded = r;
+            padded.insert(padded.begin(), 0);
+            if (!(r[0] & 0x80)) {
+                EXPECT_EQ(check(t, redeem(der(padded, s), sign::sighash_all, p)), verify::unknown);
+            }
+            EXPECT_EQ(check(t, redeem(sig, 0x01, p)), verify::unknown);
+            EXPECT_EQ(check(t, redeem(sig, 0xc1, p)), verify::unknown);
+
+            bytes extra = redeem(sig, sign::sighash_all, p);
+            extra.insert(extra.begin(), {0x01, 0x01});
+            EXPECT_EQ(check(t, extra), verify::unknown);
+
+            sign::transaction nonstandard = t;
+            nonstandard.Inputs[0].Script.push_back(0x61);
+            EXPECT_EQ(check(nonstandard, redeem(sign::signature(k, sign::preimage{nonstandard}.digest(0)), sign::sighash_all, p)),
+                verify::unknown);
+        }
+    }
+
+    // each input of a batch signed transaction is accepted.
+    TEST(VerifyTest, TestBatch) {
+        std::mt19937_64 random{143};
+
+        sign::transaction t{1, {}, {sign::output{50000, {0x6a}}}, 0};
+        vector<verify::previous> p{};
+        for (int i = 0; i < 5; i++) {
+            keys::secret_bytes k = key(random);
+            sign::transaction x = unsigned_spend(random, pay_to(public_key(k)), 20000);
+            x.Inputs[0].Key = keys::read_secret(k);
+            t.Inputs.push_back(x.Inputs[0]);
+            p.push_back(verify::previous{x.Inputs[0].Value, x.Inputs[0].Script});
+        }
+
+        transaction_view v = transaction_view::read(sign::sign(t));
+        ASSERT_TRUE(v.valid());
+        verify::transaction checked{v, p};
+        for (uint32 i = 0; i < t.Inputs.size(); i++) EXPECT_EQ(checked.input(i), verify::accept);
+    }
+
+}